@@ -0,0 +1,141 @@
+#include "distribution2d/sample_table.hpp"
+#include "distribution2d/unit_square_distribution.hpp"
+#include "distribution2d/unit_disk_distribution.hpp"
+#include "distribution2d/concentric_unit_disk_distribution.hpp"
+#include "distribution2d/unit_sphere_distribution.hpp"
+#include "distribution2d/unit_hemisphere_distribution.hpp"
+#include "distribution2d/cosine_weighted_unit_hemisphere_distribution.hpp"
+#include "distribution2d/unit_isoceles_right_triangle_distribution.hpp"
+#include "distribution2d/stratified_sample_set.hpp"
+#include "distribution2d/sobol_sequence.hpp"
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+// bakes a sample table of one of the library's distributions
+//
+// usage: bake_sample_table <distribution> <points> <count> <seed> <float32|float16|unorm16> <output>
+//
+// the points are
+//
+// * random: independent random points, as parallel_generate draws them
+// * morton: the points operator()(0), operator()(1), ... in the Morton order of the integer overloads
+// * sobol, owen_sobol: the first count points of the Sobol sequence, unscrambled or Owen scrambled
+// * correlated_multi_jittered: a correlated multi-jittered set of count points, which must be a square
+
+
+void print_usage(const char* program)
+{
+  std::fprintf(stderr, "usage: %s <distribution> <points> <count> <seed> <float32|float16|unorm16> <output>\n", program);
+  std::fprintf(stderr, "distributions: unit_square, unit_disk, concentric_unit_disk, unit_isoceles_right_triangle,\n");
+  std::fprintf(stderr, "               unit_sphere, unit_hemisphere, cosine_weighted_unit_hemisphere\n");
+  std::fprintf(stderr, "points:        random, morton, sobol, owen_sobol, correlated_multi_jittered\n");
+  std::fprintf(stderr, "morton and sobol ignore the seed\n");
+}
+
+
+// parses the unsigned integer argument named name
+std::uint64_t parse_unsigned(const char* name, const std::string& argument)
+{
+  std::size_t length = 0;
+  std::uint64_t result = 0;
+
+  try
+  {
+    result = std::stoull(argument, &length);
+  }
+  catch(const std::logic_error&)
+  {
+    length = 0;
+  }
+
+  if(argument.empty() || argument[0] == '-' || length != argument.size())
+  {
+    throw std::invalid_argument(std::string(name) + " must be an unsigned integer, not \"" + argument + "\"");
+  }
+
+  return result;
+}
+
+
+// bakes the named distribution from source, and returns false if there's no such distribution
+template<class PointSource>
+bool bake(const std::string& distribution, const PointSource& source, const std::string& path, std::uint64_t count, dist2d::sample_encoding encoding)
+{
+  using namespace dist2d;
+
+  if(distribution == "unit_square")                          bake_sample_table(path, unit_square_distribution<>(), source, count, encoding, execution::par, distribution);
+  else if(distribution == "unit_disk")                       bake_sample_table(path, unit_disk_distribution<>(), source, count, encoding, execution::par, distribution);
+  else if(distribution == "concentric_unit_disk")            bake_sample_table(path, concentric_unit_disk_distribution<>(), source, count, encoding, execution::par, distribution);
+  else if(distribution == "unit_isoceles_right_triangle")    bake_sample_table(path, unit_isoceles_right_triangle_distribution<>(), source, count, encoding, execution::par, distribution);
+  else if(distribution == "unit_sphere")                     bake_sample_table(path, unit_sphere_distribution<>(), source, count, encoding, execution::par, distribution);
+  else if(distribution == "unit_hemisphere")                 bake_sample_table(path, unit_hemisphere_distribution<>(), source, count, encoding, execution::par, distribution);
+  else if(distribution == "cosine_weighted_unit_hemisphere") bake_sample_table(path, cosine_weighted_unit_hemisphere_distribution<>(), source, count, encoding, execution::par, distribution);
+  else return false;
+
+  return true;
+}
+
+
+int main(int argc, char** argv)
+{
+  using namespace dist2d;
+
+  if(argc != 7)
+  {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  std::string distribution = argv[1];
+  std::string points = argv[2];
+  std::string encoding_name = argv[5];
+  std::string path = argv[6];
+
+  sample_encoding encoding;
+  if(encoding_name == "float32")      encoding = sample_encoding::float32;
+  else if(encoding_name == "float16") encoding = sample_encoding::float16;
+  else if(encoding_name == "unorm16") encoding = sample_encoding::unorm16;
+  else
+  {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    std::uint64_t count = parse_unsigned("count", argv[3]);
+    std::uint64_t seed = parse_unsigned("seed", argv[4]);
+
+    bool known = false;
+    if(points == "random")          known = bake(distribution, random_indices(seed), path, count, encoding);
+    else if(points == "morton")     known = bake(distribution, index_range(), path, count, encoding);
+    else if(points == "sobol")      known = bake(distribution, sobol_sequence(), path, count, encoding);
+    else if(points == "owen_sobol") known = bake(distribution, owen_scrambled_sobol_sequence(static_cast<std::uint32_t>(seed)), path, count, encoding);
+    else if(points == "correlated_multi_jittered")
+    {
+      std::uint32_t m = static_cast<std::uint32_t>(std::llround(std::sqrt(double(count))));
+      if(std::uint64_t(m) * m != count)
+      {
+        throw std::invalid_argument("correlated_multi_jittered: count must be a square");
+      }
+
+      known = bake(distribution, correlated_multi_jittered_sample_set(m, m, static_cast<std::uint32_t>(seed)), path, count, encoding);
+    }
+
+    if(!known)
+    {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+  catch(const std::exception& e)
+  {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,438 @@
+#include "distribution2d/morton_code.hpp"
+#include "distribution2d/unit_square_distribution.hpp"
+#include "distribution2d/unit_disk_distribution.hpp"
+#include "distribution2d/concentric_unit_disk_distribution.hpp"
+#include "distribution2d/unit_sphere_distribution.hpp"
+#include "distribution2d/unit_hemisphere_distribution.hpp"
+#include "distribution2d/cosine_weighted_unit_hemisphere_distribution.hpp"
+#include "distribution2d/unit_isoceles_right_triangle_distribution.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// measures the throughput of every distribution through every entry point
+//
+// usage: benchmark [--filter=<substring>] [--min_time=<seconds>] [--json]
+//
+// --json prints the results in the format of Google Benchmark's --benchmark_format=json,
+// so they can be compared between releases with its tools/compare.py
+
+
+template<class T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile char sink;
+  sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+}
+
+
+// the number of samples each iteration of a benchmark produces
+const std::size_t batch_size = 4096;
+
+
+struct benchmark
+{
+  std::string name;
+
+  // produces batch_size samples per iteration
+  std::function<void(std::size_t iterations)> run;
+};
+
+
+struct result
+{
+  std::string name;
+  std::size_t iterations;
+  double seconds;
+
+  double ns_per_sample() const
+  {
+    return 1e9 * seconds / (double(iterations) * batch_size);
+  }
+
+  double samples_per_second() const
+  {
+    return (double(iterations) * batch_size) / seconds;
+  }
+};
+
+
+result measure(const benchmark& b, double min_time)
+{
+  using clock = std::chrono::steady_clock;
+
+  // warm up
+  b.run(1);
+
+  std::size_t iterations = 1;
+  while(true)
+  {
+    auto start = clock::now();
+    b.run(iterations);
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    if(seconds >= min_time || iterations >= (std::size_t(1) << 30))
+    {
+      return result{b.name, iterations, seconds};
+    }
+
+    // aim for 1.4x the minimum time, as Google Benchmark does
+    double multiplier = seconds > 0 ? 1.4 * min_time / seconds : 10;
+    iterations = std::max(iterations + 1, static_cast<std::size_t>(iterations * std::min(multiplier, 10.0)));
+  }
+}
+
+
+template<class Point>
+struct point_traits;
+
+template<class T1, class T2>
+struct point_traits<std::pair<T1,T2>>
+{
+  static constexpr int size = 2;
+  static const char* real_name() { return sizeof(T1) == sizeof(float) ? "float" : "double"; }
+};
+
+template<class T1, class T2, class T3>
+struct point_traits<std::tuple<T1,T2,T3>>
+{
+  static constexpr int size = 3;
+  static const char* real_name() { return sizeof(T1) == sizeof(float) ? "float" : "double"; }
+};
+
+
+template<class Distribution, class Real>
+void generate_batch(const Distribution& dist, std::uint64_t first, std::vector<Real>& xs, std::vector<Real>& ys, std::vector<Real>&, std::integral_constant<int,2>)
+{
+  dist.generate(first, batch_size, xs.data(), ys.data());
+}
+
+template<class Distribution, class Real>
+void generate_batch(const Distribution& dist, std::uint64_t first, std::vector<Real>& xs, std::vector<Real>& ys, std::vector<Real>& zs, std::integral_constant<int,3>)
+{
+  dist.generate(first, batch_size, xs.data(), ys.data(), zs.data());
+}
+
+
+template<class Distribution, class Real>
+void probability_density_batch(const Distribution& dist, const std::vector<Real>& xs, const std::vector<Real>& ys, const std::vector<Real>&, std::vector<Real>& pdfs, std::integral_constant<int,2>)
+{
+  dist.probability_density(batch_size, xs.data(), ys.data(), pdfs.data());
+}
+
+template<class Distribution, class Real>
+void probability_density_batch(const Distribution& dist, const std::vector<Real>& xs, const std::vector<Real>& ys, const std::vector<Real>& zs, std::vector<Real>& pdfs, std::integral_constant<int,3>)
+{
+  dist.probability_density(batch_size, xs.data(), ys.data(), zs.data(), pdfs.data());
+}
+
+
+template<class Distribution>
+void add_benchmarks(std::vector<benchmark>& benchmarks, const std::string& distribution_name)
+{
+  using point = typename Distribution::result_type;
+  using real = typename Distribution::real_type;
+  using traits = point_traits<point>;
+
+  std::string prefix = distribution_name + "<" + traits::real_name() + ">/";
+
+  // the inputs are generated once and shared by each run
+  struct inputs
+  {
+    std::vector<real> u1, u2;
+    std::vector<std::uint32_t> urn1, urn2;
+    std::vector<std::uint64_t> morton;
+
+    inputs()
+    {
+      std::mt19937_64 rng;
+      std::uniform_real_distribution<real> u01;
+
+      for(std::size_t i = 0; i < batch_size; ++i)
+      {
+        u1.push_back(u01(rng));
+        u2.push_back(u01(rng));
+        urn1.push_back(static_cast<std::uint32_t>(rng()));
+        urn2.push_back(static_cast<std::uint32_t>(rng()));
+        morton.push_back(rng());
+      }
+    }
+  };
+
+  static const inputs in;
+
+  benchmarks.push_back({prefix + "float_float", [](std::size_t iterations)
+  {
+    Distribution dist;
+    for(std::size_t it = 0; it < iterations; ++it)
+    {
+      for(std::size_t i = 0; i < batch_size; ++i)
+      {
+        do_not_optimize(dist(in.u1[i], in.u2[i]));
+      }
+    }
+  }});
+
+  benchmarks.push_back({prefix + "integer_integer", [](std::size_t iterations)
+  {
+    Distribution dist;
+    for(std::size_t it = 0; it < iterations; ++it)
+    {
+      for(std::size_t i = 0; i < batch_size; ++i)
+      {
+        do_not_optimize(dist(in.urn1[i], in.urn2[i]));
+      }
+    }
+  }});
+
+  benchmarks.push_back({prefix + "morton", [](std::size_t iterations)
+  {
+    Distribution dist;
+    for(std::size_t it = 0; it < iterations; ++it)
+    {
+      for(std::size_t i = 0; i < batch_size; ++i)
+      {
+        do_not_optimize(dist(in.morton[i]));
+      }
+    }
+  }});
+
+  benchmarks.push_back({prefix + "generator", [](std::size_t iterations)
+  {
+    Distribution dist;
+    std::mt19937_64 rng;
+    for(std::size_t it = 0; it < iterations; ++it)
+    {
+      for(std::size_t i = 0; i < batch_size; ++i)
+      {
+        do_not_optimize(dist(rng));
+      }
+    }
+  }});
+
+  benchmarks.push_back({prefix + "batch", [](std::size_t iterations)
+  {
+    Distribution dist;
+    std::vector<real> xs(batch_size), ys(batch_size), zs(batch_size);
+    for(std::size_t it = 0; it < iterations; ++it)
+    {
+      generate_batch(dist, it * batch_size, xs, ys, zs, std::integral_constant<int,traits::size>());
+      do_not_optimize(xs.front());
+    }
+  }});
+
+  benchmarks.push_back({prefix + "batch_probability_density", [](std::size_t iterations)
+  {
+    Distribution dist;
+    std::vector<real> xs(batch_size), ys(batch_size), zs(batch_size), pdfs(batch_size);
+
+    // half of the points lie outside of the distribution
+    generate_batch(dist, 0, xs, ys, zs, std::integral_constant<int,traits::size>());
+    for(std::size_t i = 0; i < batch_size; i += 2)
+    {
+      xs[i] += real(2);
+    }
+
+    for(std::size_t it = 0; it < iterations; ++it)
+    {
+      probability_density_batch(dist, xs, ys, zs, pdfs, std::integral_constant<int,traits::size>());
+      do_not_optimize(pdfs.front());
+    }
+  }});
+}
+
+
+void add_morton_benchmarks(std::vector<benchmark>& benchmarks)
+{
+  static const std::vector<std::uint64_t> codes = []
+  {
+    std::mt19937_64 rng;
+    std::vector<std::uint64_t> result(batch_size);
+    for(auto& code : result) code = rng();
+    return result;
+  }();
+
+  auto add_scalar = [&](const std::string& name, std::pair<std::uint32_t,std::uint32_t> (*decode)(std::uint64_t))
+  {
+    benchmarks.push_back({"decode_morton_2d/" + name, [=](std::size_t iterations)
+    {
+      for(std::size_t it = 0; it < iterations; ++it)
+      {
+        for(std::size_t i = 0; i < batch_size; ++i)
+        {
+          do_not_optimize(decode(codes[i]));
+        }
+      }
+    }});
+  };
+
+  add_scalar("magic_bits", dist2d::decode_morton_2d_magic_bits);
+  add_scalar("lookup_table", dist2d::decode_morton_2d_lookup_table);
+#if defined(__BMI2__)
+  add_scalar("pext", dist2d::decode_morton_2d_pext);
+#endif
+
+  benchmarks.push_back({"decode_morton_2d/batch", [](std::size_t iterations)
+  {
+    std::vector<std::uint32_t> xs(batch_size), ys(batch_size);
+    for(std::size_t it = 0; it < iterations; ++it)
+    {
+      dist2d::decode_morton_2d(codes.data(), batch_size, xs.data(), ys.data());
+      do_not_optimize(xs.front());
+      do_not_optimize(ys.back());
+    }
+  }});
+}
+
+
+void add_all_benchmarks(std::vector<benchmark>& benchmarks)
+{
+  using namespace dist2d;
+
+  using float2 = std::pair<float,float>;
+  using double2 = std::pair<double,double>;
+  using float3 = std::tuple<float,float,float>;
+  using double3 = std::tuple<double,double,double>;
+
+  add_benchmarks<unit_square_distribution<float2>>(benchmarks, "unit_square");
+  add_benchmarks<unit_square_distribution<double2>>(benchmarks, "unit_square");
+
+  add_benchmarks<unit_disk_distribution<float2>>(benchmarks, "unit_disk");
+  add_benchmarks<unit_disk_distribution<double2>>(benchmarks, "unit_disk");
+
+  add_benchmarks<concentric_unit_disk_distribution<float2>>(benchmarks, "concentric_unit_disk");
+  add_benchmarks<concentric_unit_disk_distribution<double2>>(benchmarks, "concentric_unit_disk");
+  add_benchmarks<concentric_unit_disk_distribution<float2, branchless_concentric_mapping>>(benchmarks, "concentric_unit_disk_branchless");
+  add_benchmarks<concentric_unit_disk_distribution<double2, branchless_concentric_mapping>>(benchmarks, "concentric_unit_disk_branchless");
+
+  add_benchmarks<unit_isoceles_right_triangle_distribution<float2>>(benchmarks, "unit_isoceles_right_triangle");
+  add_benchmarks<unit_isoceles_right_triangle_distribution<double2>>(benchmarks, "unit_isoceles_right_triangle");
+
+  add_benchmarks<unit_sphere_distribution<float3>>(benchmarks, "unit_sphere");
+  add_benchmarks<unit_sphere_distribution<double3>>(benchmarks, "unit_sphere");
+
+  add_benchmarks<unit_hemisphere_distribution<float3>>(benchmarks, "unit_hemisphere");
+  add_benchmarks<unit_hemisphere_distribution<double3>>(benchmarks, "unit_hemisphere");
+
+  add_benchmarks<cosine_weighted_unit_hemisphere_distribution<float3>>(benchmarks, "cosine_weighted_unit_hemisphere");
+  add_benchmarks<cosine_weighted_unit_hemisphere_distribution<double3>>(benchmarks, "cosine_weighted_unit_hemisphere");
+  add_benchmarks<cosine_weighted_unit_hemisphere_distribution<float3, branchless_concentric_mapping>>(benchmarks, "cosine_weighted_unit_hemisphere_branchless");
+  add_benchmarks<cosine_weighted_unit_hemisphere_distribution<double3, branchless_concentric_mapping>>(benchmarks, "cosine_weighted_unit_hemisphere_branchless");
+
+  add_morton_benchmarks(benchmarks);
+}
+
+
+void print_table(const std::vector<result>& results)
+{
+  std::size_t width = 9;
+  for(const auto& r : results) width = std::max(width, r.name.size());
+
+  std::printf("%-*s %14s %16s %12s\n", int(width), "Benchmark", "ns/sample", "samples/s", "Iterations");
+  std::printf("%s\n", std::string(width + 45, '-').c_str());
+
+  for(const auto& r : results)
+  {
+    std::printf("%-*s %14.3f %16.4g %12zu\n", int(width), r.name.c_str(), r.ns_per_sample(), r.samples_per_second(), r.iterations);
+  }
+}
+
+
+void print_json(const std::vector<result>& results)
+{
+  std::printf("{\n");
+  std::printf("  \"context\": {\n");
+  std::printf("    \"executable\": \"benchmark\",\n");
+  std::printf("    \"samples_per_iteration\": %zu\n", batch_size);
+  std::printf("  },\n");
+  std::printf("  \"benchmarks\": [\n");
+
+  for(std::size_t i = 0; i < results.size(); ++i)
+  {
+    const result& r = results[i];
+
+    // like Google Benchmark, times are per iteration
+    double ns_per_iteration = 1e9 * r.seconds / r.iterations;
+
+    std::printf("    {\n");
+    std::printf("      \"name\": \"%s\",\n", r.name.c_str());
+    std::printf("      \"run_name\": \"%s\",\n", r.name.c_str());
+    std::printf("      \"run_type\": \"iteration\",\n");
+    std::printf("      \"iterations\": %zu,\n", r.iterations);
+    std::printf("      \"real_time\": %.6f,\n", ns_per_iteration);
+    std::printf("      \"cpu_time\": %.6f,\n", ns_per_iteration);
+    std::printf("      \"time_unit\": \"ns\",\n");
+    std::printf("      \"items_per_second\": %.6e,\n", r.samples_per_second());
+    std::printf("      \"ns_per_sample\": %.6f\n", r.ns_per_sample());
+    std::printf("    }%s\n", i + 1 < results.size() ? "," : "");
+  }
+
+  std::printf("  ]\n");
+  std::printf("}\n");
+}
+
+
+int main(int argc, char** argv)
+{
+  std::string filter;
+  double min_time = 0.1;
+  bool json = false;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+
+    if(arg.compare(0, 9, "--filter=") == 0)
+    {
+      filter = arg.substr(9);
+    }
+    else if(arg.compare(0, 11, "--min_time=") == 0)
+    {
+      min_time = std::stod(arg.substr(11));
+    }
+    else if(arg == "--json")
+    {
+      json = true;
+    }
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--filter=<substring>] [--min_time=<seconds>] [--json]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<benchmark> benchmarks;
+  add_all_benchmarks(benchmarks);
+
+  std::vector<result> results;
+  for(const auto& b : benchmarks)
+  {
+    if(b.name.find(filter) == std::string::npos) continue;
+
+    results.push_back(measure(b, min_time));
+  }
+
+  if(json)
+  {
+    print_json(results);
+  }
+  else
+  {
+    print_table(results);
+  }
+
+  return 0;
+}
+
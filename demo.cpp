@@ -1,8 +1,32 @@
 #include "distribution2d/unit_isoceles_right_triangle_distribution.hpp"
+#include "distribution2d/stratified_sample_set.hpp"
+#include "distribution2d/poisson_disk_sample_set.hpp"
+#include "distribution2d/unit_sphere_distribution.hpp"
+#include "distribution2d/unit_disk_distribution.hpp"
+#include "distribution2d/packed_point.hpp"
+#include "distribution2d/sample_table.hpp"
+#include "distribution2d/sobol_sequence.hpp"
+#include "distribution2d/halton_sequence.hpp"
+#include "distribution2d/r2_sequence.hpp"
+#include "distribution2d/warp_pipeline.hpp"
+#include "distribution2d/parallel_generate.hpp"
+#include "distribution2d/morton_code.hpp"
+#include "distribution2d/mesh_surface_distribution.hpp"
+#include "distribution2d/spherical_rectangle_distribution.hpp"
+#include "distribution2d/counter_based_generator.hpp"
+#include "distribution2d/concentric_unit_disk_distribution.hpp"
+#include "distribution2d/sample_kernel.hpp"
+#include "distribution2d/spherical_triangle_distribution.hpp"
+#include "distribution2d/unit_square_distribution.hpp"
 #include <random>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 #include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
 
 bool almost_equal(float x, float y, float epsilon = 0.001f)
 {
@@ -10,8 +34,624 @@ bool almost_equal(float x, float y, float epsilon = 0.001f)
   return relative_difference <= epsilon;
 }
 
-int main()
+// bakes count samples of dist from source into a table at path with each encoding, maps it, and checks that sample k is
+// dist(source(k)) to within the encoding's precision
+template<class Distribution, class PointSource>
+void check_sample_table_round_trip(const char* path, const Distribution& dist, const PointSource& source, std::uint64_t count)
 {
+  using point = typename Distribution::result_type;
+  constexpr std::size_t dimension = std::tuple_size<point>::value;
+
+  for(auto encoding : {dist2d::sample_encoding::float32, dist2d::sample_encoding::float16, dist2d::sample_encoding::unorm16})
+  {
+    dist2d::bake_sample_table(path, dist, source, count, encoding, dist2d::execution::par, "demo");
+
+    dist2d::sample_table<point> table(path);
+    assert(table.size() == count);
+    assert(table.encoding() == encoding);
+    assert(table.description() == "demo");
+    assert(table.seed() == dist2d::detail::point_source_seed(source, 0));
+
+    for(std::uint64_t k = 0; k < count; ++k)
+    {
+      float expected[dimension], actual[dimension];
+      dist2d::detail::store_coordinates(dist2d::detail::sample_point(dist, source(k)), expected, std::make_index_sequence<dimension>());
+      dist2d::detail::store_coordinates(table(k), actual, std::make_index_sequence<dimension>());
+
+      for(std::size_t i = 0; i < dimension; ++i)
+      {
+        switch(encoding)
+        {
+          case dist2d::sample_encoding::float32:
+            assert(actual[i] == expected[i]);
+            break;
+
+          // half has 11 significant bits, and flushes magnitudes below its smallest normal, 2^-14
+          case dist2d::sample_encoding::float16:
+            assert(std::fabs(actual[i] - expected[i]) <= std::max(std::fabs(expected[i]) / 2048, 0.0001f));
+            break;
+
+          // the coordinates lie within [-1,1], so a step of 16b fixed point between their extremes is at most 2 / 65535
+          case dist2d::sample_encoding::unorm16:
+            assert(std::fabs(actual[i] - expected[i]) <= 2.f / 65535);
+            break;
+        }
+      }
+    }
+
+    // the source's points differ, so the comparisons above would catch a loader which returned the same point for every k
+    if(encoding == dist2d::sample_encoding::float32)
+    {
+      std::vector<point> points;
+      for(std::uint64_t k = 0; k < count; ++k)
+      {
+        points.push_back(table(k));
+      }
+
+      std::sort(points.begin(), points.end());
+      assert(std::unique(points.begin(), points.end()) == points.end());
+    }
+  }
+
+  std::remove(path);
+}
+
+
+// decodes m one bit at a time
+std::pair<std::uint32_t,std::uint32_t> reference_decode_morton_2d(std::uint64_t m)
+{
+  std::uint32_t x = 0, y = 0;
+  for(int bit = 0; bit < 32; ++bit)
+  {
+    x |= std::uint32_t((m >> (2 * bit))     & 1) << bit;
+    y |= std::uint32_t((m >> (2 * bit + 1)) & 1) << bit;
+  }
+
+  return std::make_pair(x, y);
+}
+
+
+// checks each Morton decoder against the reference on the code m
+void check_morton_decoders(std::uint64_t m)
+{
+  auto expected = reference_decode_morton_2d(m);
+
+  assert(dist2d::decode_morton_2d_magic_bits(m) == expected);
+  assert(dist2d::decode_morton_2d_lookup_table(m) == expected);
+#if defined(__BMI2__)
+  assert(dist2d::decode_morton_2d_pext(m) == expected);
+#endif
+  assert(dist2d::decode_morton_2d(m) == expected);
+  assert(dist2d::encode_morton_2d(expected.first, expected.second) == m);
+}
+
+
+// checks each batch Morton decoder this processor supports against the reference on the n codes beginning at first
+void check_batch_morton_decoders(std::uint64_t first, std::size_t n)
+{
+  struct batch_decoders
+  {
+    void (*range)(std::uint64_t, std::size_t, std::uint32_t*, std::uint32_t*);
+    void (*array)(const std::uint64_t*, std::size_t, std::uint32_t*, std::uint32_t*);
+  };
+
+  std::vector<batch_decoders> decoders;
+  decoders.push_back({dist2d::decode_morton_2d_range, dist2d::decode_morton_2d});
+  decoders.push_back({dist2d::detail::simd::scalar::decode_morton_2d_range, dist2d::detail::simd::scalar::decode_morton_2d});
+#if defined(DIST2D_HAS_X86_SIMD)
+  if(__builtin_cpu_supports("avx2"))
+  {
+    decoders.push_back({dist2d::detail::simd::avx2::decode_morton_2d_range, dist2d::detail::simd::avx2::decode_morton_2d});
+  }
+
+  if(__builtin_cpu_supports("avx512f"))
+  {
+    decoders.push_back({dist2d::detail::simd::avx512::decode_morton_2d_range, dist2d::detail::simd::avx512::decode_morton_2d});
+  }
+#endif
+
+  std::vector<std::uint64_t> codes(n);
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    codes[i] = first + i;
+  }
+
+  for(auto decoder : decoders)
+  {
+    std::vector<std::uint32_t> xs(n), ys(n), array_xs(n), array_ys(n);
+    decoder.range(first, n, xs.data(), ys.data());
+    decoder.array(codes.data(), n, array_xs.data(), array_ys.data());
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      auto expected = reference_decode_morton_2d(first + i);
+      assert(xs[i] == expected.first && ys[i] == expected.second);
+      assert(array_xs[i] == expected.first && array_ys[i] == expected.second);
+    }
+  }
+}
+
+
+// checks that each power of two prefix of sequence, up to 2^max_log2 points, is a (0,m,2)-net:
+// that its 2^m points lie one to each elementary interval of area 2^-m, of every shape
+template<class Sequence>
+void check_02_net_prefixes(const Sequence& sequence, int max_log2)
+{
+  for(int m = 0; m <= max_log2; ++m)
+  {
+    const std::uint32_t n = 1u << m;
+
+    // the intervals are 2^k columns by 2^(m - k) rows
+    for(int k = 0; k <= m; ++k)
+    {
+      std::vector<int> counts(n, 0);
+      for(std::uint32_t i = 0; i < n; ++i)
+      {
+        auto urns = sequence(i);
+        std::uint64_t column = std::uint64_t(urns.first) >> (32 - k);
+        std::uint64_t row = std::uint64_t(urns.second) >> (32 - (m - k));
+        ++counts[(row << k) | column];
+      }
+
+      assert(std::all_of(counts.begin(), counts.end(), [](int c){ return c == 1; }));
+    }
+  }
+}
+
+
+// checks that each prefix of 2^a 3^b points of the Halton sequence lies one point to each of 2^a x 3^b boxes
+void check_halton_prefixes()
+{
+  dist2d::halton_sequence halton;
+
+  std::uint32_t two_a = 1;
+  for(int a = 0; a <= 6; ++a, two_a *= 2)
+  {
+    std::uint32_t three_b = 1;
+    for(int b = 0; b <= 4; ++b, three_b *= 3)
+    {
+      const std::uint32_t n = two_a * three_b;
+
+      std::vector<int> counts(n, 0);
+      for(std::uint32_t i = 0; i < n; ++i)
+      {
+        auto urns = halton(i);
+        std::uint64_t column = (std::uint64_t(urns.first) * two_a) >> 32;
+
+        // the fixed point coordinate is truncated, so a point on a row's lower edge may lie just below it
+        // these prefixes' coordinates are multiples of 3^-8, far from the next edge above
+        std::uint64_t row = ((std::uint64_t(urns.second) + 1) * three_b) >> 32;
+
+        ++counts[row * two_a + column];
+      }
+
+      assert(std::all_of(counts.begin(), counts.end(), [](int c){ return c == 1; }));
+    }
+  }
+}
+
+
+// R2 is no (0,2)-sequence, but each of its coordinates is a rotation of the circle,
+// so by the three gap theorem, the gaps between consecutive points of any prefix take at most three lengths
+void check_r2_prefixes(const dist2d::r2_sequence& r2)
+{
+  for(std::uint32_t n : {2, 3, 10, 64, 100, 1000, 4096})
+  {
+    for(int coordinate = 0; coordinate < 2; ++coordinate)
+    {
+      std::vector<std::uint32_t> points(n);
+      for(std::uint32_t i = 0; i < n; ++i)
+      {
+        points[i] = coordinate == 0 ? r2(i).first : r2(i).second;
+      }
+
+      std::sort(points.begin(), points.end());
+
+      // the last gap wraps around the circle
+      std::vector<std::uint32_t> gaps(n);
+      for(std::uint32_t i = 0; i < n; ++i)
+      {
+        gaps[i] = points[(i + 1) % n] - points[i];
+      }
+
+      std::sort(gaps.begin(), gaps.end());
+      assert(std::unique(gaps.begin(), gaps.end()) - gaps.begin() <= 3);
+    }
+  }
+}
+
+
+// a generator which returns Min plus each of its offsets in turn, and counts its calls
+template<std::uint64_t Min, std::uint64_t Max>
+struct scripted_generator
+{
+  using result_type = std::uint64_t;
+
+  static constexpr result_type min()
+  {
+    return Min;
+  }
+
+  static constexpr result_type max()
+  {
+    return Max;
+  }
+
+  result_type operator()()
+  {
+    return Min + offsets[calls++ % offsets.size()];
+  }
+
+  std::vector<std::uint64_t> offsets;
+  std::size_t calls;
+};
+
+
+// like std::minstd_rand, whose results span [1, 2^31 - 2], so only their low 30 bits are uniform
+using scripted_30_bit_generator = scripted_generator<1, 2147483646>;
+
+// spans 63 bits above a non-zero minimum
+using scripted_63_bit_generator = scripted_generator<1, std::uint64_t(1) << 63>;
+
+using scripted_64_bit_generator = scripted_generator<0, ~std::uint64_t(0)>;
+
+
+// a 16b generator without min() & max(), so each bit of its result is taken to be uniform
+struct scripted_16_bit_generator
+{
+  std::uint16_t operator()()
+  {
+    return offsets[calls++ % offsets.size()];
+  }
+
+  std::vector<std::uint16_t> offsets;
+  std::size_t calls;
+};
+
+
+// checks the conversions of integers to [0,1) at their boundaries: 0, the largest integer, and the integers which map to
+// the real 1 ulp below 1
+void check_unit_interval_conversions()
+{
+  using fixed_float = dist2d::unit_interval_distribution<float>;
+  using fixed_double = dist2d::unit_interval_distribution<double>;
+  using dense_float = dist2d::unit_interval_distribution<float,dist2d::dense_conversion>;
+  using dense_double = dist2d::unit_interval_distribution<double,dist2d::dense_conversion>;
+
+  const float below_one_float = std::nextafter(1.f, 0.f);
+  const double below_one_double = std::nextafter(1.0, 0.0);
+
+  // fixed point keeps the high bits that fit in the significand
+  static_assert(fixed_float()(0u) == 0, "");
+  static_assert(fixed_float()(~0u) == 1 - dist2d::detail::exp2_negative<float>(24), "");
+  assert(fixed_float()(0u) == 0);
+  assert(fixed_float()(~0u) == below_one_float);
+  assert(fixed_float()(0xffffff00u) == below_one_float);
+  assert(fixed_float()(0xfffffeffu) == 1 - std::ldexp(1.f, -23));
+  assert(fixed_float()(~std::uint64_t(0)) == below_one_float);
+  assert(fixed_float()(std::uint16_t(0xffff)) == 1 - std::ldexp(1.f, -16));
+  assert(fixed_float()(-1) == below_one_float);
+
+  assert(fixed_double()(std::uint64_t(0)) == 0);
+  assert(fixed_double()(~std::uint64_t(0)) == below_one_double);
+  assert(fixed_double()(~std::uint64_t(0) << 11) == below_one_double);
+  assert(fixed_double()(~0u) == 1 - std::ldexp(1.0, -32));
+
+  // dense reaches down to 2^-(bits of the input), and rounds no input up to 1
+  assert(dense_float()(0u) == 0);
+  assert(dense_float()(1u) == std::ldexp(1.f, -32));
+  assert(dense_float()(0x80000000u) == 0.5f);
+  assert(dense_float()(~0u) == below_one_float);
+  assert(dense_float()(std::uint64_t(1)) == std::ldexp(1.f, -64));
+  assert(dense_float()(~std::uint64_t(0)) == below_one_float);
+
+  assert(dense_double()(std::uint64_t(0)) == 0);
+  assert(dense_double()(std::uint64_t(1)) == std::ldexp(1.0, -64));
+  assert(dense_double()(~std::uint64_t(0)) == below_one_double);
+  assert(dense_double()(~0u) == 1 - std::ldexp(1.0, -32));
+
+  std::mt19937_64 rng(13);
+  for(int i = 0; i < 100000; ++i)
+  {
+    std::uint64_t x = rng() >> (i % 64);
+    assert(dense_float::contains(dense_float()(x)) && dense_double::contains(dense_double()(x)));
+    assert(fixed_float::contains(fixed_float()(x)) && fixed_double::contains(fixed_double()(x)));
+  }
+}
+
+
+// checks that the precision policy's compute_type converts the urns, not only evaluates the warp:
+// at v = 1 - 2^-32, y = sin(2 pi v) is -1.5e-9 when v is converted in double, but -3.7e-7 when v is first rounded to float
+void check_precision_urn_conversion()
+{
+  dist2d::unit_disk_distribution<std::pair<float,float>, dist2d::double_precision> double_disk;
+  dist2d::unit_disk_distribution<std::pair<float,float>> float_disk;
+
+  float double_y = double_disk(~0u, ~0u).second;
+  float float_y = float_disk(~0u, ~0u).second;
+
+  assert(double_y < 0 && double_y > -2e-9f);
+  assert(float_y < -3e-7f && float_y > -4e-7f);
+
+  // generate() converts its urns the same way as operator()
+  float xs[64], ys[64];
+  double_disk.generate(std::uint64_t(1000), 64, xs, ys);
+  for(std::size_t k = 0; k < 64; ++k)
+  {
+    auto p = double_disk(std::uint64_t(1000 + k));
+    assert(p.first == xs[k] && p.second == ys[k]);
+  }
+}
+
+
+// checks how many results of generators with a non-zero min() or fewer than 64 bits are drawn, and how they're concatenated
+void check_generator_draws()
+{
+  static_assert(dist2d::detail::generator_bits<std::minstd_rand>::value == 30, "");
+  static_assert(dist2d::detail::generator_bits<scripted_30_bit_generator>::value == 30, "");
+  static_assert(dist2d::detail::generator_bits<scripted_63_bit_generator>::value == 63, "");
+  static_assert(dist2d::detail::generator_bits<scripted_16_bit_generator>::value == 16, "");
+  static_assert(dist2d::detail::generator_bits<std::mt19937>::value == 32, "");
+
+  const std::uint64_t ones30 = (std::uint64_t(1) << 30) - 1;
+
+  // draw_at_least removes min() and concatenates whole draws, up to 64 bits
+  {
+    scripted_30_bit_generator g{{0x2aaaaaaa, 0x15555555, 7}, 0};
+    assert(dist2d::detail::draw_at_least<24>(g) == 0x2aaaaaaa && g.calls == 1);
+    assert(dist2d::detail::draw_at_least<64>(g) == ((std::uint64_t(0x15555555) << 30) | 7) && g.calls == 3);
+  }
+
+  {
+    scripted_16_bit_generator g{{0xffff, 0xff00, 0x1234, 0x5678}, 0};
+    assert(dist2d::detail::draw_at_least<24>(g) == 0xffffff00 && g.calls == 2);
+    assert(dist2d::detail::draw_at_least<64>(g) == 0x12345678ffffff00 && g.calls == 6);
+  }
+
+  // unit_interval_distribution spans [0, 1) from draws of 30 bits...
+  {
+    scripted_30_bit_generator g{{0}, 0};
+    assert(dist2d::unit_interval_distribution<float>()(g) == 0 && g.calls == 1);
+    assert(dist2d::unit_interval_distribution<double>()(g) == 0 && g.calls == 3);
+    assert((dist2d::unit_interval_distribution<float,dist2d::dense_conversion>()(g) == 0 && g.calls == 5));
+
+    g = scripted_30_bit_generator{{ones30}, 0};
+    assert(dist2d::unit_interval_distribution<float>()(g) == std::nextafter(1.f, 0.f) && g.calls == 1);
+    assert(dist2d::unit_interval_distribution<double>()(g) == std::nextafter(1.0, 0.0) && g.calls == 3);
+    assert((dist2d::unit_interval_distribution<float,dist2d::dense_conversion>()(g) == std::nextafter(1.f, 0.f)));
+
+    // dense conversion reaches 2^-60, the lowest bit of two draws
+    g = scripted_30_bit_generator{{0, 1}, 0};
+    assert((dist2d::unit_interval_distribution<float,dist2d::dense_conversion>()(g) == std::ldexp(1.f, -60)));
+  }
+
+  // ...and of 16 bits
+  {
+    scripted_16_bit_generator g{{0xffff}, 0};
+    assert(dist2d::unit_interval_distribution<float>()(g) == std::nextafter(1.f, 0.f) && g.calls == 2);
+    assert(dist2d::unit_interval_distribution<double>()(g) == std::nextafter(1.0, 0.0) && g.calls == 6);
+
+    g = scripted_16_bit_generator{{0, 0, 0, 1}, 0};
+    assert((dist2d::unit_interval_distribution<double,dist2d::dense_conversion>()(g) == std::ldexp(1.0, -64) && g.calls == 4));
+  }
+
+  // a 64b result is split between two floats, the first taking its high bits
+  {
+    scripted_64_bit_generator g{{0xffffff000001ffff}, 0};
+    auto u = dist2d::detail::unit_square_from_generator<float,float>(g);
+    assert(u.first == std::nextafter(1.f, 0.f) && u.second == std::ldexp(1.f, -24) && g.calls == 1);
+
+    g = scripted_64_bit_generator{{0}, 0};
+    u = dist2d::detail::unit_square_from_generator<float,float>(g);
+    assert(u.first == 0 && u.second == 0 && g.calls == 1);
+
+    g = scripted_64_bit_generator{{~std::uint64_t(0)}, 0};
+    u = dist2d::detail::unit_square_from_generator<float,float>(g);
+    assert(u.first == std::nextafter(1.f, 0.f) && u.second == std::nextafter(1.f, 0.f) && g.calls == 1);
+  }
+
+  // the split takes the high bits of the span above min(), not of the result
+  {
+    scripted_63_bit_generator g{{(std::uint64_t(1) << 63) - 1}, 0};
+    auto u = dist2d::detail::unit_square_from_generator<float,float>(g);
+    assert(u.first == std::nextafter(1.f, 0.f) && u.second == std::nextafter(1.f, 0.f) && g.calls == 1);
+
+    g = scripted_63_bit_generator{{std::uint64_t(0xffffff) << 39}, 0};
+    u = dist2d::detail::unit_square_from_generator<float,float>(g);
+    assert(u.first == std::nextafter(1.f, 0.f) && u.second == 0 && g.calls == 1);
+
+    g = scripted_63_bit_generator{{std::uint64_t(0xffffff) << 15}, 0};
+    u = dist2d::detail::unit_square_from_generator<float,float>(g);
+    assert(u.first == 0 && u.second == std::nextafter(1.f, 0.f) && g.calls == 1);
+  }
+
+  // coordinates which don't fit in one result are drawn separately
+  {
+    scripted_64_bit_generator g{{~std::uint64_t(0)}, 0};
+    auto u = dist2d::detail::unit_square_from_generator<double,double>(g);
+    assert(u.first == std::nextafter(1.0, 0.0) && u.second == std::nextafter(1.0, 0.0) && g.calls == 2);
+
+    scripted_30_bit_generator h{{ones30, 0}, 0};
+    auto v = dist2d::detail::unit_square_from_generator<float,float>(h);
+    assert(v.first == std::nextafter(1.f, 0.f) && v.second == 0 && h.calls == 2);
+
+    scripted_16_bit_generator k{{0xffff, 0xffff, 0, 1}, 0};
+    auto w = dist2d::detail::unit_square_from_generator<float,float>(k);
+    assert(w.first == std::nextafter(1.f, 0.f) && w.second == 0 && k.calls == 4);
+  }
+}
+
+
+// checks that generate(first, n, ...) stores n distinct points
+template<class Distribution>
+void check_generate_distinct_2d(const Distribution& dist, std::uint64_t first, std::size_t n)
+{
+  std::vector<float> xs(n), ys(n);
+  dist.generate(first, n, xs.data(), ys.data());
+
+  std::vector<std::pair<float,float>> points(n);
+  for(std::size_t k = 0; k < n; ++k)
+  {
+    points[k] = std::make_pair(xs[k], ys[k]);
+  }
+
+  std::sort(points.begin(), points.end());
+  assert(std::unique(points.begin(), points.end()) == points.end());
+}
+
+
+template<class Distribution>
+void check_generate_distinct_3d(const Distribution& dist, std::uint64_t first, std::size_t n)
+{
+  std::vector<float> xs(n), ys(n), zs(n);
+  dist.generate(first, n, xs.data(), ys.data(), zs.data());
+
+  std::vector<std::tuple<float,float,float>> points(n);
+  for(std::size_t k = 0; k < n; ++k)
+  {
+    points[k] = std::make_tuple(xs[k], ys[k], zs[k]);
+  }
+
+  std::sort(points.begin(), points.end());
+  assert(std::unique(points.begin(), points.end()) == points.end());
+}
+
+
+// consecutive sample indices are spread over the square: the indices [0, 4^k) lie one to each cell of a 2^k x 2^k grid,
+// whatever the index of the first, and every batch of them holds distinct points
+void check_sample_indices_spread()
+{
+  dist2d::unit_square_distribution<> square;
+
+  for(std::uint64_t first : {std::uint64_t(0), std::uint64_t(1) << 40})
+  {
+    std::vector<int> cells(256 * 256, 0);
+    for(std::uint64_t i = 0; i < 256 * 256; ++i)
+    {
+      auto p = square(first + i);
+      ++cells[int(p.second * 256) * 256 + int(p.first * 256)];
+    }
+
+    assert(std::all_of(cells.begin(), cells.end(), [](int c){ return c == 1; }));
+  }
+
+  const std::tuple<float,float,float> a{1, 0, 0}, b{0, 1, 0}, c{0, 0, 1};
+
+  for(std::uint64_t first : {std::uint64_t(0), std::uint64_t(12345), std::uint64_t(1) << 48})
+  {
+    for(std::size_t n : {1, 7, 1000})
+    {
+      check_generate_distinct_2d(square, first, n);
+      check_generate_distinct_2d(dist2d::unit_disk_distribution<>(), first, n);
+      check_generate_distinct_2d(dist2d::make_warp_distribution(dist2d::warps::square | dist2d::warps::concentric_disk), first, n);
+      check_generate_distinct_3d(dist2d::unit_sphere_distribution<>(), first, n);
+      check_generate_distinct_3d(dist2d::spherical_triangle_distribution<>(a, b, c), first, n);
+    }
+  }
+}
+
+
+// philox4x32_10 reproduces the known answers of Random123's kat_vectors
+void check_philox_known_answers()
+{
+  struct known_answer
+  {
+    std::uint32_t ctr[4];
+    std::uint32_t key[2];
+    std::uint32_t result[4];
+  };
+
+  const known_answer known_answers[] = {
+    {{0x00000000, 0x00000000, 0x00000000, 0x00000000}, {0x00000000, 0x00000000}, {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+    {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}, {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+    {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}, {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}
+  };
+
+  for(const known_answer& answer : known_answers)
+  {
+    std::uint32_t ctr[4] = {answer.ctr[0], answer.ctr[1], answer.ctr[2], answer.ctr[3]};
+    std::uint32_t key[2] = {answer.key[0], answer.key[1]};
+    dist2d::philox4x32_10::block(ctr, key);
+
+    assert(std::equal(ctr, ctr + 4, answer.result));
+
+    // bits(seed, stream, n) is the low 64b of the block whose counter is (n, stream) and whose key is seed
+    std::uint64_t seed = (std::uint64_t(answer.key[1]) << 32) | answer.key[0];
+    std::uint64_t stream = (std::uint64_t(answer.ctr[3]) << 32) | answer.ctr[2];
+    std::uint64_t n = (std::uint64_t(answer.ctr[1]) << 32) | answer.ctr[0];
+
+    assert(dist2d::philox4x32_10::bits(seed, stream, n) == ((std::uint64_t(answer.result[1]) << 32) | answer.result[0]));
+  }
+}
+
+
+// the halves of pcg_hash_function's results are independent: were the low half a bijection of n, as a hash of n's
+// low 32 bits alone would be, 2^20 consecutive n would never repeat it, and were the high half a function of the low,
+// the results whose low halves repeat would repeat whole
+void check_pcg_hash_halves()
+{
+  const std::uint64_t count = std::uint64_t(1) << 20;
+
+  std::vector<std::uint64_t> results(count);
+  for(std::uint64_t n = 0; n < count; ++n)
+  {
+    std::uint64_t bits = dist2d::pcg_hash_function::bits(7, 3, n);
+    results[n] = (bits << 32) | (bits >> 32);
+  }
+
+  std::sort(results.begin(), results.end());
+
+  // about count^2 / 2^33 = 128 low halves repeat
+  int repeated_low_halves = 0;
+  for(std::size_t i = 1; i < results.size(); ++i)
+  {
+    if((results[i] >> 32) == (results[i-1] >> 32))
+    {
+      ++repeated_low_halves;
+      assert(results[i] != results[i-1]);
+    }
+  }
+
+  assert(repeated_low_halves > 32);
+}
+
+
+// a blur kernel's taps, computed at compile time
+constexpr auto taps = dist2d::make_sample_kernel<16>(dist2d::concentric_unit_disk_distribution<>(), dist2d::sobol_sequence());
+
+
+constexpr bool inside_unit_disk(const std::pair<float,float>& p)
+{
+  return p.first * p.first + p.second * p.second <= 1 + dist2d::detail::surface_tolerance<float>();
+}
+
+
+constexpr bool all_inside_unit_disk(const decltype(taps)& points)
+{
+  for(const auto& p : points)
+  {
+    if(!inside_unit_disk(p)) return false;
+  }
+
+  return true;
+}
+
+
+// Sobol's first points are the corner (0,0) and the center (1/2,1/2), and the next two are reflections through the center
+static_assert(taps.size() == 16, "");
+static_assert(std::get<0>(taps[0]) > -0.707107f && std::get<0>(taps[0]) < -0.7071066f, "");
+static_assert(std::get<1>(taps[0]) > -0.707107f && std::get<1>(taps[0]) < -0.7071066f, "");
+static_assert(std::get<0>(taps[1]) == 0 && std::get<1>(taps[1]) == 0, "");
+static_assert(std::get<0>(taps[2]) == -std::get<1>(taps[2]) && std::get<0>(taps[2]) < 0, "");
+static_assert(std::get<0>(taps[2]) < -0.35355f && std::get<0>(taps[2]) > -0.35356f, "");
+static_assert(all_inside_unit_disk(taps), "");
+
+
+// the optional argument is the path of the sample table the demo bakes, so that each configuration's test bakes its own
+int main(int argc, char** argv)
+{
+  const char* sample_table_path = argc > 1 ? argv[1] : "demo_sample_table.bin";
+
   std::mt19937_64 rng;
 
   dist2d::unit_isoceles_right_triangle_distribution<> dist;
@@ -32,6 +672,305 @@ int main()
 
   assert(almost_equal(dist.area(), estimate));
 
+  // a stratified sample set reaches the same estimate with far fewer samples
+  dist2d::correlated_multi_jittered_sample_set set(4, 4, dist2d::pixel_seed(0, 0));
+
+  estimate = 0;
+  for(unsigned int i = 0; i < set.size(); ++i)
+  {
+    auto urns = set(i);
+    auto p = dist(urns.first, urns.second);
+    assert(dist.contains(p));
+
+    estimate += ((1.f / dist.probability_density(p)) - estimate)/(i+1);
+  }
+
+  assert(almost_equal(dist.area(), estimate));
+
+  // a blue noise tile, scrambled for a pixel, is fed through the distribution like any sample set
+  dist2d::blue_noise_tile tile(0.05);
+  dist2d::scrambled_blue_noise_sample_set blue_noise(tile, dist2d::pixel_seed(0, 0));
+
+  estimate = 0;
+  for(unsigned int i = 0; i < blue_noise.size(); ++i)
+  {
+    auto urns = blue_noise(i);
+    auto p = dist(urns.first, urns.second);
+    assert(dist.contains(p));
+
+    estimate += ((1.f / dist.probability_density(p)) - estimate)/(i+1);
+  }
+
+  assert(almost_equal(dist.area(), estimate));
+
+  // the scrambled points are still no closer than the radius, measured around the square
+  for(unsigned int i = 0; i < blue_noise.size(); ++i)
+  {
+    for(unsigned int j = 0; j < i; ++j)
+    {
+      auto a = blue_noise(i), b = blue_noise(j);
+
+      float dx = std::min(a.first - b.first, b.first - a.first) / 4294967296.f;
+      float dy = std::min(a.second - b.second, b.second - a.second) / 4294967296.f;
+      assert(std::sqrt(dx * dx + dy * dy) >= 0.0499f);
+    }
+  }
+
+  // so are the Poisson-disk points of the sphere, which lie on it
+  dist2d::counter_based_engine<> g;
+  auto directions = dist2d::poisson_disk_unit_sphere(0.2, g);
+  for(unsigned int i = 0; i < directions.size(); ++i)
+  {
+    float x = std::get<0>(directions[i]), y = std::get<1>(directions[i]), z = std::get<2>(directions[i]);
+    assert(std::fabs(x * x + y * y + z * z - 1) < 0.00001f);
+
+    for(unsigned int j = 0; j < i; ++j)
+    {
+      float dx = x - std::get<0>(directions[j]), dy = y - std::get<1>(directions[j]), dz = z - std::get<2>(directions[j]);
+      assert(std::sqrt(dx * dx + dy * dy + dz * dz) >= 0.1999f);
+    }
+  }
+
+  // a packed point type may be a distribution's Point, whose coordinates are decoded for contains(), inverse(), and the density
+  dist2d::unit_sphere_distribution<dist2d::octahedral_unit_vector> packed_sphere;
+  dist2d::unit_sphere_distribution<> sphere;
+  for(unsigned int i = 0; i < 1000; ++i)
+  {
+    auto packed = packed_sphere(g);
+    assert(packed_sphere.contains(packed));
+    assert(packed_sphere.probability_density(packed) == sphere.probability_density(packed.decode()));
+
+    auto u = packed_sphere.inverse(packed);
+    auto unpacked = sphere(u.first, u.second);
+    assert(std::fabs(std::get<2>(unpacked) - std::get<2>(packed.decode())) < 0.0001f);
+  }
+
+  // the Sobol points are spread over the disk, so their half precision codes differ, and each is within half's precision
+  // of the float point
+  dist2d::unit_disk_distribution<dist2d::half2> packed_disk;
+  dist2d::unit_disk_distribution<> disk;
+  std::vector<std::pair<float,float>> decoded;
+  for(std::uint32_t i = 0; i < 1000; ++i)
+  {
+    auto urns = dist2d::sobol_sequence()(i);
+    auto packed = packed_disk(urns.first, urns.second);
+    auto p = packed.decode();
+    auto q = disk(urns.first, urns.second);
+    assert(std::fabs(p.first - q.first) <= std::max(std::fabs(q.first) / 2048, 0.0001f));
+    assert(std::fabs(p.second - q.second) <= std::max(std::fabs(q.second) / 2048, 0.0001f));
+
+    auto u = packed_disk.inverse(packed);
+    auto r = disk(u.first, u.second);
+    assert(std::fabs(p.first - r.first) < 0.002f && std::fabs(p.second - r.second) < 0.002f);
+
+    decoded.push_back(p);
+  }
+
+  std::sort(decoded.begin(), decoded.end());
+  assert(std::unique(decoded.begin(), decoded.end()) == decoded.end());
+
+  // a baked sample table holds dist(source(k)) for a sample set, a sequence, or the Morton order of operator()(Integer i)
+  check_sample_table_round_trip(sample_table_path, dist2d::unit_disk_distribution<>(), dist2d::index_range(), 1000);
+  check_sample_table_round_trip(sample_table_path, dist2d::unit_sphere_distribution<>(), dist2d::correlated_multi_jittered_sample_set(16, 16, 7), 256);
+  check_sample_table_round_trip(sample_table_path, dist, dist2d::owen_scrambled_sobol_sequence(13), 1024);
+  check_sample_table_round_trip(sample_table_path, dist, dist2d::random_indices(5), 1000);
+
+  // a finite point source can't supply more points than it has
+  bool threw = false;
+  try
+  {
+    dist2d::bake_sample_table(sample_table_path, dist, dist2d::jittered_sample_set(4, 4), 17, dist2d::sample_encoding::float32);
+  }
+  catch(const std::invalid_argument&)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  // a table whose count overflows the size of its coordinate arrays is rejected as truncated
+  {
+    dist2d::bake_sample_table(sample_table_path, dist, dist2d::index_range(), 100, dist2d::sample_encoding::float32);
+
+    // the intact table holds 100 distinct points
+    {
+      dist2d::sample_table<> table(sample_table_path);
+      assert(table.size() == 100);
+
+      std::vector<std::pair<float,float>> points;
+      for(std::uint64_t k = 0; k < 100; ++k)
+      {
+        assert(table(k) == dist(k));
+        points.push_back(table(k));
+      }
+
+      std::sort(points.begin(), points.end());
+      assert(std::unique(points.begin(), points.end()) == points.end());
+    }
+
+    dist2d::detail::sample_table_header header;
+    {
+      std::ifstream file(sample_table_path, std::ios::binary);
+      file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+
+    for(std::uint64_t count : {std::uint64_t(101), std::uint64_t(1) << 62, ~std::uint64_t(0)})
+    {
+      header.count = count;
+      {
+        std::fstream file(sample_table_path, std::ios::binary | std::ios::in | std::ios::out);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      }
+
+      threw = false;
+      try
+      {
+        dist2d::sample_table<> table(sample_table_path);
+      }
+      catch(const std::runtime_error&)
+      {
+        threw = true;
+      }
+      assert(threw);
+    }
+
+    std::remove(sample_table_path);
+  }
+
+  // the sequences keep their stratification for every seed
+  check_02_net_prefixes(dist2d::sobol_sequence(), 12);
+  for(std::uint32_t seed : {0u, 1u, 2u, 3u, 0xffffffffu, dist2d::pixel_seed(0, 0), dist2d::pixel_seed(17, 3)})
+  {
+    check_02_net_prefixes(dist2d::owen_scrambled_sobol_sequence(seed), 12);
+  }
+
+  check_halton_prefixes();
+
+  check_r2_prefixes(dist2d::r2_sequence());
+  check_r2_prefixes(dist2d::r2_sequence({0u, 0u}));
+  check_r2_prefixes(dist2d::r2_sequence({dist2d::pixel_seed(5, 9), dist2d::pixel_seed(9, 5)}));
+
+  // the mesh's triangle records each fill whole cache lines, so their allocation is aligned to them
+  for(std::size_t n : {1, 3, 1000})
+  {
+    std::vector<dist2d::detail::mesh_triangle<float>, dist2d::detail::aligned_allocator<dist2d::detail::mesh_triangle<float>>> triangles(n);
+    assert(reinterpret_cast<std::uintptr_t>(triangles.data()) % 64 == 0);
+  }
+
+  // the compile time taps agree with the run time ones, to within constexpr_math's error
+  for(std::uint32_t i = 0; i < taps.size(); ++i)
+  {
+    auto urns = dist2d::sobol_sequence()(i);
+    auto tap = dist2d::concentric_unit_disk_distribution<>()(urns.first, urns.second);
+    assert(std::fabs(taps[i].first - tap.first) < 0.000001f && std::fabs(taps[i].second - tap.second) < 0.000001f);
+  }
+
+  check_philox_known_answers();
+  check_pcg_hash_halves();
+  check_sample_indices_spread();
+
+  check_unit_interval_conversions();
+  check_precision_urn_conversion();
+  check_generator_draws();
+
+  // a spherical rectangle's edges must be perpendicular, up to rounding
+  {
+    using point3 = std::tuple<float,float,float>;
+    point3 origin{0, 0, 0}, corner{-0.5f, -0.5f, 1};
+
+    dist2d::spherical_rectangle_distribution<> rectangle(origin, corner, point3{1, 0, 0}, point3{0, 1, 0});
+    assert(rectangle.area() > 0);
+
+    dist2d::spherical_rectangle_distribution<> rotated(origin, corner, point3{0.6f, 0.8f, 0}, point3{-0.8f, 0.6f, 0});
+    assert(rotated.area() > 0);
+
+    for(point3 ey : {point3{0.1f, 1, 0}, point3{1, 1, 0}, point3{1, 0, 0}, point3{0, 0, 0}})
+    {
+      threw = false;
+      try
+      {
+        dist2d::spherical_rectangle_distribution<> parallelogram(origin, corner, point3{1, 0, 0}, ey);
+      }
+      catch(const std::invalid_argument&)
+      {
+        threw = true;
+      }
+      assert(threw);
+    }
+  }
+
+  // every Morton decoder agrees with the reference, exhaustively on the low 20 bits, and on random codes
+  for(std::uint64_t m = 0; m < (1 << 20); ++m)
+  {
+    check_morton_decoders(m);
+  }
+
+  std::mt19937_64 codes(7);
+  for(int i = 0; i < 100000; ++i)
+  {
+    check_morton_decoders(codes());
+  }
+
+  // the batch decoders handle any length and starting code, including ranges which cross 2^32 and wrap around 2^64
+  for(std::size_t n : {0, 1, 3, 4, 7, 8, 9, 31, 1000})
+  {
+    for(std::uint64_t first : {std::uint64_t(0), std::uint64_t(5), (std::uint64_t(1) << 32) - 4, ~std::uint64_t(0) - 6, std::uint64_t(codes())})
+    {
+      check_batch_morton_decoders(first, n);
+    }
+  }
+
+  // parallel_generate's samples depend only on the seed and their position, whatever the threads and grain size
+  {
+    const std::size_t n = 10007;
+
+    std::vector<std::pair<float,float>> expected(n);
+    dist2d::parallel_generate(dist2d::execution::seq, dist2d::unit_disk_distribution<>(), 13, n, expected.begin());
+
+    for(std::size_t num_threads : {1, 2, 3, 8})
+    {
+      for(std::size_t grain_size : {0, 1, 7, 1000, 100000})
+      {
+        std::vector<std::pair<float,float>> actual(n);
+        auto end = dist2d::parallel_generate(dist2d::execution::parallel_policy(num_threads, grain_size), dist2d::unit_disk_distribution<>(), 13, n, actual.begin());
+
+        assert(end == actual.end());
+        assert(actual == expected);
+      }
+    }
+
+    // the samples are the batch generate()'s points of a random run of indices
+    static_assert(dist2d::detail::has_batch_generate<dist2d::unit_disk_distribution<>>::value, "");
+    static_assert(dist2d::detail::has_batch_generate<dist2d::unit_sphere_distribution<>>::value, "");
+    static_assert(dist2d::detail::has_batch_generate<decltype(dist2d::make_warp_distribution(dist2d::warps::square | dist2d::warps::uniform_sphere))>::value, "");
+
+    std::uint64_t first = dist2d::counter_based_generator<>(13)(0, 0);
+
+    std::vector<float> xs(n), ys(n);
+    dist2d::unit_disk_distribution<>().generate(first, n, xs.data(), ys.data());
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      assert(expected[k] == std::make_pair(xs[k], ys[k]));
+    }
+
+    std::vector<std::tuple<float,float,float>> expected_3d(n), actual_3d(n);
+    dist2d::parallel_generate(dist2d::execution::seq, dist2d::unit_sphere_distribution<>(), 13, n, expected_3d.begin());
+    dist2d::parallel_generate(dist2d::execution::parallel_policy(3, 7), dist2d::unit_sphere_distribution<>(), 13, n, actual_3d.begin());
+
+    assert(actual_3d == expected_3d);
+  }
+
+  // a warp pipeline's stages must meet at their domains, so e.g. the disk can't be fed to a stage which expects the square
+  using namespace dist2d::warps;
+  static_assert(dist2d::is_composable_warp<decltype(square | concentric_disk), dist2d::lift_to_hemisphere_warp>::value, "");
+  static_assert(dist2d::is_composable_warp<decltype(square | uniform_sphere), dist2d::rotate_to_frame_warp<float>>::value, "");
+  static_assert(!dist2d::is_composable_warp<decltype(square | concentric_disk), dist2d::uniform_sphere_warp>::value, "");
+  static_assert(!dist2d::is_composable_warp<decltype(square | uniform_sphere), dist2d::lift_to_hemisphere_warp>::value, "");
+  static_assert(!dist2d::is_composable_warp<decltype(square | uniform_hemisphere | rotate_to(0.f, 0.f, 1.f)), dist2d::lift_to_hemisphere_warp>::value, "");
+
+  auto cosine_pipeline = dist2d::make_warp_distribution(square | concentric_disk | lift_to_hemisphere);
+  auto sample = cosine_pipeline.sample_with_pdf(0.25f, 0.75f);
+  assert(almost_equal(sample.second, std::get<2>(sample.first) / 3.14159265f));
+
   std::cout << "OK" << std::endl;
 
   return 0;
@@ -1,21 +1,127 @@
 #pragma once
 
 #include "unit_square_distribution.hpp"
+#include "detail/concentric_warp.hpp"
+#include "packed_point.hpp"
+#include "detail/simd.hpp"
+#include "detail/math_constants.hpp"
+#include "precision.hpp"
+#include "detail/coordinate.hpp"
 #include <utility>
 #include <tuple>
 #include <limits>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <type_traits>
 
 namespace dist2d
 {
 
 
+// the concentric mapping of Shirley & Chiu, "A Low Distortion Map Between Disk and Square"
+// this evaluates the mapping's four regions with branches, and sin & cos with Precision::sincos_turns
+struct polar_concentric_mapping
+{
+  template<class Precision = accurate_precision, class Real1, class Real2>
+  constexpr static void warp(Real1 u1, Real2 u2, Real1& x, Real2& y)
+  {
+    using Real = typename std::common_type<Real1, Real2>::type;
+
+    // map uniform random variables to [-1, 1) x [-1, 1)
+    Real1 sx = Real1(2) * u1 - Real2(1);
+    Real2 sy = Real2(2) * u2 - Real2(1);
+
+    // map square to (r, theta)
+    Real r = 0;
+    Real theta = 0;
+
+    // handle degeneracy at the origin
+    if(sx == 0 && sy == 0)
+    {
+      x = 0;
+      y = 0;
+      return;
+    } // end if
+
+    if(sx >= -sy)
+    {
+      if(sx > sy)
+      {
+        // first region of disk
+        r = sx;
+        if(sy > 0)
+        {
+          theta = sy / r;
+        }
+        else
+        {
+          theta = Real(8) + sy / r;
+        }
+      }
+      else
+      {
+        // second region of disk
+        r = sy;
+        theta = Real(2) - sx/r;
+      }
+    }
+    else
+    {
+      if(sx <= sy)
+      {
+        // third region of disk
+        r = -sx;
+        theta = Real(4) - sy/r;
+      }
+      else
+      {
+        // fourth region of disk
+        r = -sy;
+        theta = Real(6) + sx/r;
+      }
+    }
+
+    // theta is measured in eighths of a turn
+    Real s = 0, c = 0;
+    Precision::sincos_turns(theta * Real(0.125), s, c);
+
+    x = r * c;
+    y = r * s;
+  }
+};
+
+
+// the same mapping, evaluated with selects instead of branches and polynomials instead of std::cos & std::sin
+// this trades about 1e-7 of accuracy for a mapping which vectorizes and does not mispredict
+// for float, generate() evaluates it with vector kernels whose results are bitwise identical to the scalar results
+// its polynomials are its own, so it evaluates them whatever the Precision
+// see detail/concentric_warp.hpp
+struct branchless_concentric_mapping
+{
+  template<class Precision = accurate_precision, class Real1, class Real2>
+  constexpr static void warp(Real1 u1, Real2 u2, Real1& x, Real2& y)
+  {
+    using Real = typename std::common_type<Real1, Real2>::type;
+
+    Real rx = 0, ry = 0;
+    detail::branchless_concentric_warp(Real(u1), Real(u2), rx, ry);
+
+    x = rx;
+    y = ry;
+  }
+};
+
+
 // a uniform distribution of points on the unit disk
 // this distribution better preserves distances between nearby points
 // than does unit_disk_distribution
-template<class Point = std::pair<float,float>>
+// Mapping selects how the square is mapped to the disk
+// Precision selects the type in which the mapping is evaluated, and how polar_concentric_mapping evaluates sin & cos,
+// see precision.hpp
+template<class Point = std::pair<float,float>, class Mapping = polar_concentric_mapping, class Precision = accurate_precision>
 class concentric_unit_disk_distribution
 {
   public:
@@ -29,73 +135,77 @@ class concentric_unit_disk_distribution
     using real_type = typename std::common_type<real_type1, real_type2>::type;
 
   private:
-    static constexpr real_type pi = 3.14159265;
+    using compute_type = typename Precision::template compute_type<real_type>;
+
+    static constexpr real_type pi = real_type(detail::math_constants::pi);
 
   public:
-    template<class Integer1, class Integer2>
-    result_type operator()(Integer1 urn1, Integer2 urn2) const
+    // maps (u1, u2) in [0,1)^2 to the point (x, y) on the unit disk
+    constexpr static void warp(compute_type u1, compute_type u2, real_type1& x, real_type2& y)
     {
-      unit_square_distribution<Point> square;
+      compute_type cx = 0, cy = 0;
+      Mapping::template warp<Precision>(u1, u2, cx, cy);
 
-      real_type1 u1;
-      real_type2 u2;
-      std::tie(u1,u2) = square(urn1,urn2);
+      x = real_type1(cx);
+      y = real_type2(cy);
+    }
 
-      // map uniform random variables to [-1, 1) x [-1, 1)
-      real_type1 sx = real_type1(2) * u1 - real_type2(1);
-      real_type2 sy = real_type2(2) * u2 - real_type2(1);
+    // the inverse of warp: maps the point (x, y) on the unit disk to (u1, u2) in [0,1)^2
+    static void inverse_warp(real_type1 x, real_type2 y, real_type1& u1, real_type2& u2)
+    {
+      real_type ru1, ru2;
+      detail::concentric_inverse(real_type(x), real_type(y), ru1, ru2);
 
-      // map square to (r, theta)
-      real_type r = 0;
-      real_type theta = 0;
+      u1 = detail::clamp_to_unit_interval(real_type1(ru1));
+      u2 = detail::clamp_to_unit_interval(real_type2(ru2));
+    }
 
-      // handle degeneracy at the origin
-      if(sx == 0 && sy == 0)
-      {
-        return result_type{0,0};
-      } // end if
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      result_type
+    >::type
+      operator()(Float1 u1, Float2 u2) const
+    {
+      real_type1 x = 0;
+      real_type2 y = 0;
+      warp(u1, u2, x, y);
 
-      if(sx >= -sy)
-      {
-        if(sx > sy)
-        {
-          // first region of disk
-          r = sx;
-          if(sy > 0)
-          {
-            theta = sy / r;
-          }
-          else
-          {
-            theta = real_type(8) + sy / r;
-          }
-        }
-        else
-        {
-          // second region of disk
-          r = sy;
-          theta = real_type(2) - sx/r;
-        }
-      }
-      else
-      {
-        if(sx <= sy)
-        {
-          // third region of disk
-          r = -sx;
-          theta = real_type(4) - sy/r;
-        }
-        else
-        {
-          // fourth region of disk
-          r = -sy;
-          theta = real_type(6) + sx/r;
-        }
-      }
+      return result_type{x, y};
+    }
+
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 urn1, Integer2 urn2) const
+    {
+      // the square's coordinates are compute_types, even if Point's coordinates are e.g. packed
+      auto u = unit_square_distribution<std::pair<compute_type,compute_type>>()(urn1, urn2);
 
-      theta *= real_type(0.25) * pi;
+      return operator()(u.first, u.second);
+    }
 
-      return result_type{r * std::cos(theta), r * std::sin(theta)};
+    // returns operator()(u1, u2) with its density, which is the constant 1 / area()
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      return std::make_pair(operator()(u1, u2), real_type(1) / area());
+    }
+
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      return std::make_pair(operator()(urn1, urn2), real_type(1) / area());
     }
 
     template<class Integer,
@@ -104,7 +214,7 @@ class concentric_unit_disk_distribution
              >::type>
     result_type operator()(Integer i) const
     {
-      auto xy = decode_morton_2d(i);
+      auto xy = morton_urns(i);
       return operator()(xy.first, xy.second);
     }
 
@@ -114,26 +224,159 @@ class concentric_unit_disk_distribution
              >::type>
     result_type operator()(Generator& g) const
     {
-      return operator()(g());
+      auto u = detail::unit_square_from_generator<compute_type,compute_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs and ys
+    // with branchless_concentric_mapping, float coordinates, and a Precision which computes in float, the points are computed by
+    // the vector kernels of detail/simd.hpp
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys) const
+    {
+      generate(first_index, count, xs, ys, use_simd_kernels());
+    }
+
+    // stores the points operator()(first_index), ..., operator()(first_index + count - 1) to out,
+    // packed into a type constructible from their coordinates, such as half2 or unorm16_disk_point of packed_point.hpp
+    // the points are generated a chunk at a time and packed while in cache, so no array of unpacked points is stored
+    template<class Integer, class Packed,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value &&
+               std::is_constructible<Packed, real_type1, real_type2>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, Packed* out) const
+    {
+      detail::generate_packed(*this, first_index, count, out);
+    }
+
+    // maps the point p back to the (u1, u2) in [0,1)^2 which operator() maps to it
+    static std::pair<real_type1,real_type2> inverse(const result_type& p)
+    {
+      real_type1 u1;
+      real_type2 u2;
+      inverse_warp(detail::coordinate<0>(p), detail::coordinate<1>(p), u1, u2);
+
+      return std::make_pair(u1, u2);
+    }
+
+    // stores the inverse of each of the points (xs[i], ys[i]) to (u1s[i], u2s[i])
+    // for float this loop is branch free, and vectorizes when compiled with -fno-math-errno -fno-trapping-math
+    static void inverse(std::size_t count, const real_type1* xs, const real_type2* ys, real_type1* u1s, real_type2* u2s)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        inverse_warp(xs[i], ys[i], u1s[i], u2s[i]);
+      }
     }
 
     static bool contains(const result_type& p)
     {
-      real_type radius_squared = std::get<0>(p) * std::get<0>(p) + std::get<1>(p) * std::get<1>(p);
-      real_type radius = std::sqrt(radius_squared);
-      return real_type(0) <= radius && radius <= real_type(1);
+      real_type radius_squared = detail::coordinate<0>(p) * detail::coordinate<0>(p) + detail::coordinate<1>(p) * detail::coordinate<1>(p);
+
+      return real_type(0) <= radius_squared && radius_squared <= real_type(1);
+    }
+
+    // stores contains((xs[i], ys[i])) to mask[i] for each of the count points
+    // when every coordinate is a float, this is computed by the vector kernels of detail/simd.hpp
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask)
+    {
+      contains(count, xs, ys, mask, use_simd_contains());
     }
 
     // if !contains(p) the result is undefined
-    constexpr static real_type probability_density(const result_type& p)
+    constexpr static real_type probability_density(const result_type&)
     {
       return real_type(1) / area();
     }
 
+    // stores the density at each of the count points (xs[i], ys[i]) to pdfs[i], or 0 where the point is not contained
+    static void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, real_type* pdfs)
+    {
+      const real_type density = real_type(1) / area();
+
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, mask);
+
+        detail::simd::select_density(mask, n, density, pdfs + i);
+      }
+    }
+
     constexpr static real_type area()
     {
       return pi;
     }
+
+  private:
+    using use_simd_kernels = std::integral_constant<
+      bool,
+      std::is_same<Mapping,branchless_concentric_mapping>::value &&
+      std::is_same<real_type1,float>::value &&
+      std::is_same<real_type2,float>::value &&
+      std::is_same<compute_type,float>::value
+    >;
+
+    using use_simd_contains = std::integral_constant<
+      bool,
+      std::is_same<real_type1,float>::value &&
+      std::is_same<real_type2,float>::value
+    >;
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask, std::false_type)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i]});
+      }
+    }
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask, std::true_type)
+    {
+      detail::simd::disk_contains(xs, ys, count, true, mask);
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, std::false_type) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto xy = morton_urns(static_cast<Integer>(first_index + k));
+
+        compute_type u1 = unit_interval_distribution<compute_type>()(xy.first);
+        compute_type u2 = unit_interval_distribution<compute_type>()(xy.second);
+
+        warp(u1, u2, xs[k], ys[k]);
+      }
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, std::true_type) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        // stage the chunk's points in [0,1)^2 in xs & ys and warp them in place
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          xs[i + k] = unit_interval_distribution<float>()(urn1s[k]);
+          ys[i + k] = unit_interval_distribution<float>()(urn2s[k]);
+        }
+
+        detail::simd::concentric_warp(xs + i, ys + i, n, xs + i, ys + i);
+      }
+    }
 };
 
 
@@ -1,18 +1,25 @@
 #pragma once
 
 #include "concentric_unit_disk_distribution.hpp"
+#include "detail/orthonormal_basis.hpp"
+#include "detail/math_constants.hpp"
+#include "detail/coordinate.hpp"
 #include <tuple>
 #include <utility>
 #include <algorithm>
 #include <cmath>
 #include <type_traits>
+#include <cstddef>
 
 namespace dist2d
 {
 
 
 // a cosine-weighted distribution of points on the unit hemisphere
-template<class Point = std::tuple<float,float,float>>
+// Mapping selects how concentric_unit_disk_distribution maps the square to the disk
+// Precision selects the type in which the warp is evaluated, and how polar_concentric_mapping evaluates sin & cos,
+// see precision.hpp
+template<class Point = std::tuple<float,float,float>, class Mapping = polar_concentric_mapping, class Precision = accurate_precision>
 class cosine_weighted_unit_hemisphere_distribution
 {
   public:
@@ -27,31 +34,99 @@ class cosine_weighted_unit_hemisphere_distribution
     using real_type = typename std::common_type<real_type1, real_type2, real_type3>::type;
 
   private:
-    static constexpr real_type pi = 3.14159265;
-    static constexpr real_type two_pi = real_type(2) * pi;
+    using compute_type = typename Precision::template compute_type<real_type>;
+
+    static constexpr real_type pi = real_type(detail::math_constants::pi);
+    static constexpr real_type one_over_pi = real_type(detail::math_constants::one_over_pi);
 
   public:
-    template<class Integer1, class Integer2>
-    result_type operator()(Integer1 urn1, Integer2 urn2) const
+    // maps (u1, u2) in [0,1)^2 to the point (x, y, z) on the unit hemisphere
+    constexpr static void warp(compute_type u1, compute_type u2, real_type1& x, real_type2& y, real_type3& z)
+    {
+      // the disk's point is lifted before it is rounded
+      compute_type cx = 0, cy = 0;
+      concentric_unit_disk_distribution<std::pair<compute_type,compute_type>, Mapping, Precision>::warp(u1, u2, cx, cy);
+
+      x = real_type1(cx);
+      y = real_type2(cy);
+      z = real_type3(detail::lift_to_hemisphere(cx, cy));
+    }
+
+    // the inverse of warp: maps the point (x, y, z) on the unit hemisphere to (u1, u2) in [0,1)^2
+    // only x & y determine the result
+    static void inverse_warp(real_type1 x, real_type2 y, real_type3, real_type& u1, real_type& u2)
     {
-      concentric_unit_disk_distribution<std::pair<real_type1,real_type2>> unit_disk;
+      real_type1 ru1;
+      real_type2 ru2;
+      concentric_unit_disk_distribution<std::pair<real_type1,real_type2>, Mapping>::inverse_warp(x, y, ru1, ru2);
 
-      real_type1 x;
-      real_type2 y;
-      std::tie(x,y) = unit_disk(urn1,urn2);
+      u1 = ru1;
+      u2 = ru2;
+    }
 
-      real_type3 z = std::sqrt(std::max(real_type3(0), real_type3(1) - x*x - y*y));
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      result_type
+    >::type
+      operator()(Float1 u1, Float2 u2) const
+    {
+      real_type1 x = 0;
+      real_type2 y = 0;
+      real_type3 z = 0;
+      warp(u1, u2, x, y, z);
 
       return result_type{x,y,z};
     }
 
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 urn1, Integer2 urn2) const
+    {
+      auto u = unit_square_distribution<std::pair<compute_type,compute_type>>()(urn1, urn2);
+
+      return operator()(u.first, u.second);
+    }
+
+    // returns operator()(u1, u2) with its density z / pi
+    // the warp has already computed z, so the density costs a multiply
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      real_type1 x = 0;
+      real_type2 y = 0;
+      real_type3 z = 0;
+      warp(u1, u2, x, y, z);
+
+      return std::make_pair(result_type{x,y,z}, real_type(z) * one_over_pi);
+    }
+
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      auto u = unit_square_distribution<std::pair<compute_type,compute_type>>()(urn1, urn2);
+
+      return sample_with_pdf(u.first, u.second);
+    }
+
     template<class Integer,
              class = typename std::enable_if<
                std::is_integral<Integer>::value
              >::type>
     result_type operator()(Integer i) const
     {
-      auto xy = decode_morton_2d(i);
+      auto xy = morton_urns(i);
       return operator()(xy.first, xy.second);
     }
 
@@ -61,29 +136,230 @@ class cosine_weighted_unit_hemisphere_distribution
              >::type>
     result_type operator()(Generator& g) const
     {
-      return operator()(g());
+      auto u = detail::unit_square_from_generator<compute_type,compute_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs, ys, and zs
+    // with branchless_concentric_mapping, float coordinates, and a Precision which computes in float, the points are computed by
+    // the vector kernels of detail/simd.hpp
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs) const
+    {
+      generate(first_index, count, xs, ys, zs, use_simd_kernels());
+    }
+
+    // stores the points operator()(first_index), ..., operator()(first_index + count - 1) to the arrays xs, ys, and zs,
+    // each rotated from the hemisphere around +z to the hemisphere around its unit normal (nxs[k], nys[k], nzs[k])
+    // the rotation is by the branchless orthonormal basis of detail/orthonormal_basis.hpp
+    // the outputs may alias the normals, e.g. xs == nxs, so a batch of normals may be replaced by directions around them
+    // with branchless_concentric_mapping, float coordinates, and a Precision which computes in float, the warp and the rotation are
+    // fused in the vector kernels of detail/simd.hpp
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count,
+                  const real_type1* nxs, const real_type2* nys, const real_type3* nzs,
+                  real_type1* xs, real_type2* ys, real_type3* zs) const
+    {
+      generate(first_index, count, nxs, nys, nzs, xs, ys, zs, use_simd_kernels());
+    }
+
+    // stores the points operator()(first_index), ..., operator()(first_index + count - 1) to out,
+    // packed into a type constructible from their coordinates, such as octahedral_unit_vector or half3 of packed_point.hpp
+    // the points are generated a chunk at a time and packed while in cache, so no array of unpacked points is stored
+    template<class Integer, class Packed,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value &&
+               std::is_constructible<Packed, real_type1, real_type2, real_type3>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, Packed* out) const
+    {
+      detail::generate_packed(*this, first_index, count, out);
+    }
+
+    // maps the point p back to the (u1, u2) in [0,1)^2 which operator() maps to it
+    static std::pair<real_type,real_type> inverse(const result_type& p)
+    {
+      real_type u1, u2;
+      inverse_warp(detail::coordinate<0>(p), detail::coordinate<1>(p), detail::coordinate<2>(p), u1, u2);
+
+      return std::make_pair(u1, u2);
+    }
+
+    // stores the inverse of each of the points (xs[i], ys[i], zs[i]) to (u1s[i], u2s[i])
+    // for float this loop is branch free, and vectorizes when compiled with -fno-math-errno -fno-trapping-math
+    static void inverse(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* u1s, real_type* u2s)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        inverse_warp(xs[i], ys[i], zs[i], u1s[i], u2s[i]);
+      }
     }
 
     static bool contains(const result_type& p)
     {
       // p must not be in the -z hemisphere
-      if(std::get<2>(p) < 0) return false;
+      if(detail::coordinate<2>(p) < 0) return false;
 
-      real_type radius_squared = std::get<0>(p) * std::get<0>(p) + std::get<1>(p) * std::get<1>(p) + std::get<2>(p) * std::get<2>(p);
+      real_type radius_squared = detail::coordinate<0>(p) * detail::coordinate<0>(p) + detail::coordinate<1>(p) * detail::coordinate<1>(p) + detail::coordinate<2>(p) * detail::coordinate<2>(p);
 
-      return std::fabs(real_type(1) - radius_squared) < 0.000005f;
+      return std::fabs(real_type(1) - radius_squared) < detail::surface_tolerance<real_type>();
+    }
+
+    // stores contains((xs[i], ys[i], zs[i])) to mask[i] for each of the count points
+    // when every coordinate is a float, this is computed by the vector kernels of detail/simd.hpp
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask)
+    {
+      contains(count, xs, ys, zs, mask, use_simd_contains());
     }
 
+    // the density cos(theta) / pi = z / pi with respect to solid angle
     // if !contains(p) the result is undefined
     constexpr static real_type probability_density(const result_type& p)
     {
-      return real_type(1) / area();
+      return real_type(detail::coordinate<2>(p)) * one_over_pi;
+    }
+
+    // stores the density at each of the count points (xs[i], ys[i], zs[i]) to pdfs[i], or 0 where the point is not contained
+    static void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* pdfs)
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, zs + i, mask);
+
+        detail::simd::select_scaled_density(mask, zs + i, n, one_over_pi, pdfs + i);
+      }
     }
 
+    // the area of the support, the unit hemisphere
     constexpr static real_type area()
     {
       return real_type(2) * pi;
     }
+
+  private:
+    using use_simd_kernels = std::integral_constant<
+      bool,
+      std::is_same<Mapping,branchless_concentric_mapping>::value &&
+      std::is_same<real_type1,float>::value &&
+      std::is_same<real_type2,float>::value &&
+      std::is_same<real_type3,float>::value &&
+      std::is_same<compute_type,float>::value
+    >;
+
+    using use_simd_contains = std::integral_constant<
+      bool,
+      std::is_same<real_type1,float>::value &&
+      std::is_same<real_type2,float>::value &&
+      std::is_same<real_type3,float>::value
+    >;
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask, std::false_type)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i], zs[i]});
+      }
+    }
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask, std::true_type)
+    {
+      detail::simd::hemisphere_contains(xs, ys, zs, count, mask);
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs, std::false_type) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto xy = morton_urns(static_cast<Integer>(first_index + k));
+
+        compute_type u1 = unit_interval_distribution<compute_type>()(xy.first);
+        compute_type u2 = unit_interval_distribution<compute_type>()(xy.second);
+
+        warp(u1, u2, xs[k], ys[k], zs[k]);
+      }
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs, std::true_type) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        // stage the chunk's points in [0,1)^2 in xs & ys and warp them in place
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          xs[i + k] = unit_interval_distribution<float>()(urn1s[k]);
+          ys[i + k] = unit_interval_distribution<float>()(urn2s[k]);
+        }
+
+        detail::simd::cosine_hemisphere_warp(xs + i, ys + i, n, xs + i, ys + i, zs + i);
+      }
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count,
+                  const real_type1* nxs, const real_type2* nys, const real_type3* nzs,
+                  real_type1* xs, real_type2* ys, real_type3* zs, std::false_type) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto xy = morton_urns(static_cast<Integer>(first_index + k));
+
+        compute_type u1 = unit_interval_distribution<compute_type>()(xy.first);
+        compute_type u2 = unit_interval_distribution<compute_type>()(xy.second);
+
+        real_type1 x = 0;
+        real_type2 y = 0;
+        real_type3 z = 0;
+        warp(u1, u2, x, y, z);
+
+        real_type wx = x, wy = y, wz = z;
+        detail::to_frame(real_type(nxs[k]), real_type(nys[k]), real_type(nzs[k]), wx, wy, wz);
+
+        xs[k] = real_type1(wx);
+        ys[k] = real_type2(wy);
+        zs[k] = real_type3(wz);
+      }
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count,
+                  const real_type1* nxs, const real_type2* nys, const real_type3* nzs,
+                  real_type1* xs, real_type2* ys, real_type3* zs, std::true_type) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        // the outputs may alias the normals, so the chunk's points in [0,1)^2 are staged on the stack
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        float u1s[detail::simd::chunk_size], u2s[detail::simd::chunk_size];
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          u1s[k] = unit_interval_distribution<float>()(urn1s[k]);
+          u2s[k] = unit_interval_distribution<float>()(urn2s[k]);
+        }
+
+        detail::simd::cosine_hemisphere_warp_to_frame(u1s, u2s, nxs + i, nys + i, nzs + i, n, xs + i, ys + i, zs + i);
+      }
+    }
 };
 
 
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+inline void mulhilo32(std::uint32_t a, std::uint32_t b, std::uint32_t& hi, std::uint32_t& lo)
+{
+  std::uint64_t product = std::uint64_t(a) * std::uint64_t(b);
+  hi = static_cast<std::uint32_t>(product >> 32);
+  lo = static_cast<std::uint32_t>(product);
+}
+
+
+// see Jarzynski & Olano, "Hash Functions for GPU Rendering", 2020
+inline std::uint32_t pcg_hash(std::uint32_t x)
+{
+  std::uint32_t state = x * 747796405u + 2891336453u;
+  std::uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+  return (word >> 22u) ^ word;
+}
+
+
+// see Jarzynski & Olano, "Hash Functions for GPU Rendering", 2020
+// each of the 4 results depends on all 4 inputs
+inline void pcg4d(std::uint32_t v[4])
+{
+  for(int i = 0; i < 4; ++i)
+  {
+    v[i] = v[i] * 1664525u + 1013904223u;
+  }
+
+  v[0] += v[1] * v[3];
+  v[1] += v[2] * v[0];
+  v[2] += v[0] * v[1];
+  v[3] += v[1] * v[2];
+
+  for(int i = 0; i < 4; ++i)
+  {
+    v[i] ^= v[i] >> 16u;
+  }
+
+  v[0] += v[1] * v[3];
+  v[1] += v[2] * v[0];
+  v[2] += v[0] * v[1];
+  v[3] += v[1] * v[2];
+}
+
+
+} // end detail
+
+
+// Philox4x32-10 from Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", 2011
+// this is a bijection of the 128b counter (n, stream) keyed by the 64b seed
+// it passes BigCrush and is the default function of counter_based_generator
+struct philox4x32_10
+{
+  static std::uint64_t bits(std::uint64_t seed, std::uint64_t stream, std::uint64_t n)
+  {
+    std::uint32_t ctr[4] = {
+      static_cast<std::uint32_t>(n),
+      static_cast<std::uint32_t>(n >> 32),
+      static_cast<std::uint32_t>(stream),
+      static_cast<std::uint32_t>(stream >> 32)
+    };
+
+    std::uint32_t key[2] = {
+      static_cast<std::uint32_t>(seed),
+      static_cast<std::uint32_t>(seed >> 32)
+    };
+
+    block(ctr, key);
+
+    return (std::uint64_t(ctr[1]) << 32) | ctr[0];
+  }
+
+  // replaces ctr with the 128b output of the function
+  static void block(std::uint32_t ctr[4], std::uint32_t key[2])
+  {
+    for(int round = 0; round < 10; ++round)
+    {
+      if(round > 0)
+      {
+        // bump the key
+        key[0] += 0x9e3779b9u;
+        key[1] += 0xbb67ae85u;
+      }
+
+      std::uint32_t hi0, lo0, hi1, lo1;
+      detail::mulhilo32(0xd2511f53u, ctr[0], hi0, lo0);
+      detail::mulhilo32(0xcd9e8d57u, ctr[2], hi1, lo1);
+
+      std::uint32_t next[4] = {hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0};
+
+      ctr[0] = next[0];
+      ctr[1] = next[1];
+      ctr[2] = next[2];
+      ctr[3] = next[3];
+    }
+  }
+};
+
+
+// a chain of PCG hashes of the seed and stream, and a pcg4d hash of them with n
+// this is several times cheaper than philox4x32_10 and is adequate for sampling,
+// but it is not a bijection and has not been subjected to BigCrush
+//
+// both halves of the result are mixed from all of n's bits, so neither is a function of the other, and a distribution
+// may split one result into two coordinates, as detail::unit_square_from_generator does
+struct pcg_hash_function
+{
+  static std::uint64_t bits(std::uint64_t seed, std::uint64_t stream, std::uint64_t n)
+  {
+    using detail::pcg_hash;
+
+    std::uint32_t h = pcg_hash(static_cast<std::uint32_t>(seed) ^ pcg_hash(static_cast<std::uint32_t>(seed >> 32)));
+    h = pcg_hash(static_cast<std::uint32_t>(stream) ^ pcg_hash(static_cast<std::uint32_t>(stream >> 32) ^ h));
+
+    std::uint32_t v[4] = {
+      static_cast<std::uint32_t>(n),
+      static_cast<std::uint32_t>(n >> 32),
+      h,
+      pcg_hash(h)
+    };
+
+    detail::pcg4d(v);
+
+    // pcg4d's low bits are its weakest, so finish each half with a bijection that mixes them up
+    return (std::uint64_t(pcg_hash(v[1])) << 32) | pcg_hash(v[0]);
+  }
+};
+
+
+// a stateless random number generator whose operator()(stream, n) returns the bits for sample n of stream
+// as a pure function of the seed, stream, and n
+//
+// any thread can produce any sample without shared state, and the result does not depend on
+// how samples are divided among threads:
+//
+//     counter_based_generator<> rng(seed);
+//     auto p = dist(rng(pixel, i));
+//
+// the 64b result is consumed by the distributions' operator()(Integer i) overloads
+template<class Function = philox4x32_10>
+class counter_based_generator
+{
+  public:
+    using result_type = std::uint64_t;
+
+    explicit counter_based_generator(std::uint64_t seed = 0)
+      : seed_(seed)
+    {}
+
+    std::uint64_t seed() const
+    {
+      return seed_;
+    }
+
+    result_type operator()(std::uint64_t stream, std::uint64_t n) const
+    {
+      return Function::bits(seed_, stream, n);
+    }
+
+  private:
+    std::uint64_t seed_;
+};
+
+
+// adapts counter_based_generator to a UniformRandomBitGenerator for the distributions' operator()(Generator&) overloads
+// the kth call of operator()() returns counter_based_generator<Function>(seed)(stream, k)
+// unlike std::mt19937_64, its state is three integers, so engines for each thread or pixel are free to create,
+// and discard() is O(1)
+template<class Function = philox4x32_10>
+class counter_based_engine
+{
+  public:
+    using result_type = std::uint64_t;
+
+    explicit counter_based_engine(std::uint64_t seed = 0, std::uint64_t stream = 0, std::uint64_t counter = 0)
+      : generator_(seed), stream_(stream), counter_(counter)
+    {}
+
+    static constexpr result_type min()
+    {
+      return std::numeric_limits<result_type>::min();
+    }
+
+    static constexpr result_type max()
+    {
+      return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()()
+    {
+      return generator_(stream_, counter_++);
+    }
+
+    void discard(unsigned long long n)
+    {
+      counter_ += n;
+    }
+
+    std::uint64_t stream() const
+    {
+      return stream_;
+    }
+
+    std::uint64_t counter() const
+    {
+      return counter_;
+    }
+
+  private:
+    counter_based_generator<Function> generator_;
+    std::uint64_t stream_;
+    std::uint64_t counter_;
+};
+
+
+} // end dist2d
+
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// bin i of an alias table of n bins is chosen by the fraction [i/n, (i+1)/n) of [0,1)
+// the bin selects i itself with probability `probability` and `alias` otherwise
+// pmf is the probability that the table samples i
+template<class Real>
+struct alias_bin
+{
+  Real probability;
+  Real pmf;
+  std::uint32_t alias;
+};
+
+
+// scratch space for build_alias_table, which may be reused between calls to avoid allocation
+struct alias_table_workspace
+{
+  std::vector<double> scaled_weights;
+  std::vector<std::uint32_t> small, large;
+};
+
+
+// builds the alias table of the n weights with Vose's method and returns the sum of the weights
+// if every weight is 0, the table is uniform and the pmf of every bin is 0
+// see Vose, A Linear Algorithm for Generating Random Numbers with a Given Distribution, 1991
+template<class Real, class Weight>
+double build_alias_table(const Weight* weights, std::size_t n, alias_bin<Real>* bins, alias_table_workspace& workspace)
+{
+  double total = 0;
+  std::uint32_t heaviest = 0;
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    if(!(weights[i] >= 0))
+    {
+      throw std::invalid_argument("alias_table: weights must be nonnegative");
+    }
+
+    total += weights[i];
+    if(weights[i] > weights[heaviest]) heaviest = static_cast<std::uint32_t>(i);
+  }
+
+  if(total == 0)
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      bins[i] = alias_bin<Real>{Real(1), Real(0), static_cast<std::uint32_t>(i)};
+    }
+
+    return total;
+  }
+
+  // scale the weights so that their mean is 1 and partition them into those below & above the mean
+  auto& scaled = workspace.scaled_weights;
+  auto& small = workspace.small;
+  auto& large = workspace.large;
+
+  scaled.resize(n);
+  small.clear();
+  large.clear();
+
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    scaled[i] = weights[i] * (double(n) / total);
+    bins[i].pmf = Real(weights[i] / total);
+
+    (scaled[i] < 1 ? small : large).push_back(static_cast<std::uint32_t>(i));
+  }
+
+  // fill the remainder of each small bin with a large bin
+  while(!small.empty() && !large.empty())
+  {
+    std::uint32_t s = small.back(); small.pop_back();
+    std::uint32_t l = large.back(); large.pop_back();
+
+    bins[s].probability = Real(scaled[s]);
+    bins[s].alias = l;
+
+    scaled[l] -= 1 - scaled[s];
+    (scaled[l] < 1 ? small : large).push_back(l);
+  }
+
+  // whatever remains has probability 1 up to rounding error
+  // XXX a zero weight can only remain due to rounding, so alias it to the heaviest bin instead
+  for(auto* remaining : {&small, &large})
+  {
+    for(std::uint32_t i : *remaining)
+    {
+      bins[i].probability = weights[i] > 0 ? Real(1) : Real(0);
+      bins[i].alias = weights[i] > 0 ? i : heaviest;
+    }
+  }
+
+  return total;
+}
+
+
+// returns the bin of the n bins selected by u in [0,1)
+// remapped receives the fraction of u within the bin's share of [0,1), in [0,1), so that it may be reused
+// as a uniformly distributed number independent of the result
+// Bin is alias_bin, or any record with its probability and alias members, such as one which stores its item alongside
+// XXX this computes in at least double precision, because u * n in float would quantize the fraction,
+//     and with it the probability of light bins, to 2^-24 * n
+template<class Bin, class Real>
+std::uint32_t sample_alias_table(const Bin* bins, std::size_t n, Real u, Real& remapped)
+{
+  using compute_type = typename std::common_type<Real,double>::type;
+
+  const Real one_minus_epsilon = Real(1) - std::numeric_limits<Real>::epsilon() / 2;
+
+  compute_type scaled = compute_type(u) * compute_type(n);
+  std::size_t i = std::min(static_cast<std::size_t>(scaled), n - 1);
+  compute_type fraction = scaled - compute_type(i);
+
+  const Bin& bin = bins[i];
+  compute_type probability = bin.probability;
+
+  if(fraction < probability)
+  {
+    remapped = std::min(Real(fraction / probability), one_minus_epsilon);
+    return static_cast<std::uint32_t>(i);
+  }
+
+  remapped = std::min(Real((fraction - probability) / (1 - probability)), one_minus_epsilon);
+  return bin.alias;
+}
+
+
+// an alias table of a discrete distribution, which is sampled in constant time
+template<class Real>
+class alias_table
+{
+  public:
+    alias_table() = default;
+
+    template<class Weight>
+    alias_table(const Weight* weights, std::size_t n)
+      : bins_(checked_size(n))
+    {
+      alias_table_workspace workspace;
+      total_weight_ = build_alias_table(weights, n, bins_.data(), workspace);
+    }
+
+    std::size_t size() const
+    {
+      return bins_.size();
+    }
+
+    double total_weight() const
+    {
+      return total_weight_;
+    }
+
+    // the probability of sampling i
+    Real pmf(std::size_t i) const
+    {
+      return bins_[i].pmf;
+    }
+
+    std::uint32_t operator()(Real u, Real& remapped) const
+    {
+      return sample_alias_table(bins_.data(), bins_.size(), u, remapped);
+    }
+
+    std::uint32_t operator()(Real u) const
+    {
+      Real ignored;
+      return operator()(u, ignored);
+    }
+
+  private:
+    static std::size_t checked_size(std::size_t n)
+    {
+      if(n == 0 || n > std::numeric_limits<std::uint32_t>::max())
+      {
+        throw std::invalid_argument("alias_table: the number of weights must be in [1, 2^32)");
+      }
+
+      return n;
+    }
+
+    std::vector<alias_bin<Real>> bins_;
+    double total_weight_ = 0;
+};
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// an allocator which honors alignof(T) even when it exceeds operator new's alignment, e.g. for cache line aligned records
+// C++14's std::allocator doesn't, and C++17's aligned operator new isn't available to C++14 consumers
+template<class T>
+class aligned_allocator
+{
+  public:
+    using value_type = T;
+
+    aligned_allocator() = default;
+
+    template<class U>
+    constexpr aligned_allocator(const aligned_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+      // over-allocate, and store the block's address just before the aligned result
+      const std::size_t padding = alignof(T) + sizeof(void*);
+      if(n > (std::numeric_limits<std::size_t>::max() - padding) / sizeof(T))
+      {
+        throw std::bad_alloc();
+      }
+
+      void* block = ::operator new(n * sizeof(T) + padding);
+
+      std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block) + sizeof(void*);
+      address = (address + alignof(T) - 1) / alignof(T) * alignof(T);
+      reinterpret_cast<void**>(address)[-1] = block;
+
+      return reinterpret_cast<T*>(address);
+    }
+
+    void deallocate(T* ptr, std::size_t) noexcept
+    {
+      ::operator delete(reinterpret_cast<void**>(ptr)[-1]);
+    }
+};
+
+
+template<class T, class U>
+constexpr bool operator==(const aligned_allocator<T>&, const aligned_allocator<U>&)
+{
+  return true;
+}
+
+
+template<class T, class U>
+constexpr bool operator!=(const aligned_allocator<T>&, const aligned_allocator<U>&)
+{
+  return false;
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "math_constants.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// polynomial approximations of atan for single precision, used by the distributions' inverse mappings
+//
+// every branch is a select, so loops over these vectorize under -fno-math-errno -fno-trapping-math
+// the reduction and minimax polynomial are cephes' atanf, which is accurate to about 2 ulp
+
+// atan(t) for t in [-1, 1]
+inline float atan_unit(float t)
+{
+  const float quarter_pi = float(math_constants::quarter_pi);
+  const float tan_eighth_pi = 0.414213562373095048802f;
+
+  float a = std::fabs(t);
+
+  // reduce |t| > tan(pi/8) with atan(a) = pi/4 + atan((a - 1) / (a + 1))
+  // the divisions below are unconditional, so that the selects need no branches
+  bool reduce = a > tan_eighth_pi;
+  float reduced = (a - 1.f) / (a + 1.f);
+  float x = reduce ? reduced : a;
+  float offset = reduce ? quarter_pi : 0.f;
+
+  float z = x * x;
+  float result = offset + ((((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * x + x);
+
+  return t < 0.f ? -result : result;
+}
+
+
+inline double atan_unit(double t)
+{
+  return std::atan(t);
+}
+
+
+// atan2(y, x) / (2 pi), measured in turns counterclockwise from the positive x axis, in [0,1)
+inline float atan2_turns(float y, float x)
+{
+  const float half_pi = float(math_constants::half_pi);
+  const float pi = float(math_constants::pi);
+  const float inverse_two_pi = float(math_constants::one_over_two_pi);
+
+  float ax = std::fabs(x);
+  float ay = std::fabs(y);
+
+  float numerator = std::min(ax, ay);
+  float denominator = std::max(ax, ay);
+
+  // the origin has angle 0
+  float angle = atan_unit(numerator / (denominator > 0.f ? denominator : 1.f));
+
+  // unfold the octant
+  angle = ay > ax ? half_pi - angle : angle;
+  angle = x < 0.f ? pi - angle : angle;
+  angle = y < 0.f ? -angle : angle;
+
+  float turns = angle * inverse_two_pi;
+  turns = turns < 0.f ? turns + 1.f : turns;
+
+  // -tiny + 1 rounds to 1
+  return turns < 1.f ? turns : 0.f;
+}
+
+
+inline double atan2_turns(double y, double x)
+{
+  const double inverse_two_pi = math_constants::one_over_two_pi;
+
+  double turns = std::atan2(y, x) * inverse_two_pi;
+  turns = turns < 0 ? turns + 1 : turns;
+
+  return turns < 1 ? turns : 0;
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+constexpr std::uint32_t reverse_bits(std::uint32_t x)
+{
+  x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+  x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+  x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+  x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+
+// a 32b integer hash with good avalanche
+// see https://github.com/skeeto/hash-prospector
+constexpr std::uint32_t hash(std::uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x21f0aaadu;
+  x ^= x >> 15;
+  x *= 0x735a2d97u;
+  x ^= x >> 15;
+  return x;
+}
+
+
+constexpr std::uint32_t hash_combine(std::uint32_t seed, std::uint32_t v)
+{
+  return seed ^ (v + (seed << 6) + (seed >> 2));
+}
+
+
+// if x is 0 the result is 64
+inline int count_leading_zeros(std::uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return x == 0 ? 64 : __builtin_clzll(x);
+#else
+  int result = 0;
+  for(std::uint64_t bit = std::uint64_t(1) << 63; bit != 0 && !(x & bit); bit >>= 1)
+  {
+    ++result;
+  }
+  return result;
+#endif
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "sincos.hpp"
+#include "atan.hpp"
+#include "constexpr_math.hpp"
+#include "math_constants.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// evaluates the concentric mapping of the square to the disk without branches
+//
+// this is Shirley & Chiu's mapping in the form of Dave Cline's simplification:
+//
+//     (a, b) = (2 u1 - 1, 2 u2 - 1)
+//
+//     |a| >  |b|:  r = a, phi = pi/4 * (b/a)
+//     |a| <= |b|:  r = b, phi = pi/2 - pi/4 * (a/b)
+//
+// which is the same point as the four region formulation.
+// the octant is chosen with selects and phi lies in [-pi/4, pi/4],
+// so sin & cos are evaluated with the polynomials of sincos_quarter_pi.
+//
+// simd.hpp's concentric kernels perform the same operations in the same order,
+// so for float, the scalar and vector results are bitwise identical.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+template<class Real>
+constexpr void branchless_concentric_warp(Real u1, Real u2, Real& x, Real& y)
+{
+  DIST2D_FP_CONTRACT_OFF
+
+  Real a = Real(2) * u1 - Real(1);
+  Real b = Real(2) * u2 - Real(1);
+
+  bool horizontal = a * a > b * b;
+
+  Real r   = horizontal ? a : b;
+  Real num = horizontal ? b : a;
+
+  // the origin has r == 0 and num == 0, which maps to (0,0)
+  Real den = (r == Real(0)) ? Real(1) : r;
+
+  Real s = 0, c = 0;
+  sincos_quarter_pi(num / den, s, c);
+
+  x = r * (horizontal ? c : s);
+  y = r * (horizontal ? s : c);
+}
+
+
+// lifts the point (x, y) on the unit disk to the unit hemisphere
+template<class Real>
+constexpr Real lift_to_hemisphere(Real x, Real y)
+{
+  DIST2D_FP_CONTRACT_OFF
+
+  return detail::sqrt(std::max(Real(0), Real(1) - x*x - y*y));
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+
+// the inverse of the concentric mapping, which maps the point (x, y) on the unit disk to (u1, u2) in [0,1]^2
+//
+// the octant of (x, y) determines which of a & b is the signed radius, as in branchless_concentric_warp:
+//
+//     |x| >= |y|:  a = sign(x) r, b = a * 4/pi * atan(y/x)
+//     |x| <  |y|:  b = sign(y) r, a = b * 4/pi * atan(x/y)
+//
+// both concentric mappings are the same map, so this inverts either
+template<class Real>
+inline void concentric_inverse(Real x, Real y, Real& u1, Real& u2)
+{
+  const Real four_over_pi = Real(math_constants::four_over_pi);
+
+  bool horizontal = x * x >= y * y;
+
+  Real num = horizontal ? y : x;
+  Real den = horizontal ? x : y;
+
+  // the origin has r == 0 and den == 0, which maps to (1/2, 1/2)
+  Real r = std::copysign(std::sqrt(x * x + y * y), den);
+  Real t = four_over_pi * atan_unit(num / (den == Real(0) ? Real(1) : den));
+
+  Real a = horizontal ? r : r * t;
+  Real b = horizontal ? r * t : r;
+
+  u1 = Real(0.5) * a + Real(0.5);
+  u2 = Real(0.5) * b + Real(0.5);
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "math_constants.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// DIST2D_HAS_IS_CONSTANT_EVALUATED is 1 when the compiler can tell constant evaluation from evaluation at run time
+#if !defined(DIST2D_HAS_IS_CONSTANT_EVALUATED)
+#  if defined(__clang__)
+#    if __has_builtin(__builtin_is_constant_evaluated)
+#      define DIST2D_HAS_IS_CONSTANT_EVALUATED 1
+#    endif
+#  elif defined(__GNUC__) && __GNUC__ >= 9
+#    define DIST2D_HAS_IS_CONSTANT_EVALUATED 1
+#  elif defined(_MSC_VER) && _MSC_VER >= 1925
+#    define DIST2D_HAS_IS_CONSTANT_EVALUATED 1
+#  endif
+#endif
+
+#if !defined(DIST2D_HAS_IS_CONSTANT_EVALUATED)
+#  define DIST2D_HAS_IS_CONSTANT_EVALUATED 0
+#endif
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// sqrt, sin, and cos which may be evaluated in constant expressions
+//
+// these are accurate to about an ulp of float or double, but they are slow,
+// and are only meant for the few evaluations of a compile-time sample kernel
+// float is evaluated in double and rounded once
+
+
+template<class Real>
+using constexpr_compute_type = typename std::common_type<Real,double>::type;
+
+
+template<class Real>
+constexpr Real constexpr_sqrt(Real x)
+{
+  using compute_type = constexpr_compute_type<Real>;
+
+  if(x != x || x < Real(0)) return std::numeric_limits<Real>::quiet_NaN();
+  if(x == Real(0) || x == std::numeric_limits<Real>::infinity()) return x;
+
+  // scale y = x / scale^2 into [1,4) by powers of two, which is exact
+  const compute_type two_32 = 4294967296.0;
+  const compute_type two_64 = two_32 * two_32;
+
+  compute_type y = x;
+  compute_type scale = 1;
+
+  while(y >= two_64)                   { y /= two_64;            scale *= two_32; }
+  while(y < compute_type(1) / two_64)  { y *= two_64;            scale /= two_32; }
+  while(y >= compute_type(4))          { y *= compute_type(0.25); scale *= compute_type(2); }
+  while(y < compute_type(1))           { y *= compute_type(4);    scale *= compute_type(0.5); }
+
+  // Newton's iteration decreases monotonically from above sqrt(y) until rounding stops it
+  compute_type r = compute_type(0.5) * (compute_type(1) + y);
+  for(int i = 0; i < 16; ++i)
+  {
+    compute_type next = compute_type(0.5) * (r + y / r);
+    if(next >= r) break;
+    r = next;
+  }
+
+  return Real(r * scale);
+}
+
+
+// sin(r + quadrant pi/2) for r in [-pi/4, pi/4], summing the Taylor series until its terms vanish
+template<class Real>
+constexpr Real constexpr_sin_quadrant(Real r, std::int64_t quadrant)
+{
+  bool cosine = quadrant & 1;
+  bool negate = quadrant & 2;
+
+  Real z = r * r;
+  Real term = cosine ? Real(1) : r;
+  Real sum = term;
+
+  for(int n = cosine ? 1 : 2; n < 64; n += 2)
+  {
+    term *= -z / (Real(n) * Real(n + 1));
+    if(sum + term == sum) break;
+    sum += term;
+  }
+
+  return negate ? -sum : sum;
+}
+
+
+// |x| must be less than 2^20 for the reduction to be accurate
+template<class Real>
+constexpr void constexpr_reduce_quarter_turns(Real x, Real& r, std::int64_t& quadrant)
+{
+  // pi/2 in two parts, the first of which has 33 significant bits, so that quadrant * pi_over_2_hi is exact
+  const Real pi_over_2_hi = Real(1.57079632673412561417e+00);
+  const Real pi_over_2_lo = Real(6.07710050650619224932e-11);
+  const Real two_over_pi  = Real(math_constants::two_over_pi);
+
+  Real q = x * two_over_pi;
+  quadrant = static_cast<std::int64_t>(q < Real(0) ? q - Real(0.5) : q + Real(0.5));
+
+  r = (x - Real(quadrant) * pi_over_2_hi) - Real(quadrant) * pi_over_2_lo;
+}
+
+
+template<class Real>
+constexpr Real constexpr_sin(Real x)
+{
+  using compute_type = constexpr_compute_type<Real>;
+
+  if(x != x || x - x != x - x) return std::numeric_limits<Real>::quiet_NaN();
+
+  compute_type r = 0;
+  std::int64_t quadrant = 0;
+  constexpr_reduce_quarter_turns(compute_type(x), r, quadrant);
+
+  return Real(constexpr_sin_quadrant(r, quadrant));
+}
+
+
+template<class Real>
+constexpr Real constexpr_cos(Real x)
+{
+  using compute_type = constexpr_compute_type<Real>;
+
+  if(x != x || x - x != x - x) return std::numeric_limits<Real>::quiet_NaN();
+
+  compute_type r = 0;
+  std::int64_t quadrant = 0;
+  constexpr_reduce_quarter_turns(compute_type(x), r, quadrant);
+
+  // cos(x) = sin(x + pi/2)
+  return Real(constexpr_sin_quadrant(r, quadrant + 1));
+}
+
+
+// these evaluate the constexpr_ functions during constant evaluation, and std:: functions at run time,
+// so the distributions' operator()s lose no speed or accuracy to being constexpr
+// a result computed at compile time may differ from the same result computed at run time in its last bit
+//
+// without DIST2D_HAS_IS_CONSTANT_EVALUATED, these always call the std:: functions, which only some compilers,
+// e.g. gcc, evaluate in constant expressions
+template<class Real>
+constexpr Real sqrt(Real x)
+{
+#if DIST2D_HAS_IS_CONSTANT_EVALUATED
+  return __builtin_is_constant_evaluated() ? constexpr_sqrt(x) : std::sqrt(x);
+#else
+  return std::sqrt(x);
+#endif
+}
+
+
+template<class Real>
+constexpr Real sin(Real x)
+{
+#if DIST2D_HAS_IS_CONSTANT_EVALUATED
+  return __builtin_is_constant_evaluated() ? constexpr_sin(x) : std::sin(x);
+#else
+  return std::sin(x);
+#endif
+}
+
+
+template<class Real>
+constexpr Real cos(Real x)
+{
+#if DIST2D_HAS_IS_CONSTANT_EVALUATED
+  return __builtin_is_constant_evaluated() ? constexpr_cos(x) : std::cos(x);
+#else
+  return std::cos(x);
+#endif
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// the I-th coordinate of the point p
+// get<I> is found by argument dependent lookup as well as in std, so a Point type may provide its own,
+// as the packed points of packed_point.hpp do
+template<std::size_t I, class Point>
+constexpr typename std::tuple_element<I,Point>::type coordinate(const Point& p)
+{
+  using std::get;
+  return get<I>(p);
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+inline std::uint32_t float_bits(float x)
+{
+  std::uint32_t result;
+  std::memcpy(&result, &x, sizeof(float));
+  return result;
+}
+
+
+inline float bits_to_float(std::uint32_t x)
+{
+  float result;
+  std::memcpy(&result, &x, sizeof(float));
+  return result;
+}
+
+
+// converts x to IEEE 754 binary16, rounding to nearest even
+inline std::uint16_t float_to_half(float x)
+{
+  std::uint32_t f = float_bits(x);
+  std::uint32_t sign = (f >> 16) & 0x8000u;
+  std::uint32_t magnitude = f & 0x7fffffffu;
+
+  // NaN
+  if(magnitude > 0x7f800000u) return static_cast<std::uint16_t>(sign | 0x7e00u);
+
+  // overflows to infinity, 65520 is the smallest float which rounds to infinity
+  if(magnitude >= 0x477ff000u) return static_cast<std::uint16_t>(sign | 0x7c00u);
+
+  // normal half
+  if(magnitude >= 0x38800000u)
+  {
+    // rebias the exponent and round the 13 discarded bits to nearest even
+    std::uint32_t h = (magnitude - 0x38000000u) >> 13;
+    std::uint32_t rest = magnitude & 0x1fffu;
+    h += (rest > 0x1000u) || (rest == 0x1000u && (h & 1u));
+    return static_cast<std::uint16_t>(sign | h);
+  }
+
+  // subnormal half, or zero
+  // the half subnormals are multiples of 2^-24; adding 0.5 aligns the float's mantissa so its
+  // low bits are the half's bits, and the addition itself rounds to nearest even
+  float aligned = bits_to_float(magnitude) + 0.5f;
+  return static_cast<std::uint16_t>(sign | (float_bits(aligned) - 0x3f000000u));
+}
+
+
+inline float half_to_float(std::uint16_t h)
+{
+  std::uint32_t sign = std::uint32_t(h & 0x8000u) << 16;
+  std::uint32_t exponent = (h >> 10) & 0x1fu;
+  std::uint32_t mantissa = h & 0x3ffu;
+
+  if(exponent == 0x1fu)
+  {
+    // infinity or NaN
+    return bits_to_float(sign | 0x7f800000u | (mantissa << 13));
+  }
+
+  if(exponent == 0)
+  {
+    // zero or subnormal: mantissa * 2^-24
+    float magnitude = float(mantissa) * 5.9604644775390625e-8f;
+    return bits_to_float(sign | float_bits(magnitude));
+  }
+
+  return bits_to_float(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DIST2D_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// a read-only view of a file's contents
+// where mmap is available, the file is mapped and its pages are loaded on demand
+// elsewhere, the file is read into memory
+class mapped_file
+{
+  public:
+    explicit mapped_file(const std::string& path)
+      : data_(nullptr), size_(0)
+    {
+#if defined(DIST2D_HAS_MMAP)
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if(fd < 0) throw std::runtime_error("mapped_file: couldn't open " + path);
+
+      struct stat status;
+      if(::fstat(fd, &status) != 0)
+      {
+        ::close(fd);
+        throw std::runtime_error("mapped_file: couldn't stat " + path);
+      }
+
+      size_ = static_cast<std::size_t>(status.st_size);
+
+      if(size_ > 0)
+      {
+        void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if(ptr == MAP_FAILED)
+        {
+          ::close(fd);
+          throw std::runtime_error("mapped_file: couldn't map " + path);
+        }
+
+        data_ = static_cast<const unsigned char*>(ptr);
+      }
+
+      // the mapping outlives the descriptor
+      ::close(fd);
+#else
+      std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+      if(!file) throw std::runtime_error("mapped_file: couldn't open " + path);
+
+      std::fseek(file.get(), 0, SEEK_END);
+      size_ = static_cast<std::size_t>(std::ftell(file.get()));
+      std::fseek(file.get(), 0, SEEK_SET);
+
+      // allocate with operator new so the contents are suitably aligned
+      unsigned char* buffer = static_cast<unsigned char*>(::operator new(size_));
+      if(std::fread(buffer, 1, size_, file.get()) != size_)
+      {
+        ::operator delete(buffer);
+        throw std::runtime_error("mapped_file: couldn't read " + path);
+      }
+
+      data_ = buffer;
+#endif
+    }
+
+    mapped_file(mapped_file&& other)
+      : data_(other.data_), size_(other.size_)
+    {
+      other.data_ = nullptr;
+      other.size_ = 0;
+    }
+
+    mapped_file& operator=(mapped_file&& other)
+    {
+      std::swap(data_, other.data_);
+      std::swap(size_, other.size_);
+      return *this;
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file()
+    {
+      if(data_)
+      {
+#if defined(DIST2D_HAS_MMAP)
+        ::munmap(const_cast<unsigned char*>(data_), size_);
+#else
+        ::operator delete(const_cast<unsigned char*>(data_));
+#endif
+      }
+    }
+
+    const unsigned char* data() const
+    {
+      return data_;
+    }
+
+    std::size_t size() const
+    {
+      return size_;
+    }
+
+  private:
+    const unsigned char* data_;
+    std::size_t size_;
+};
+
+
+} // end detail
+} // end dist2d
+
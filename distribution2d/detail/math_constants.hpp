@@ -0,0 +1,39 @@
+#pragma once
+
+#include <limits>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// the constants of the distributions and warp stages, to double precision
+// Real(math_constants::pi) is pi correctly rounded to float or double, which a literal like 3.14159265 is only for float
+struct math_constants
+{
+  static constexpr double pi               = 3.14159265358979323846;
+  static constexpr double two_pi           = 6.28318530717958647692;
+  static constexpr double half_pi          = 1.57079632679489661923;
+  static constexpr double quarter_pi       = 0.78539816339744830962;
+  static constexpr double four_over_pi     = 1.27323954473516268615;
+  static constexpr double two_over_pi      = 0.636619772367581343076;
+  static constexpr double one_over_pi      = 0.318309886183790671538;
+  static constexpr double one_over_two_pi  = 0.159154943091895335769;
+  static constexpr double one_over_four_pi = 0.0795774715459476678845;
+};
+
+
+// how far from a surface, such as the unit sphere, contains() accepts a point
+// this is 0.000005 for float, about 42 ulps of 1, and the same number of ulps for other types,
+// so that double points are held to double's rounding rather than float's
+template<class Real>
+constexpr Real surface_tolerance()
+{
+  return Real(0.000005f) * (std::numeric_limits<Real>::epsilon() / Real(std::numeric_limits<float>::epsilon()));
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// projects the nonzero vector (x, y, z) onto the octahedron |x| + |y| + |z| = 1 and unfolds the octahedron
+// onto the square [-1,1]^2, folding the lower hemisphere over the diagonals
+// see Cigolle et al., A Survey of Efficient Representations for Independent Unit Vectors, 2014
+inline void octahedral_encode(float x, float y, float z, float& u, float& v)
+{
+  float inverse_norm = 1.f / (std::fabs(x) + std::fabs(y) + std::fabs(z));
+  float px = x * inverse_norm;
+  float py = y * inverse_norm;
+
+  float folded_x = (1.f - std::fabs(py)) * (px >= 0.f ? 1.f : -1.f);
+  float folded_y = (1.f - std::fabs(px)) * (py >= 0.f ? 1.f : -1.f);
+
+  u = z < 0.f ? folded_x : px;
+  v = z < 0.f ? folded_y : py;
+}
+
+
+// the inverse of octahedral_encode, normalized
+inline void octahedral_decode(float u, float v, float& x, float& y, float& z)
+{
+  z = 1.f - std::fabs(u) - std::fabs(v);
+
+  // unfolds the lower hemisphere without branches
+  float t = std::max(-z, 0.f);
+  x = u + (u >= 0.f ? -t : t);
+  y = v + (v >= 0.f ? -t : t);
+
+  float inverse_length = 1.f / std::sqrt(x*x + y*y + z*z);
+  x *= inverse_length;
+  y *= inverse_length;
+  z *= inverse_length;
+}
+
+
+} // end detail
+} // end dist2d
+
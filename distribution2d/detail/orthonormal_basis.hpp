@@ -0,0 +1,70 @@
+#pragma once
+
+#include "sincos.hpp"
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// builds the tangents (t1, t2) which complete the unit vector n to a right-handed orthonormal basis,
+// without branches or normalization
+// see Duff et al., Building an Orthonormal Basis, Revisited, JCGT 2017
+//
+// the sign is a select rather than std::copysign, so that -0 is treated as +0, which is the same basis in the limit
+//
+// simd.hpp's to_frame kernels perform the same operations in the same order,
+// so for float, the scalar and vector results are bitwise identical
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+template<class Real>
+constexpr void orthonormal_basis(Real nx, Real ny, Real nz,
+                                 Real& t1x, Real& t1y, Real& t1z,
+                                 Real& t2x, Real& t2y, Real& t2z)
+{
+  DIST2D_FP_CONTRACT_OFF
+
+  Real sign = nz < Real(0) ? Real(-1) : Real(1);
+  Real a = Real(-1) / (sign + nz);
+  Real b = nx * ny * a;
+
+  t1x = Real(1) + sign * nx * nx * a;
+  t1y = sign * b;
+  t1z = -sign * nx;
+
+  t2x = b;
+  t2y = sign + ny * ny * a;
+  t2z = -ny;
+}
+
+
+// rotates (x, y, z) in place from the frame around +z to the frame around the unit vector n,
+// i.e. to x t1 + y t2 + z n
+template<class Real>
+constexpr void to_frame(Real nx, Real ny, Real nz, Real& x, Real& y, Real& z)
+{
+  DIST2D_FP_CONTRACT_OFF
+
+  Real t1x = 0, t1y = 0, t1z = 0;
+  Real t2x = 0, t2y = 0, t2z = 0;
+  orthonormal_basis(nx, ny, nz, t1x, t1y, t1z, t2x, t2y, t2z);
+
+  Real wx = x * t1x + y * t2x + z * nx;
+  Real wy = x * t1y + y * t2y + z * ny;
+  Real wz = x * t1z + y * t2z + z * nz;
+
+  x = wx;
+  y = wy;
+  z = wz;
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+
+} // end detail
+} // end dist2d
+
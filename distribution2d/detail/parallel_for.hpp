@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../execution.hpp"
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// calls f(begin, end) for disjoint ranges [begin, end) covering [0, n) on the calling thread
+template<class Function>
+void parallel_for(const execution::sequenced_policy&, std::size_t n, std::size_t, Function f)
+{
+  if(n > 0) f(std::size_t(0), n);
+}
+
+
+// calls f(begin, end) for disjoint ranges [begin, end) covering [0, n) on several threads
+// threads repeatedly claim the next grain_size elements from a shared counter until none remain,
+// so threads which finish early take over the remaining work
+// if any call to f throws, the remaining ranges are abandoned and the first exception is rethrown
+// if a thread can't be started, the work is shared among those which were, and the calling thread
+template<class Function>
+void parallel_for(const execution::parallel_policy& policy, std::size_t n, std::size_t default_grain_size, Function f)
+{
+  std::size_t grain_size = policy.grain_size() ? policy.grain_size() : std::max<std::size_t>(default_grain_size, 1);
+
+  std::size_t num_threads = policy.num_threads() ? policy.num_threads() : std::thread::hardware_concurrency();
+  num_threads = std::max<std::size_t>(num_threads, 1);
+  num_threads = std::min(num_threads, (n + grain_size - 1) / grain_size);
+
+  if(num_threads <= 1)
+  {
+    parallel_for(execution::seq, n, grain_size, f);
+    return;
+  }
+
+  std::atomic<std::size_t> next(0);
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+
+  auto worker = [&]
+  {
+    try
+    {
+      for(std::size_t begin = next.fetch_add(grain_size); begin < n; begin = next.fetch_add(grain_size))
+      {
+        f(begin, std::min(begin + grain_size, n));
+      }
+    }
+    catch(...)
+    {
+      std::lock_guard<std::mutex> lock(exception_mutex);
+      if(!exception) exception = std::current_exception();
+
+      // abandon the remaining work
+      next = n;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for(std::size_t i = 1; i < num_threads; ++i)
+  {
+    try
+    {
+      threads.emplace_back(worker);
+    }
+    catch(const std::system_error&)
+    {
+      // the calling thread's worker claims whatever the started threads don't
+      break;
+    }
+  }
+
+  worker();
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+
+  if(exception) std::rethrow_exception(exception);
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,943 @@
+#pragma once
+
+#include "sincos.hpp"
+#include "concentric_warp.hpp"
+#include "half.hpp"
+#include "unorm16.hpp"
+#include "octahedral.hpp"
+#include "orthonormal_basis.hpp"
+#include "../warp_stages.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// define DIST2D_NO_SIMD to always use the portable kernels
+#if !defined(DIST2D_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DIST2D_HAS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace dist2d
+{
+namespace detail
+{
+namespace simd
+{
+
+
+// the number of samples the batch generate() functions stage at a time
+constexpr std::size_t chunk_size = 1024;
+
+
+enum class isa
+{
+  scalar,
+  sse2,
+  avx2,
+  avx512
+};
+
+
+inline isa detect_isa()
+{
+#if defined(DIST2D_HAS_X86_SIMD)
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx512f")) return isa::avx512;
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c")) return isa::avx2;
+  if(__builtin_cpu_supports("sse2"))    return isa::sse2;
+#endif
+
+  return isa::scalar;
+}
+
+
+// the widest instruction set supported by this processor
+inline isa selected_isa()
+{
+  static const isa result = detect_isa();
+  return result;
+}
+
+
+// the portable kernels
+// these also handle the tails of the vector kernels
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+namespace scalar
+{
+
+
+inline void sphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  DIST2D_FP_CONTRACT_OFF
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float z = float(1) - float(2) * u1[i];
+    float r = std::sqrt(std::max(float(0), float(1) - z*z));
+
+    float s, c;
+    sincos_turns(u2[i], s, c);
+
+    xs[i] = r * c;
+    ys[i] = r * s;
+    zs[i] = z;
+  }
+}
+
+
+inline void hemisphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  DIST2D_FP_CONTRACT_OFF
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float z = u1[i];
+    float r = std::sqrt(std::max(float(0), float(1) - z*z));
+
+    float s, c;
+    sincos_turns(u2[i], s, c);
+
+    xs[i] = r * c;
+    ys[i] = r * s;
+    zs[i] = z;
+  }
+}
+
+
+inline void disk_warp(const float* u, const float* v, std::size_t n, float* xs, float* ys)
+{
+  DIST2D_FP_CONTRACT_OFF
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float r = std::sqrt(u[i]);
+
+    float s, c;
+    sincos_turns(v[i], s, c);
+
+    xs[i] = r * c;
+    ys[i] = r * s;
+  }
+}
+
+
+
+
+inline void concentric_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    branchless_concentric_warp(u1[i], u2[i], xs[i], ys[i]);
+  }
+}
+
+
+inline void cosine_hemisphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float x, y;
+    branchless_concentric_warp(u1[i], u2[i], x, y);
+
+    xs[i] = x;
+    ys[i] = y;
+    zs[i] = lift_to_hemisphere(x, y);
+  }
+}
+
+
+// the frame kernels rotate each warped point to the frame around its unit normal (nxs[i], nys[i], nzs[i])
+
+inline void hemisphere_warp_to_frame(const float* u1, const float* u2, const float* nxs, const float* nys, const float* nzs, std::size_t n, float* xs, float* ys, float* zs)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float x, y, z;
+    hemisphere_warp(u1 + i, u2 + i, 1, &x, &y, &z);
+    to_frame(nxs[i], nys[i], nzs[i], x, y, z);
+
+    xs[i] = x;
+    ys[i] = y;
+    zs[i] = z;
+  }
+}
+
+
+inline void cosine_hemisphere_warp_to_frame(const float* u1, const float* u2, const float* nxs, const float* nys, const float* nzs, std::size_t n, float* xs, float* ys, float* zs)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float x, y, z;
+    cosine_hemisphere_warp(u1 + i, u2 + i, 1, &x, &y, &z);
+    to_frame(nxs[i], nys[i], nzs[i], x, y, z);
+
+    xs[i] = x;
+    ys[i] = y;
+    zs[i] = z;
+  }
+}
+
+
+// evaluates the pipeline warp of warp_stages.hpp on each of the n points (u1[i], u2[i])
+// zs and pdfs may be null, e.g. when warp's output is two-dimensional
+template<class Warp, class Real>
+inline void warp_pipeline(const Warp& warp, const Real* u1, const Real* u2, std::size_t n, Real* xs, Real* ys, Real* zs, Real* pdfs)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    warp_sample<Real> s{u1[i], u2[i], Real(0), Real(1)};
+    warp(s);
+
+    xs[i] = s.x;
+    ys[i] = s.y;
+    if(zs) zs[i] = s.z;
+    if(pdfs) pdfs[i] = s.pdf;
+  }
+}
+
+
+// the contains kernels store to result[i] whether point i lies in each distribution's support
+// they evaluate the same comparisons as the distributions' scalar contains()
+
+inline void square_contains(const float* xs, const float* ys, std::size_t n, bool* result)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    result[i] = 0.f <= xs[i] && xs[i] < 1.f && 0.f <= ys[i] && ys[i] < 1.f;
+  }
+}
+
+
+// closed selects whether the boundary circle is included
+inline void disk_contains(const float* xs, const float* ys, std::size_t n, bool closed, bool* result)
+{
+  DIST2D_FP_CONTRACT_OFF
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float radius_squared = xs[i] * xs[i] + ys[i] * ys[i];
+    result[i] = 0.f <= radius_squared && (closed ? radius_squared <= 1.f : radius_squared < 1.f);
+  }
+}
+
+
+inline void sphere_contains(const float* xs, const float* ys, const float* zs, std::size_t n, bool* result)
+{
+  DIST2D_FP_CONTRACT_OFF
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float radius_squared = xs[i] * xs[i] + ys[i] * ys[i] + zs[i] * zs[i];
+    result[i] = std::fabs(1.f - radius_squared) < 0.000005f;
+  }
+}
+
+
+inline void hemisphere_contains(const float* xs, const float* ys, const float* zs, std::size_t n, bool* result)
+{
+  DIST2D_FP_CONTRACT_OFF
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float radius_squared = xs[i] * xs[i] + ys[i] * ys[i] + zs[i] * zs[i];
+    result[i] = 0.f <= zs[i] && std::fabs(1.f - radius_squared) < 0.000005f;
+  }
+}
+
+
+inline void triangle_contains(const float* xs, const float* ys, std::size_t n, bool* result)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    result[i] = 0.f < xs[i] && xs[i] <= 1.f && 0.f <= ys[i] && ys[i] <= 1.f - xs[i];
+  }
+}
+
+
+
+// the packing kernels store the 16b codes of the coordinates of each point to out, interleaved,
+// so that out[d * i], ..., out[d * i + d - 1] encode the d coordinates of point i
+// they match detail::float_to_half, encode_unorm16, and octahedral_encode followed by encode_snorm16
+
+inline void pack_half(const float* xs, const float* ys, std::size_t n, std::uint16_t* out)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    out[2 * i + 0] = float_to_half(xs[i]);
+    out[2 * i + 1] = float_to_half(ys[i]);
+  }
+}
+
+
+inline void pack_half(const float* xs, const float* ys, const float* zs, std::size_t n, std::uint16_t* out)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    out[3 * i + 0] = float_to_half(xs[i]);
+    out[3 * i + 1] = float_to_half(ys[i]);
+    out[3 * i + 2] = float_to_half(zs[i]);
+  }
+}
+
+
+inline void pack_unorm16(const float* xs, const float* ys, std::size_t n, float minimum, float maximum, std::uint16_t* out)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    out[2 * i + 0] = encode_unorm16(xs[i], minimum, maximum);
+    out[2 * i + 1] = encode_unorm16(ys[i], minimum, maximum);
+  }
+}
+
+
+inline void pack_octahedral(const float* xs, const float* ys, const float* zs, std::size_t n, std::uint16_t* out)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    float u, v;
+    octahedral_encode(xs[i], ys[i], zs[i], u, v);
+
+    out[2 * i + 0] = static_cast<std::uint16_t>(encode_snorm16(u));
+    out[2 * i + 1] = static_cast<std::uint16_t>(encode_snorm16(v));
+  }
+}
+
+
+// stores density to result[i] where mask[i], and 0 elsewhere
+template<class Real>
+inline void select_density(const bool* mask, std::size_t n, Real density, Real* result)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    result[i] = mask[i] ? density : Real(0);
+  }
+}
+
+
+// stores scale * values[i] to result[i] where mask[i], and 0 elsewhere
+template<class Value, class Real>
+inline void select_scaled_density(const bool* mask, const Value* values, std::size_t n, Real scale, Real* result)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    result[i] = mask[i] ? Real(values[i]) * scale : Real(0);
+  }
+}
+
+
+} // end scalar
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+
+#if defined(DIST2D_HAS_X86_SIMD)
+
+#define DIST2D_PRAGMA(x) _Pragma(#x)
+#if defined(__clang__)
+#define DIST2D_PUSH_TARGET(isa_string) DIST2D_PRAGMA(clang attribute push(__attribute__((target(isa_string))), apply_to = function))
+#define DIST2D_POP_TARGET() DIST2D_PRAGMA(clang attribute pop)
+#else
+#define DIST2D_PUSH_TARGET(isa_string) DIST2D_PRAGMA(GCC push_options) DIST2D_PRAGMA(GCC target(isa_string)) DIST2D_PRAGMA(GCC optimize("fp-contract=off")) DIST2D_PRAGMA(GCC diagnostic push) DIST2D_PRAGMA(GCC diagnostic ignored "-Wmaybe-uninitialized")
+#define DIST2D_POP_TARGET() DIST2D_PRAGMA(GCC diagnostic pop) DIST2D_PRAGMA(GCC pop_options)
+#endif
+
+
+DIST2D_PUSH_TARGET("sse2")
+namespace sse2
+{
+
+
+struct ops
+{
+  using vec = __m128;
+  using ivec = __m128i;
+
+  static constexpr std::size_t width = 4;
+
+  static vec load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, vec a) { _mm_storeu_ps(p, a); }
+  static vec set1(float a) { return _mm_set1_ps(a); }
+
+  static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+  static vec sub(vec a, vec b) { return _mm_sub_ps(a, b); }
+  static vec mul(vec a, vec b) { return _mm_mul_ps(a, b); }
+  static vec max(vec a, vec b) { return _mm_max_ps(a, b); }
+  static vec min(vec a, vec b) { return _mm_min_ps(a, b); }
+  static vec div(vec a, vec b) { return _mm_div_ps(a, b); }
+  static vec sqrt(vec a) { return _mm_sqrt_ps(a); }
+  static vec abs(vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+
+  using mask = __m128;
+  static mask greater(vec a, vec b) { return _mm_cmpgt_ps(a, b); }
+  static mask equal(vec a, vec b) { return _mm_cmpeq_ps(a, b); }
+  static mask less(vec a, vec b) { return _mm_cmplt_ps(a, b); }
+  static mask less_equal(vec a, vec b) { return _mm_cmple_ps(a, b); }
+  static mask logical_and(mask a, mask b) { return _mm_and_ps(a, b); }
+
+  // stores the lanes of m to p as bools
+  static void store_mask(bool* p, mask m)
+  {
+    ivec words = _mm_packs_epi32(_mm_castps_si128(m), _mm_setzero_si128());
+    ivec bytes = _mm_and_si128(_mm_packs_epi16(words, words), _mm_set1_epi8(1));
+
+    int lanes = _mm_cvtsi128_si32(bytes);
+    std::memcpy(p, &lanes, width);
+  }
+
+  // loads the bools p[0], ..., p[width - 1] as a mask
+  static mask load_mask(const bool* p)
+  {
+    int lanes;
+    std::memcpy(&lanes, p, width);
+
+    ivec bytes = _mm_cvtsi32_si128(lanes);
+    ivec words = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+    ivec dwords = _mm_unpacklo_epi16(words, _mm_setzero_si128());
+
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(dwords, _mm_setzero_si128()));
+  }
+  static vec select(mask m, vec a, vec b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+  static ivec truncate(vec a) { return _mm_cvttps_epi32(a); }
+  static ivec increment(ivec a) { return _mm_add_epi32(a, _mm_set1_epi32(1)); }
+  static void store_int(void* p, ivec a) { _mm_storeu_si128(static_cast<__m128i*>(p), a); }
+
+  // returns the low 16b of each lane of lo in the low half of the lane, and those of hi in the high half
+  static ivec interleave16(ivec lo, ivec hi)
+  {
+    return _mm_or_si128(_mm_slli_epi32(hi, 16), _mm_and_si128(lo, _mm_set1_epi32(0xffff)));
+  }
+
+  // converts each lane to binary16, in the low 16b of the lane
+  // sse2 has no conversion instruction, so this evaluates both of detail::float_to_half's paths & selects
+  // see Giesen, float->half variants, 2016
+  static ivec to_half(vec a)
+  {
+    ivec sign = _mm_and_si128(_mm_castps_si128(a), _mm_set1_epi32(int(0x80000000u)));
+    ivec magnitude = _mm_xor_si128(_mm_castps_si128(a), sign);
+
+    // rebias the exponent and round the 13 discarded bits to nearest even
+    ivec odd = _mm_srai_epi32(_mm_slli_epi32(magnitude, 18), 31);
+    ivec normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(magnitude, _mm_set1_epi32(0xfff - 0x38000000)), odd), 13);
+
+    // adding 0.5 aligns the subnormal's bits, as in float_to_half
+    ivec subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(magnitude), _mm_set1_ps(0.5f))), _mm_set1_epi32(0x3f000000));
+
+    ivec is_subnormal = _mm_cmpgt_epi32(_mm_set1_epi32(0x38800000), magnitude);
+    ivec finite = _mm_or_si128(_mm_and_si128(is_subnormal, subnormal), _mm_andnot_si128(is_subnormal, normal));
+
+    // 65520 and above overflow to infinity, NaN becomes 0x7e00
+    ivec is_nan = _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7f800000));
+    ivec special = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(is_nan, _mm_set1_epi32(0x200)));
+    ivec is_finite = _mm_cmpgt_epi32(_mm_set1_epi32(0x477ff000), magnitude);
+
+    ivec result = _mm_or_si128(_mm_and_si128(is_finite, finite), _mm_andnot_si128(is_finite, special));
+    return _mm_or_si128(result, _mm_srli_epi32(sign, 16));
+  }
+
+  // returns a where the lane of q is odd, b otherwise
+  static vec select_odd(ivec q, vec a, vec b)
+  {
+    vec mask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  }
+
+  // flips the sign of a where bit 1 of the lane of q is set
+  static vec negate_if_bit1(vec a, ivec q)
+  {
+    ivec sign = _mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30);
+    return _mm_xor_ps(a, _mm_castsi128_ps(sign));
+  }
+};
+
+
+#include "simd_kernels.inl"
+
+
+} // end sse2
+DIST2D_POP_TARGET()
+
+
+DIST2D_PUSH_TARGET("avx2,f16c")
+namespace avx2
+{
+
+
+struct ops
+{
+  using vec = __m256;
+  using ivec = __m256i;
+
+  static constexpr std::size_t width = 8;
+
+  static vec load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, vec a) { _mm256_storeu_ps(p, a); }
+  static vec set1(float a) { return _mm256_set1_ps(a); }
+
+  static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+  static vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+  static vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+  static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+  static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+  static vec div(vec a, vec b) { return _mm256_div_ps(a, b); }
+  static vec sqrt(vec a) { return _mm256_sqrt_ps(a); }
+  static vec abs(vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+
+  using mask = __m256;
+  static mask greater(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static mask equal(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+  static mask less(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static mask less_equal(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+  static mask logical_and(mask a, mask b) { return _mm256_and_ps(a, b); }
+
+  // stores the lanes of m to p as bools
+  static void store_mask(bool* p, mask m)
+  {
+    __m256i lanes = _mm256_castps_si256(m);
+    __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+    __m128i bytes = _mm_and_si128(_mm_packs_epi16(words, words), _mm_set1_epi8(1));
+
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), bytes);
+  }
+
+  // loads the bools p[0], ..., p[width - 1] as a mask
+  static mask load_mask(const bool* p)
+  {
+    ivec dwords = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    return _mm256_castsi256_ps(_mm256_cmpgt_epi32(dwords, _mm256_setzero_si256()));
+  }
+  static vec select(mask m, vec a, vec b) { return _mm256_blendv_ps(b, a, m); }
+
+  static ivec truncate(vec a) { return _mm256_cvttps_epi32(a); }
+  static ivec increment(ivec a) { return _mm256_add_epi32(a, _mm256_set1_epi32(1)); }
+  static void store_int(void* p, ivec a) { _mm256_storeu_si256(static_cast<__m256i*>(p), a); }
+
+  // returns the low 16b of each lane of lo in the low half of the lane, and those of hi in the high half
+  static ivec interleave16(ivec lo, ivec hi)
+  {
+    return _mm256_or_si256(_mm256_slli_epi32(hi, 16), _mm256_and_si256(lo, _mm256_set1_epi32(0xffff)));
+  }
+
+  // converts each lane to binary16, in the low 16b of the lane
+  static ivec to_half(vec a)
+  {
+    return _mm256_cvtepu16_epi32(_mm256_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT));
+  }
+
+  // returns a where the lane of q is odd, b otherwise
+  static vec select_odd(ivec q, vec a, vec b)
+  {
+    vec mask = _mm256_castsi256_ps(_mm256_slli_epi32(q, 31));
+    return _mm256_blendv_ps(b, a, mask);
+  }
+
+  // flips the sign of a where bit 1 of the lane of q is set
+  static vec negate_if_bit1(vec a, ivec q)
+  {
+    ivec sign = _mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30);
+    return _mm256_xor_ps(a, _mm256_castsi256_ps(sign));
+  }
+};
+
+
+#include "simd_kernels.inl"
+
+
+} // end avx2
+DIST2D_POP_TARGET()
+
+
+DIST2D_PUSH_TARGET("avx512f")
+namespace avx512
+{
+
+
+struct ops
+{
+  using vec = __m512;
+  using ivec = __m512i;
+
+  static constexpr std::size_t width = 16;
+
+  static vec load(const float* p) { return _mm512_loadu_ps(p); }
+  static void store(float* p, vec a) { _mm512_storeu_ps(p, a); }
+  static vec set1(float a) { return _mm512_set1_ps(a); }
+
+  static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+  static vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+  static vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+  static vec max(vec a, vec b) { return _mm512_max_ps(a, b); }
+  static vec min(vec a, vec b) { return _mm512_min_ps(a, b); }
+  static vec div(vec a, vec b) { return _mm512_div_ps(a, b); }
+  static vec sqrt(vec a) { return _mm512_sqrt_ps(a); }
+  static vec abs(vec a) { return _mm512_abs_ps(a); }
+
+  using mask = __mmask16;
+  static mask greater(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+  static mask equal(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+  static mask less(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+  static mask less_equal(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+  static mask logical_and(mask a, mask b) { return mask(a & b); }
+
+  // stores the lanes of m to p as bools
+  static void store_mask(bool* p, mask m)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtepi32_epi8(_mm512_maskz_set1_epi32(m, 1)));
+  }
+
+  // loads the bools p[0], ..., p[width - 1] as a mask
+  static mask load_mask(const bool* p)
+  {
+    ivec dwords = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    return _mm512_test_epi32_mask(dwords, dwords);
+  }
+  static vec select(mask m, vec a, vec b) { return _mm512_mask_blend_ps(m, b, a); }
+
+  static ivec truncate(vec a) { return _mm512_cvttps_epi32(a); }
+  static ivec increment(ivec a) { return _mm512_add_epi32(a, _mm512_set1_epi32(1)); }
+  static void store_int(void* p, ivec a) { _mm512_storeu_si512(p, a); }
+
+  // returns the low 16b of each lane of lo in the low half of the lane, and those of hi in the high half
+  static ivec interleave16(ivec lo, ivec hi)
+  {
+    return _mm512_or_si512(_mm512_slli_epi32(hi, 16), _mm512_and_si512(lo, _mm512_set1_epi32(0xffff)));
+  }
+
+  // converts each lane to binary16, in the low 16b of the lane
+  static ivec to_half(vec a)
+  {
+    return _mm512_cvtepu16_epi32(_mm512_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT));
+  }
+
+  // returns a where the lane of q is odd, b otherwise
+  static vec select_odd(ivec q, vec a, vec b)
+  {
+    __mmask16 odd = _mm512_test_epi32_mask(q, _mm512_set1_epi32(1));
+    return _mm512_mask_blend_ps(odd, b, a);
+  }
+
+  // flips the sign of a where bit 1 of the lane of q is set
+  static vec negate_if_bit1(vec a, ivec q)
+  {
+    ivec sign = _mm512_slli_epi32(_mm512_and_epi32(q, _mm512_set1_epi32(2)), 30);
+    return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a), sign));
+  }
+};
+
+
+#include "simd_kernels.inl"
+
+
+} // end avx512
+DIST2D_POP_TARGET()
+
+
+#undef DIST2D_PRAGMA
+#undef DIST2D_PUSH_TARGET
+#undef DIST2D_POP_TARGET
+
+#endif // DIST2D_HAS_X86_SIMD
+
+
+// the dispatching kernels
+// each of these allows its outputs to alias its inputs elementwise, i.e. xs == u1 and ys == u2
+
+inline void sphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::sphere_warp(u1, u2, n, xs, ys, zs); break;
+    case isa::avx2:   avx2::sphere_warp(u1, u2, n, xs, ys, zs);   break;
+    case isa::sse2:   sse2::sphere_warp(u1, u2, n, xs, ys, zs);   break;
+#endif
+    default:          scalar::sphere_warp(u1, u2, n, xs, ys, zs); break;
+  }
+}
+
+
+inline void hemisphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::hemisphere_warp(u1, u2, n, xs, ys, zs); break;
+    case isa::avx2:   avx2::hemisphere_warp(u1, u2, n, xs, ys, zs);   break;
+    case isa::sse2:   sse2::hemisphere_warp(u1, u2, n, xs, ys, zs);   break;
+#endif
+    default:          scalar::hemisphere_warp(u1, u2, n, xs, ys, zs); break;
+  }
+}
+
+
+inline void disk_warp(const float* u, const float* v, std::size_t n, float* xs, float* ys)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::disk_warp(u, v, n, xs, ys); break;
+    case isa::avx2:   avx2::disk_warp(u, v, n, xs, ys);   break;
+    case isa::sse2:   sse2::disk_warp(u, v, n, xs, ys);   break;
+#endif
+    default:          scalar::disk_warp(u, v, n, xs, ys); break;
+  }
+}
+
+
+inline void concentric_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::concentric_warp(u1, u2, n, xs, ys); break;
+    case isa::avx2:   avx2::concentric_warp(u1, u2, n, xs, ys);   break;
+    case isa::sse2:   sse2::concentric_warp(u1, u2, n, xs, ys);   break;
+#endif
+    default:          scalar::concentric_warp(u1, u2, n, xs, ys); break;
+  }
+}
+
+
+inline void cosine_hemisphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::cosine_hemisphere_warp(u1, u2, n, xs, ys, zs); break;
+    case isa::avx2:   avx2::cosine_hemisphere_warp(u1, u2, n, xs, ys, zs);   break;
+    case isa::sse2:   sse2::cosine_hemisphere_warp(u1, u2, n, xs, ys, zs);   break;
+#endif
+    default:          scalar::cosine_hemisphere_warp(u1, u2, n, xs, ys, zs); break;
+  }
+}
+
+
+// evaluates a pipeline of the stages of warp_stages.hpp, for which detail::is_vector_warp<Warp> is true
+template<class Warp>
+inline void warp_pipeline(const Warp& warp, const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs, float* pdfs)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::warp_pipeline(warp, u1, u2, n, xs, ys, zs, pdfs); break;
+    case isa::avx2:   avx2::warp_pipeline(warp, u1, u2, n, xs, ys, zs, pdfs);   break;
+    case isa::sse2:   sse2::warp_pipeline(warp, u1, u2, n, xs, ys, zs, pdfs);   break;
+#endif
+    default:          scalar::warp_pipeline(warp, u1, u2, n, xs, ys, zs, pdfs); break;
+  }
+}
+
+
+inline void hemisphere_warp_to_frame(const float* u1, const float* u2, const float* nxs, const float* nys, const float* nzs, std::size_t n, float* xs, float* ys, float* zs)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::hemisphere_warp_to_frame(u1, u2, nxs, nys, nzs, n, xs, ys, zs); break;
+    case isa::avx2:   avx2::hemisphere_warp_to_frame(u1, u2, nxs, nys, nzs, n, xs, ys, zs);   break;
+    case isa::sse2:   sse2::hemisphere_warp_to_frame(u1, u2, nxs, nys, nzs, n, xs, ys, zs);   break;
+#endif
+    default:          scalar::hemisphere_warp_to_frame(u1, u2, nxs, nys, nzs, n, xs, ys, zs); break;
+  }
+}
+
+
+inline void cosine_hemisphere_warp_to_frame(const float* u1, const float* u2, const float* nxs, const float* nys, const float* nzs, std::size_t n, float* xs, float* ys, float* zs)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::cosine_hemisphere_warp_to_frame(u1, u2, nxs, nys, nzs, n, xs, ys, zs); break;
+    case isa::avx2:   avx2::cosine_hemisphere_warp_to_frame(u1, u2, nxs, nys, nzs, n, xs, ys, zs);   break;
+    case isa::sse2:   sse2::cosine_hemisphere_warp_to_frame(u1, u2, nxs, nys, nzs, n, xs, ys, zs);   break;
+#endif
+    default:          scalar::cosine_hemisphere_warp_to_frame(u1, u2, nxs, nys, nzs, n, xs, ys, zs); break;
+  }
+}
+
+
+// the dispatching contains kernels
+// each stores to result[i] whether point i lies in the support of the corresponding distribution
+
+
+inline void square_contains(const float* xs, const float* ys, std::size_t n, bool* result)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::square_contains(xs, ys, n, result); break;
+    case isa::avx2:   avx2::square_contains(xs, ys, n, result);   break;
+    case isa::sse2:   sse2::square_contains(xs, ys, n, result);   break;
+#endif
+    default:          scalar::square_contains(xs, ys, n, result); break;
+  }
+}
+
+
+inline void disk_contains(const float* xs, const float* ys, std::size_t n, bool closed, bool* result)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::disk_contains(xs, ys, n, closed, result); break;
+    case isa::avx2:   avx2::disk_contains(xs, ys, n, closed, result);   break;
+    case isa::sse2:   sse2::disk_contains(xs, ys, n, closed, result);   break;
+#endif
+    default:          scalar::disk_contains(xs, ys, n, closed, result); break;
+  }
+}
+
+
+inline void sphere_contains(const float* xs, const float* ys, const float* zs, std::size_t n, bool* result)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::sphere_contains(xs, ys, zs, n, result); break;
+    case isa::avx2:   avx2::sphere_contains(xs, ys, zs, n, result);   break;
+    case isa::sse2:   sse2::sphere_contains(xs, ys, zs, n, result);   break;
+#endif
+    default:          scalar::sphere_contains(xs, ys, zs, n, result); break;
+  }
+}
+
+
+inline void hemisphere_contains(const float* xs, const float* ys, const float* zs, std::size_t n, bool* result)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::hemisphere_contains(xs, ys, zs, n, result); break;
+    case isa::avx2:   avx2::hemisphere_contains(xs, ys, zs, n, result);   break;
+    case isa::sse2:   sse2::hemisphere_contains(xs, ys, zs, n, result);   break;
+#endif
+    default:          scalar::hemisphere_contains(xs, ys, zs, n, result); break;
+  }
+}
+
+
+inline void triangle_contains(const float* xs, const float* ys, std::size_t n, bool* result)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::triangle_contains(xs, ys, n, result); break;
+    case isa::avx2:   avx2::triangle_contains(xs, ys, n, result);   break;
+    case isa::sse2:   sse2::triangle_contains(xs, ys, n, result);   break;
+#endif
+    default:          scalar::triangle_contains(xs, ys, n, result); break;
+  }
+}
+
+
+
+// stores density to result[i] where mask[i], and 0 elsewhere
+// the batch probability_density() functions use this to zero the density outside of the distribution
+inline void select_density(const bool* mask, std::size_t n, float density, float* result)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::select_density(mask, n, density, result); break;
+    case isa::avx2:   avx2::select_density(mask, n, density, result);   break;
+    case isa::sse2:   sse2::select_density(mask, n, density, result);   break;
+#endif
+    default:          scalar::select_density(mask, n, density, result); break;
+  }
+}
+
+
+// the portable version for other types of density
+template<class Real>
+inline void select_density(const bool* mask, std::size_t n, Real density, Real* result)
+{
+  scalar::select_density(mask, n, density, result);
+}
+
+
+inline void select_scaled_density(const bool* mask, const float* values, std::size_t n, float scale, float* result)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::select_scaled_density(mask, values, n, scale, result); break;
+    case isa::avx2:   avx2::select_scaled_density(mask, values, n, scale, result);   break;
+    case isa::sse2:   sse2::select_scaled_density(mask, values, n, scale, result);   break;
+#endif
+    default:          scalar::select_scaled_density(mask, values, n, scale, result); break;
+  }
+}
+
+
+template<class Value, class Real>
+inline void select_scaled_density(const bool* mask, const Value* values, std::size_t n, Real scale, Real* result)
+{
+  scalar::select_scaled_density(mask, values, n, scale, result);
+}
+
+
+// the dispatching packing kernels
+// out[d * i], ..., out[d * i + d - 1] receive the 16b codes of the d coordinates of point i
+
+
+inline void pack_half(const float* xs, const float* ys, std::size_t n, std::uint16_t* out)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::pack_half(xs, ys, n, out); break;
+    case isa::avx2:   avx2::pack_half(xs, ys, n, out);   break;
+    case isa::sse2:   sse2::pack_half(xs, ys, n, out);   break;
+#endif
+    default:          scalar::pack_half(xs, ys, n, out); break;
+  }
+}
+
+
+inline void pack_half(const float* xs, const float* ys, const float* zs, std::size_t n, std::uint16_t* out)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::pack_half(xs, ys, zs, n, out); break;
+    case isa::avx2:   avx2::pack_half(xs, ys, zs, n, out);   break;
+    case isa::sse2:   sse2::pack_half(xs, ys, zs, n, out);   break;
+#endif
+    default:          scalar::pack_half(xs, ys, zs, n, out); break;
+  }
+}
+
+
+inline void pack_unorm16(const float* xs, const float* ys, std::size_t n, float minimum, float maximum, std::uint16_t* out)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::pack_unorm16(xs, ys, n, minimum, maximum, out); break;
+    case isa::avx2:   avx2::pack_unorm16(xs, ys, n, minimum, maximum, out);   break;
+    case isa::sse2:   sse2::pack_unorm16(xs, ys, n, minimum, maximum, out);   break;
+#endif
+    default:          scalar::pack_unorm16(xs, ys, n, minimum, maximum, out); break;
+  }
+}
+
+
+inline void pack_octahedral(const float* xs, const float* ys, const float* zs, std::size_t n, std::uint16_t* out)
+{
+  switch(selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case isa::avx512: avx512::pack_octahedral(xs, ys, zs, n, out); break;
+    case isa::avx2:   avx2::pack_octahedral(xs, ys, zs, n, out);   break;
+    case isa::sse2:   sse2::pack_octahedral(xs, ys, zs, n, out);   break;
+#endif
+    default:          scalar::pack_octahedral(xs, ys, zs, n, out); break;
+  }
+}
+
+
+} // end simd
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,687 @@
+// this file is included once per instruction set by simd.hpp
+// it expects a struct named ops describing a vector of floats in the enclosing namespace
+//
+// there is deliberately no include guard
+
+
+inline void sincos_turns(ops::vec t, ops::vec& s, ops::vec& c)
+{
+  using k = sincos_turns_constants;
+  using vec = ops::vec;
+  using ivec = ops::ivec;
+
+  // these are the operations of detail::sincos_turns, in the same order
+
+  // reduce to [-1/8, 1/8] turns
+  vec magic = ops::set1(k::round_magic);
+  vec q = ops::sub(ops::add(ops::mul(ops::set1(4.f), t), magic), magic);
+  ivec quadrant = ops::truncate(q);
+  vec x = ops::mul(ops::sub(t, ops::mul(q, ops::set1(0.25f))), ops::set1(k::two_pi));
+  vec z = ops::mul(x, x);
+
+  // sin(x) on [-pi/4, pi/4]
+  vec ps = ops::set1(k::sin_c2);
+  ps = ops::add(ops::mul(ps, z), ops::set1(k::sin_c1));
+  ps = ops::add(ops::mul(ps, z), ops::set1(k::sin_c0));
+  ps = ops::add(ops::mul(ops::mul(ps, z), x), x);
+
+  // cos(x) on [-pi/4, pi/4]
+  vec pc = ops::set1(k::cos_c2);
+  pc = ops::add(ops::mul(pc, z), ops::set1(k::cos_c1));
+  pc = ops::add(ops::mul(pc, z), ops::set1(k::cos_c0));
+  pc = ops::add(ops::sub(ops::mul(ops::mul(pc, z), z), ops::mul(ops::set1(0.5f), z)), ops::set1(1.f));
+
+  // odd quadrants exchange sin and cos
+  s = ops::select_odd(quadrant, pc, ps);
+  c = ops::select_odd(quadrant, ps, pc);
+
+  // quadrants 2 & 3 negate sin, quadrants 1 & 2 negate cos
+  s = ops::negate_if_bit1(s, quadrant);
+  c = ops::negate_if_bit1(c, ops::increment(quadrant));
+}
+
+
+inline void sincos_quarter_pi(ops::vec t, ops::vec& s, ops::vec& c)
+{
+  using k = sincos_turns_constants;
+  using vec = ops::vec;
+
+  // these are the operations of detail::sincos_quarter_pi, in the same order
+
+  vec x = ops::mul(t, ops::set1(float(sincos_quarter_pi_constants::quarter_pi)));
+  vec z = ops::mul(x, x);
+
+  vec ps = ops::set1(k::sin_c2);
+  ps = ops::add(ops::mul(ps, z), ops::set1(k::sin_c1));
+  ps = ops::add(ops::mul(ps, z), ops::set1(k::sin_c0));
+  s = ops::add(ops::mul(ops::mul(ps, z), x), x);
+
+  vec pc = ops::set1(k::cos_c2);
+  pc = ops::add(ops::mul(pc, z), ops::set1(k::cos_c1));
+  pc = ops::add(ops::mul(pc, z), ops::set1(k::cos_c0));
+  c = ops::add(ops::sub(ops::mul(ops::mul(pc, z), z), ops::mul(ops::set1(0.5f), z)), ops::set1(1.f));
+}
+
+
+inline void concentric_warp(ops::vec u1, ops::vec u2, ops::vec& x, ops::vec& y)
+{
+  using vec = ops::vec;
+  using mask = ops::mask;
+
+  // these are the operations of detail::branchless_concentric_warp, in the same order
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+  const vec two = ops::set1(2.f);
+
+  vec a = ops::sub(ops::mul(two, u1), one);
+  vec b = ops::sub(ops::mul(two, u2), one);
+
+  mask horizontal = ops::greater(ops::mul(a, a), ops::mul(b, b));
+
+  vec r   = ops::select(horizontal, a, b);
+  vec num = ops::select(horizontal, b, a);
+  vec den = ops::select(ops::equal(r, zero), one, r);
+
+  vec s, c;
+  sincos_quarter_pi(ops::div(num, den), s, c);
+
+  x = ops::mul(r, ops::select(horizontal, c, s));
+  y = ops::mul(r, ops::select(horizontal, s, c));
+}
+
+
+inline void sphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  using vec = ops::vec;
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+  const vec two = ops::set1(2.f);
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec a = ops::load(u1 + i);
+    vec b = ops::load(u2 + i);
+
+    vec z = ops::sub(one, ops::mul(two, a));
+    vec r = ops::sqrt(ops::max(zero, ops::sub(one, ops::mul(z, z))));
+
+    vec s, c;
+    sincos_turns(b, s, c);
+
+    ops::store(xs + i, ops::mul(r, c));
+    ops::store(ys + i, ops::mul(r, s));
+    ops::store(zs + i, z);
+  }
+
+  scalar::sphere_warp(u1 + i, u2 + i, n - i, xs + i, ys + i, zs + i);
+}
+
+
+inline void hemisphere_warp(ops::vec u1, ops::vec u2, ops::vec& x, ops::vec& y, ops::vec& z)
+{
+  using vec = ops::vec;
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+
+  z = u1;
+  vec r = ops::sqrt(ops::max(zero, ops::sub(one, ops::mul(z, z))));
+
+  vec s, c;
+  sincos_turns(u2, s, c);
+
+  x = ops::mul(r, c);
+  y = ops::mul(r, s);
+}
+
+
+inline void hemisphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  using vec = ops::vec;
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x, y, z;
+    hemisphere_warp(ops::load(u1 + i), ops::load(u2 + i), x, y, z);
+
+    ops::store(xs + i, x);
+    ops::store(ys + i, y);
+    ops::store(zs + i, z);
+  }
+
+  scalar::hemisphere_warp(u1 + i, u2 + i, n - i, xs + i, ys + i, zs + i);
+}
+
+
+inline void disk_warp(const float* u, const float* v, std::size_t n, float* xs, float* ys)
+{
+  using vec = ops::vec;
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec r = ops::sqrt(ops::load(u + i));
+    vec b = ops::load(v + i);
+
+    vec s, c;
+    sincos_turns(b, s, c);
+
+    ops::store(xs + i, ops::mul(r, c));
+    ops::store(ys + i, ops::mul(r, s));
+  }
+
+  scalar::disk_warp(u + i, v + i, n - i, xs + i, ys + i);
+}
+
+
+
+inline void concentric_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys)
+{
+  using vec = ops::vec;
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x, y;
+    concentric_warp(ops::load(u1 + i), ops::load(u2 + i), x, y);
+
+    ops::store(xs + i, x);
+    ops::store(ys + i, y);
+  }
+
+  scalar::concentric_warp(u1 + i, u2 + i, n - i, xs + i, ys + i);
+}
+
+
+inline void cosine_hemisphere_warp(ops::vec u1, ops::vec u2, ops::vec& x, ops::vec& y, ops::vec& z)
+{
+  using vec = ops::vec;
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+
+  concentric_warp(u1, u2, x, y);
+
+  z = ops::sqrt(ops::max(zero, ops::sub(ops::sub(one, ops::mul(x, x)), ops::mul(y, y))));
+}
+
+
+inline void cosine_hemisphere_warp(const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs)
+{
+  using vec = ops::vec;
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x, y, z;
+    cosine_hemisphere_warp(ops::load(u1 + i), ops::load(u2 + i), x, y, z);
+
+    ops::store(xs + i, x);
+    ops::store(ys + i, y);
+    ops::store(zs + i, z);
+  }
+
+  scalar::cosine_hemisphere_warp(u1 + i, u2 + i, n - i, xs + i, ys + i, zs + i);
+}
+
+
+inline void to_frame(ops::vec nx, ops::vec ny, ops::vec nz, ops::vec& x, ops::vec& y, ops::vec& z)
+{
+  using vec = ops::vec;
+  using mask = ops::mask;
+
+  // these are the operations of detail::to_frame, in the same order
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+  const vec minus_one = ops::set1(-1.f);
+
+  mask negative = ops::less(nz, zero);
+  vec sign = ops::select(negative, minus_one, one);
+  vec minus_sign = ops::select(negative, one, minus_one);
+
+  vec a = ops::div(minus_one, ops::add(sign, nz));
+  vec b = ops::mul(ops::mul(nx, ny), a);
+
+  vec t1x = ops::add(one, ops::mul(ops::mul(ops::mul(sign, nx), nx), a));
+  vec t1y = ops::mul(sign, b);
+  vec t1z = ops::mul(minus_sign, nx);
+
+  vec t2x = b;
+  vec t2y = ops::add(sign, ops::mul(ops::mul(ny, ny), a));
+  vec t2z = ops::mul(ny, minus_one);
+
+  vec wx = ops::add(ops::add(ops::mul(x, t1x), ops::mul(y, t2x)), ops::mul(z, nx));
+  vec wy = ops::add(ops::add(ops::mul(x, t1y), ops::mul(y, t2y)), ops::mul(z, ny));
+  vec wz = ops::add(ops::add(ops::mul(x, t1z), ops::mul(y, t2z)), ops::mul(z, nz));
+
+  x = wx;
+  y = wy;
+  z = wz;
+}
+
+
+// the frame kernels fuse the hemisphere warps with the rotation to the frame of each point's normal,
+// so each warped point is rotated while it is still in registers
+
+inline void hemisphere_warp_to_frame(const float* u1, const float* u2, const float* nxs, const float* nys, const float* nzs, std::size_t n, float* xs, float* ys, float* zs)
+{
+  using vec = ops::vec;
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x, y, z;
+    hemisphere_warp(ops::load(u1 + i), ops::load(u2 + i), x, y, z);
+    to_frame(ops::load(nxs + i), ops::load(nys + i), ops::load(nzs + i), x, y, z);
+
+    ops::store(xs + i, x);
+    ops::store(ys + i, y);
+    ops::store(zs + i, z);
+  }
+
+  scalar::hemisphere_warp_to_frame(u1 + i, u2 + i, nxs + i, nys + i, nzs + i, n - i, xs + i, ys + i, zs + i);
+}
+
+
+inline void cosine_hemisphere_warp_to_frame(const float* u1, const float* u2, const float* nxs, const float* nys, const float* nzs, std::size_t n, float* xs, float* ys, float* zs)
+{
+  using vec = ops::vec;
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x, y, z;
+    cosine_hemisphere_warp(ops::load(u1 + i), ops::load(u2 + i), x, y, z);
+    to_frame(ops::load(nxs + i), ops::load(nys + i), ops::load(nzs + i), x, y, z);
+
+    ops::store(xs + i, x);
+    ops::store(ys + i, y);
+    ops::store(zs + i, z);
+  }
+
+  scalar::cosine_hemisphere_warp_to_frame(u1 + i, u2 + i, nxs + i, nys + i, nzs + i, n - i, xs + i, ys + i, zs + i);
+}
+
+
+// the vector forms of the stages of warp_stages.hpp, which evaluate the stages' operations in the same order
+
+struct warp_state
+{
+  ops::vec x, y, z, pdf;
+};
+
+
+inline void apply_warp(const unit_square_warp&, warp_state&)
+{
+}
+
+
+inline void apply_warp(const concentric_disk_warp&, warp_state& s)
+{
+  concentric_warp(s.x, s.y, s.x, s.y);
+  s.pdf = ops::mul(s.pdf, ops::set1(float(math_constants::one_over_pi)));
+}
+
+
+inline void apply_warp(const polar_disk_warp&, warp_state& s)
+{
+  using vec = ops::vec;
+
+  vec r = ops::sqrt(s.x);
+
+  vec sine, cosine;
+  sincos_turns(s.y, sine, cosine);
+
+  s.x = ops::mul(r, cosine);
+  s.y = ops::mul(r, sine);
+  s.pdf = ops::mul(s.pdf, ops::set1(float(math_constants::one_over_pi)));
+}
+
+
+inline void apply_warp(const uniform_sphere_warp&, warp_state& s)
+{
+  using vec = ops::vec;
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+
+  vec z = ops::sub(one, ops::mul(ops::set1(2.f), s.x));
+  vec r = ops::sqrt(ops::max(zero, ops::sub(one, ops::mul(z, z))));
+
+  vec sine, cosine;
+  sincos_turns(s.y, sine, cosine);
+
+  s.x = ops::mul(r, cosine);
+  s.y = ops::mul(r, sine);
+  s.z = z;
+  s.pdf = ops::mul(s.pdf, ops::set1(float(math_constants::one_over_four_pi)));
+}
+
+
+inline void apply_warp(const uniform_hemisphere_warp&, warp_state& s)
+{
+  hemisphere_warp(s.x, s.y, s.x, s.y, s.z);
+  s.pdf = ops::mul(s.pdf, ops::set1(float(math_constants::one_over_two_pi)));
+}
+
+
+inline void apply_warp(const lift_to_hemisphere_warp&, warp_state& s)
+{
+  const ops::vec zero = ops::set1(0.f);
+  const ops::vec one = ops::set1(1.f);
+
+  s.z = ops::sqrt(ops::max(zero, ops::sub(ops::sub(one, ops::mul(s.x, s.x)), ops::mul(s.y, s.y))));
+  s.pdf = ops::mul(s.pdf, s.z);
+}
+
+
+inline void apply_warp(const rotate_to_frame_warp<float>& warp, warp_state& s)
+{
+  using vec = ops::vec;
+
+  vec x = s.x, y = s.y, z = s.z;
+
+  s.x = ops::add(ops::add(ops::mul(x, ops::set1(warp.t1x)), ops::mul(y, ops::set1(warp.t2x))), ops::mul(z, ops::set1(warp.nx)));
+  s.y = ops::add(ops::add(ops::mul(x, ops::set1(warp.t1y)), ops::mul(y, ops::set1(warp.t2y))), ops::mul(z, ops::set1(warp.ny)));
+  s.z = ops::add(ops::add(ops::mul(x, ops::set1(warp.t1z)), ops::mul(y, ops::set1(warp.t2z))), ops::mul(z, ops::set1(warp.nz)));
+}
+
+
+template<class First, class Second>
+inline void apply_warp(const composed_warp<First,Second>& warp, warp_state& s)
+{
+  apply_warp(warp.first(), s);
+  apply_warp(warp.second(), s);
+}
+
+
+// the stages of warp are inlined into a single loop, so each point is warped in registers from end to end
+template<class Warp>
+inline void warp_pipeline(const Warp& warp, const float* u1, const float* u2, std::size_t n, float* xs, float* ys, float* zs, float* pdfs)
+{
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    warp_state s{ops::load(u1 + i), ops::load(u2 + i), ops::set1(0.f), ops::set1(1.f)};
+    apply_warp(warp, s);
+
+    ops::store(xs + i, s.x);
+    ops::store(ys + i, s.y);
+    if(zs) ops::store(zs + i, s.z);
+    if(pdfs) ops::store(pdfs + i, s.pdf);
+  }
+
+  scalar::warp_pipeline(warp, u1 + i, u2 + i, n - i, xs + i, ys + i, zs ? zs + i : nullptr, pdfs ? pdfs + i : nullptr);
+}
+
+
+// the contains kernels evaluate the comparisons of the scalar kernels, in the same order
+
+inline void square_contains(const float* xs, const float* ys, std::size_t n, bool* result)
+{
+  using vec = ops::vec;
+  using mask = ops::mask;
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x = ops::load(xs + i);
+    vec y = ops::load(ys + i);
+
+    mask in_x = ops::logical_and(ops::less_equal(zero, x), ops::less(x, one));
+    mask in_y = ops::logical_and(ops::less_equal(zero, y), ops::less(y, one));
+
+    ops::store_mask(result + i, ops::logical_and(in_x, in_y));
+  }
+
+  scalar::square_contains(xs + i, ys + i, n - i, result + i);
+}
+
+
+inline void disk_contains(const float* xs, const float* ys, std::size_t n, bool closed, bool* result)
+{
+  using vec = ops::vec;
+  using mask = ops::mask;
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x = ops::load(xs + i);
+    vec y = ops::load(ys + i);
+
+    vec radius_squared = ops::add(ops::mul(x, x), ops::mul(y, y));
+
+    mask inside = closed ? ops::less_equal(radius_squared, one) : ops::less(radius_squared, one);
+
+    ops::store_mask(result + i, ops::logical_and(ops::less_equal(zero, radius_squared), inside));
+  }
+
+  scalar::disk_contains(xs + i, ys + i, n - i, closed, result + i);
+}
+
+
+inline ops::mask on_unit_sphere(ops::vec x, ops::vec y, ops::vec z)
+{
+  using vec = ops::vec;
+
+  vec radius_squared = ops::add(ops::add(ops::mul(x, x), ops::mul(y, y)), ops::mul(z, z));
+
+  return ops::less(ops::abs(ops::sub(ops::set1(1.f), radius_squared)), ops::set1(0.000005f));
+}
+
+
+inline void sphere_contains(const float* xs, const float* ys, const float* zs, std::size_t n, bool* result)
+{
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    ops::store_mask(result + i, on_unit_sphere(ops::load(xs + i), ops::load(ys + i), ops::load(zs + i)));
+  }
+
+  scalar::sphere_contains(xs + i, ys + i, zs + i, n - i, result + i);
+}
+
+
+inline void hemisphere_contains(const float* xs, const float* ys, const float* zs, std::size_t n, bool* result)
+{
+  using vec = ops::vec;
+
+  const vec zero = ops::set1(0.f);
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec z = ops::load(zs + i);
+
+    ops::store_mask(result + i, ops::logical_and(ops::less_equal(zero, z), on_unit_sphere(ops::load(xs + i), ops::load(ys + i), z)));
+  }
+
+  scalar::hemisphere_contains(xs + i, ys + i, zs + i, n - i, result + i);
+}
+
+
+inline void triangle_contains(const float* xs, const float* ys, std::size_t n, bool* result)
+{
+  using vec = ops::vec;
+  using mask = ops::mask;
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x = ops::load(xs + i);
+    vec y = ops::load(ys + i);
+
+    mask in_x = ops::logical_and(ops::less(zero, x), ops::less_equal(x, one));
+    mask in_y = ops::logical_and(ops::less_equal(zero, y), ops::less_equal(y, ops::sub(one, x)));
+
+    ops::store_mask(result + i, ops::logical_and(in_x, in_y));
+  }
+
+  scalar::triangle_contains(xs + i, ys + i, n - i, result + i);
+}
+
+
+inline void select_density(const bool* mask, std::size_t n, float density, float* result)
+{
+  using vec = ops::vec;
+
+  const vec zero = ops::set1(0.f);
+  const vec d = ops::set1(density);
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    ops::store(result + i, ops::select(ops::load_mask(mask + i), d, zero));
+  }
+
+  scalar::select_density(mask + i, n - i, density, result + i);
+}
+
+
+inline void select_scaled_density(const bool* mask, const float* values, std::size_t n, float scale, float* result)
+{
+  using vec = ops::vec;
+
+  const vec zero = ops::set1(0.f);
+  const vec s = ops::set1(scale);
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    ops::store(result + i, ops::select(ops::load_mask(mask + i), ops::mul(ops::load(values + i), s), zero));
+  }
+
+  scalar::select_scaled_density(mask + i, values + i, n - i, scale, result + i);
+}
+
+
+// the packing kernels evaluate the operations of the scalar kernels, in the same order
+// the vector conversions to binary16 round like float_to_half, but may keep a different NaN payload
+
+inline void pack_half(const float* xs, const float* ys, std::size_t n, std::uint16_t* out)
+{
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    ops::store_int(out + 2 * i, ops::interleave16(ops::to_half(ops::load(xs + i)), ops::to_half(ops::load(ys + i))));
+  }
+
+  scalar::pack_half(xs + i, ys + i, n - i, out + 2 * i);
+}
+
+
+inline void pack_half(const float* xs, const float* ys, const float* zs, std::size_t n, std::uint16_t* out)
+{
+  // three coordinates don't interleave into lanes, so this stages the codes and stores each point's 6 bytes
+  // as the low bytes of an 8 byte store, which the next point's store overwrites
+  // so that the last store doesn't overrun out, the scalar kernel packs the last point
+  std::size_t i = 0;
+  for(; i + ops::width < n; i += ops::width)
+  {
+    std::uint32_t hx[ops::width], hy[ops::width], hz[ops::width];
+    ops::store_int(hx, ops::to_half(ops::load(xs + i)));
+    ops::store_int(hy, ops::to_half(ops::load(ys + i)));
+    ops::store_int(hz, ops::to_half(ops::load(zs + i)));
+
+    for(std::size_t k = 0; k < ops::width; ++k)
+    {
+      std::uint64_t word = (hx[k] & 0xffffu) | (hy[k] & 0xffffu) << 16 | std::uint64_t(hz[k] & 0xffffu) << 32;
+      std::memcpy(out + 3 * (i + k), &word, sizeof(word));
+    }
+  }
+
+  scalar::pack_half(xs + i, ys + i, zs + i, n - i, out + 3 * i);
+}
+
+
+inline ops::ivec encode_unorm16(ops::vec x, ops::vec minimum, ops::vec range)
+{
+  ops::vec normalized = ops::div(ops::sub(x, minimum), range);
+  normalized = ops::min(ops::max(normalized, ops::set1(0.f)), ops::set1(1.f));
+
+  return ops::truncate(ops::add(ops::mul(normalized, ops::set1(65535.f)), ops::set1(0.5f)));
+}
+
+
+inline void pack_unorm16(const float* xs, const float* ys, std::size_t n, float minimum, float maximum, std::uint16_t* out)
+{
+  std::size_t i = 0;
+
+  // an empty range encodes every coordinate as 0, which the scalar kernel handles
+  if(maximum - minimum > 0.f)
+  {
+    const ops::vec lower = ops::set1(minimum);
+    const ops::vec range = ops::set1(maximum - minimum);
+
+    for(; i + ops::width <= n; i += ops::width)
+    {
+      ops::ivec qx = encode_unorm16(ops::load(xs + i), lower, range);
+      ops::ivec qy = encode_unorm16(ops::load(ys + i), lower, range);
+
+      ops::store_int(out + 2 * i, ops::interleave16(qx, qy));
+    }
+  }
+
+  scalar::pack_unorm16(xs + i, ys + i, n - i, minimum, maximum, out + 2 * i);
+}
+
+
+inline ops::ivec encode_snorm16(ops::vec x)
+{
+  using vec = ops::vec;
+
+  vec clamped = ops::min(ops::max(x, ops::set1(-1.f)), ops::set1(1.f));
+  vec scaled = ops::mul(clamped, ops::set1(32767.f));
+  vec rounding = ops::select(ops::less(scaled, ops::set1(0.f)), ops::set1(-0.5f), ops::set1(0.5f));
+
+  return ops::truncate(ops::add(scaled, rounding));
+}
+
+
+inline void pack_octahedral(const float* xs, const float* ys, const float* zs, std::size_t n, std::uint16_t* out)
+{
+  using vec = ops::vec;
+  using mask = ops::mask;
+
+  const vec zero = ops::set1(0.f);
+  const vec one = ops::set1(1.f);
+  const vec minus_one = ops::set1(-1.f);
+
+  std::size_t i = 0;
+  for(; i + ops::width <= n; i += ops::width)
+  {
+    vec x = ops::load(xs + i);
+    vec y = ops::load(ys + i);
+    vec z = ops::load(zs + i);
+
+    // these are the operations of detail::octahedral_encode, in the same order
+    vec inverse_norm = ops::div(one, ops::add(ops::add(ops::abs(x), ops::abs(y)), ops::abs(z)));
+    vec px = ops::mul(x, inverse_norm);
+    vec py = ops::mul(y, inverse_norm);
+
+    vec folded_x = ops::mul(ops::sub(one, ops::abs(py)), ops::select(ops::less_equal(zero, px), one, minus_one));
+    vec folded_y = ops::mul(ops::sub(one, ops::abs(px)), ops::select(ops::less_equal(zero, py), one, minus_one));
+
+    mask lower = ops::less(z, zero);
+    vec u = ops::select(lower, folded_x, px);
+    vec v = ops::select(lower, folded_y, py);
+
+    ops::store_int(out + 2 * i, ops::interleave16(encode_snorm16(u), encode_snorm16(v)));
+  }
+
+  scalar::pack_octahedral(xs + i, ys + i, zs + i, n - i, out + 2 * i);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// 16b fixed point between minimum and maximum, rounding to nearest
+// x outside of [minimum, maximum] is clamped
+inline std::uint16_t encode_unorm16(float x, float minimum, float maximum)
+{
+  float range = maximum - minimum;
+  float normalized = range > 0 ? (x - minimum) / range : 0.f;
+  normalized = std::min(std::max(normalized, 0.f), 1.f);
+  return static_cast<std::uint16_t>(normalized * 65535.f + 0.5f);
+}
+
+
+inline float decode_unorm16(std::uint16_t q, float minimum, float maximum)
+{
+  return minimum + (maximum - minimum) * (float(q) * (1.f / 65535.f));
+}
+
+
+// 16b signed fixed point in [-1, 1], rounding to nearest
+// unlike unorm16 in [-1, 1], this represents 0 exactly
+inline std::int16_t encode_snorm16(float x)
+{
+  float clamped = std::min(std::max(x, -1.f), 1.f);
+  float scaled = clamped * 32767.f;
+  return static_cast<std::int16_t>(scaled < 0.f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+
+inline float decode_snorm16(std::int16_t q)
+{
+  return std::max(float(q) * (1.f / 32767.f), -1.f);
+}
+
+
+} // end detail
+} // end dist2d
+
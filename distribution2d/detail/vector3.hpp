@@ -0,0 +1,95 @@
+#pragma once
+
+#include "coordinate.hpp"
+#include <cmath>
+#include <tuple>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// the little 3D vector arithmetic of the solid angle distributions, whose geometry is precomputed in double
+template<class Real>
+struct vector3
+{
+  Real x, y, z;
+};
+
+
+template<class Real>
+constexpr vector3<Real> operator+(const vector3<Real>& a, const vector3<Real>& b)
+{
+  return vector3<Real>{a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+template<class Real>
+constexpr vector3<Real> operator-(const vector3<Real>& a, const vector3<Real>& b)
+{
+  return vector3<Real>{a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+template<class Real>
+constexpr vector3<Real> operator-(const vector3<Real>& a)
+{
+  return vector3<Real>{-a.x, -a.y, -a.z};
+}
+
+template<class Real>
+constexpr vector3<Real> operator*(Real s, const vector3<Real>& a)
+{
+  return vector3<Real>{s * a.x, s * a.y, s * a.z};
+}
+
+
+template<class Real>
+constexpr Real dot(const vector3<Real>& a, const vector3<Real>& b)
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+
+template<class Real>
+constexpr vector3<Real> cross(const vector3<Real>& a, const vector3<Real>& b)
+{
+  return vector3<Real>{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+
+template<class Real>
+Real length(const vector3<Real>& a)
+{
+  return std::sqrt(dot(a, a));
+}
+
+
+// the zero vector normalizes to itself
+template<class Real>
+vector3<Real> normalize(const vector3<Real>& a)
+{
+  Real l = length(a);
+  return l > Real(0) ? (Real(1) / l) * a : a;
+}
+
+
+template<class Real, class Point>
+constexpr vector3<Real> to_vector3(const Point& p)
+{
+  return vector3<Real>{Real(detail::coordinate<0>(p)), Real(detail::coordinate<1>(p)), Real(detail::coordinate<2>(p))};
+}
+
+
+// the solid angle of the spherical triangle with unit vertices a, b, c
+// see Van Oosterom & Strackee, The Solid Angle of a Plane Triangle, IEEE Transactions on Biomedical Engineering 1983
+template<class Real>
+Real spherical_triangle_area(const vector3<Real>& a, const vector3<Real>& b, const vector3<Real>& c)
+{
+  Real triple = dot(a, cross(b, c));
+  return Real(2) * std::atan2(std::fabs(triple), Real(1) + dot(a, b) + dot(b, c) + dot(c, a));
+}
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dist2d
+{
+namespace execution
+{
+
+
+// requests that an algorithm run on the calling thread
+struct sequenced_policy {};
+
+
+// requests that an algorithm divide its work among threads
+// num_threads == 0 uses std::thread::hardware_concurrency() threads
+// grain_size == 0 lets the algorithm choose how many elements each thread claims at a time
+class parallel_policy
+{
+  public:
+    constexpr parallel_policy(std::size_t num_threads = 0, std::size_t grain_size = 0)
+      : num_threads_(num_threads), grain_size_(grain_size)
+    {}
+
+    constexpr std::size_t num_threads() const
+    {
+      return num_threads_;
+    }
+
+    constexpr std::size_t grain_size() const
+    {
+      return grain_size_;
+    }
+
+    constexpr parallel_policy with_num_threads(std::size_t num_threads) const
+    {
+      return parallel_policy(num_threads, grain_size_);
+    }
+
+    constexpr parallel_policy with_grain_size(std::size_t grain_size) const
+    {
+      return parallel_policy(num_threads_, grain_size);
+    }
+
+  private:
+    std::size_t num_threads_;
+    std::size_t grain_size_;
+};
+
+
+constexpr sequenced_policy seq{};
+constexpr parallel_policy par{};
+
+
+} // end execution
+} // end dist2d
+
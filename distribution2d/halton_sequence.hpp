@@ -0,0 +1,68 @@
+#pragma once
+
+#include "detail/bits.hpp"
+#include <cstdint>
+#include <utility>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// the radical inverse of n in base 3, as a 32b fixed point fraction
+constexpr std::uint32_t radical_inverse_base3(std::uint32_t n)
+{
+  // 3^20 < 2^32 < 3^21, so n has at most 21 digits
+  // reverse the digits five at a time, 3^5 = 243
+  std::uint64_t reversed = 0;
+  std::uint64_t base_power = 1;
+
+  while(n)
+  {
+    std::uint32_t next = n / 243;
+    std::uint32_t digits = n - next * 243;
+
+    // reverse the five digits of this group
+    std::uint32_t reversed_digits = 0;
+    for(int i = 0; i < 5; ++i)
+    {
+      reversed_digits = 3 * reversed_digits + digits % 3;
+      digits /= 3;
+    }
+
+    reversed = 243 * reversed + reversed_digits;
+    base_power *= 243;
+    n = next;
+  }
+
+  // reversed / base_power is in [0,1), scale it to 32b
+  // base_power <= 3^25 < 2^40, so the quotient is exact to within an ulp of double
+  double fraction = double(reversed) / double(base_power);
+  return static_cast<std::uint32_t>(fraction * 4294967296.0);
+}
+
+
+} // end detail
+
+
+// the two dimensional Halton sequence, whose dimensions are the radical inverses of the index in bases 2 and 3
+// operator()(n) returns the nth point as a pair of integers which the (urn1, urn2) overloads
+// of the distributions map to the point's coordinates in [0,1)^2
+class halton_sequence
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    constexpr result_type operator()(std::uint32_t n) const
+    {
+      return result_type{
+        detail::reverse_bits(n),
+        detail::radical_inverse_base3(n)
+      };
+    }
+};
+
+
+} // end dist2d
+
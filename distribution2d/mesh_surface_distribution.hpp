@@ -0,0 +1,358 @@
+#pragma once
+
+#include "unit_square_distribution.hpp"
+#include "unit_isoceles_right_triangle_distribution.hpp"
+#include "execution.hpp"
+#include "detail/alias_table.hpp"
+#include "detail/aligned_allocator.hpp"
+#include "detail/parallel_for.hpp"
+#include "detail/simd.hpp"
+#include "detail/vector3.hpp"
+#include "detail/math_constants.hpp"
+#include "detail/coordinate.hpp"
+#include <tuple>
+#include <utility>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// a triangle of mesh_surface_distribution: its bin of the alias table over the triangles, and its first vertex & edges
+// they're stored together, so a sample whose bin doesn't alias another triangle touches a single record
+// records are aligned to cache lines, so a record of floats, 44 bytes, fills one line rather than straddling two,
+// and a record of doubles, 88 bytes, fills two
+template<class Real>
+struct alignas(64) mesh_triangle
+{
+  Real probability;
+  std::uint32_t alias;
+  Real v0[3];
+  Real e1[3];
+  Real e2[3];
+};
+
+static_assert(sizeof(mesh_triangle<float>) == 64, "mesh_triangle<float> must fill one cache line");
+static_assert(sizeof(mesh_triangle<double>) == 128, "mesh_triangle<double> must fill two cache lines");
+
+
+} // end detail
+
+
+// a uniform distribution of points on the surface of a triangle mesh
+//
+// positions holds the vertices' interleaved coordinates (x, y, z), and indices holds three vertex indices per triangle
+// the constructor builds an alias table over the triangles weighted by their areas, so operator() chooses a triangle in
+// constant time with u1, and places the point within it with the remainder of u1 and u2 by
+// unit_isoceles_right_triangle_distribution's warp
+// XXX the alias method doesn't preserve the stratification of its input points
+//
+// the remainder of u1 resolves only 2^-b * triangle_count(), where b is the bits of u1, so the triangle is chosen and
+// warped in at least double precision: u1 & u2 are used as given, the urns and generators supply 32 and 53 bits
+template<class Point = std::tuple<float,float,float>>
+class mesh_surface_distribution
+{
+  public:
+    using result_type = Point;
+
+  private:
+    using real_type1 = typename std::tuple_element<0,result_type>::type;
+    using real_type2 = typename std::tuple_element<1,result_type>::type;
+    using real_type3 = typename std::tuple_element<2,result_type>::type;
+
+  public:
+    using real_type = typename std::common_type<real_type1, real_type2, real_type3>::type;
+
+  private:
+    using compute_type = typename std::common_type<real_type, double>::type;
+    using vector = detail::vector3<compute_type>;
+
+  public:
+    // builds the distribution's table, dividing the triangles among threads as requested by policy
+    template<class Vertex, class Index, class ExecutionPolicy>
+    mesh_surface_distribution(const ExecutionPolicy& policy,
+                              const Vertex* positions, std::size_t vertex_count,
+                              const Index* indices, std::size_t triangle_count)
+      : triangles_(checked_size(triangle_count)),
+        area_(0)
+    {
+      std::vector<double> areas(triangle_count);
+      std::atomic<bool> valid_indices(true);
+
+      detail::parallel_for(policy, triangle_count, 1 << 16, [&](std::size_t begin, std::size_t end)
+      {
+        for(std::size_t t = begin; t < end; ++t)
+        {
+          const Index* triangle = indices + 3 * t;
+
+          if(!(std::size_t(triangle[0]) < vertex_count && std::size_t(triangle[1]) < vertex_count && std::size_t(triangle[2]) < vertex_count))
+          {
+            valid_indices = false;
+            continue;
+          }
+
+          vector v[3];
+          for(int i = 0; i < 3; ++i)
+          {
+            const Vertex* p = positions + 3 * std::size_t(triangle[i]);
+            v[i] = vector{compute_type(p[0]), compute_type(p[1]), compute_type(p[2])};
+          }
+
+          vector e1 = v[1] - v[0];
+          vector e2 = v[2] - v[0];
+          areas[t] = double(detail::length(cross(e1, e2)) / 2);
+
+          detail::mesh_triangle<real_type>& record = triangles_[t];
+          record.v0[0] = real_type(v[0].x); record.v0[1] = real_type(v[0].y); record.v0[2] = real_type(v[0].z);
+          record.e1[0] = real_type(e1.x);   record.e1[1] = real_type(e1.y);   record.e1[2] = real_type(e1.z);
+          record.e2[0] = real_type(e2.x);   record.e2[1] = real_type(e2.y);   record.e2[2] = real_type(e2.z);
+        }
+      });
+
+      if(!valid_indices)
+      {
+        throw std::invalid_argument("mesh_surface_distribution: indices must be less than vertex_count");
+      }
+
+      // XXX build_alias_table is sequential and writes alias_bins, which are then copied into the records
+      std::vector<detail::alias_bin<real_type>> bins(triangle_count);
+      detail::alias_table_workspace workspace;
+      double total_area = detail::build_alias_table(areas.data(), triangle_count, bins.data(), workspace);
+
+      if(total_area == 0)
+      {
+        throw std::invalid_argument("mesh_surface_distribution: some triangle must have positive area");
+      }
+
+      detail::parallel_for(policy, triangle_count, 1 << 16, [&](std::size_t begin, std::size_t end)
+      {
+        for(std::size_t t = begin; t < end; ++t)
+        {
+          triangles_[t].probability = bins[t].probability;
+          triangles_[t].alias = bins[t].alias;
+        }
+      });
+
+      area_ = real_type(total_area);
+    }
+
+    template<class Vertex, class Index>
+    mesh_surface_distribution(const Vertex* positions, std::size_t vertex_count, const Index* indices, std::size_t triangle_count)
+      : mesh_surface_distribution(execution::par, positions, vertex_count, indices, triangle_count)
+    {}
+
+    std::size_t triangle_count() const
+    {
+      return triangles_.size();
+    }
+
+    template<class Float1, class Float2>
+    typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      result_type
+    >::type
+      operator()(Float1 u1, Float2 u2) const
+    {
+      return sample(compute_type(u1), compute_type(u2));
+    }
+
+    template<class Integer1, class Integer2>
+    typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 urn1, Integer2 urn2) const
+    {
+      compute_type u1 = unit_interval_distribution<compute_type>()(urn1);
+      compute_type u2 = unit_interval_distribution<compute_type>()(urn2);
+
+      return sample(u1, u2);
+    }
+
+    // returns operator()(u1, u2) with its density, 1 / area()
+    template<class Float1, class Float2>
+    typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      return std::make_pair(operator()(u1, u2), real_type(1) / area());
+    }
+
+    template<class Integer1, class Integer2>
+    typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      return std::make_pair(operator()(urn1, urn2), real_type(1) / area());
+    }
+
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    result_type operator()(Integer i) const
+    {
+      auto xy = morton_urns(i);
+      return operator()(xy.first, xy.second);
+    }
+
+    template<class Generator,
+             class = typename std::enable_if<
+               detail::is_integral_generator<Generator>::value
+             >::type>
+    result_type operator()(Generator& g) const
+    {
+      auto u = detail::unit_square_from_generator<compute_type,compute_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs, ys, and zs
+    // XXX each point is a dependent lookup into the table, so this isn't vectorized
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          result_type p = operator()(urn1s[k], urn2s[k]);
+
+          xs[i + k] = detail::coordinate<0>(p);
+          ys[i + k] = detail::coordinate<1>(p);
+          zs[i + k] = detail::coordinate<2>(p);
+        }
+      }
+    }
+
+    // true if p lies within detail::surface_tolerance<real_type>() of a triangle of positive area, relative to the triangle's size
+    // XXX this tests every triangle, so it's meant for validation rather than for large meshes
+    bool contains(const result_type& p) const
+    {
+      vector v = detail::to_vector3<compute_type>(p);
+
+      for(const auto& triangle : triangles_)
+      {
+        if(contains(triangle, v)) return true;
+      }
+
+      return false;
+    }
+
+    // stores contains((xs[i], ys[i], zs[i])) to mask[i] for each of the count points
+    void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask) const
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i], zs[i]});
+      }
+    }
+
+    // if !contains(p) the result is undefined
+    real_type probability_density(const result_type&) const
+    {
+      return real_type(1) / area();
+    }
+
+    // stores the density at each of the count points (xs[i], ys[i], zs[i]) to pdfs[i], or 0 where the point is not contained
+    void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* pdfs) const
+    {
+      const real_type density = real_type(1) / area();
+
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, zs + i, mask);
+
+        detail::simd::select_density(mask, n, density, pdfs + i);
+      }
+    }
+
+    // the surface area of the mesh
+    real_type area() const
+    {
+      return area_;
+    }
+
+  private:
+    static std::size_t checked_size(std::size_t triangle_count)
+    {
+      if(triangle_count == 0 || triangle_count > std::numeric_limits<std::uint32_t>::max())
+      {
+        throw std::invalid_argument("mesh_surface_distribution: the number of triangles must be in [1, 2^32)");
+      }
+
+      return triangle_count;
+    }
+
+    static vector to_vector(const real_type* v)
+    {
+      return vector{compute_type(v[0]), compute_type(v[1]), compute_type(v[2])};
+    }
+
+    // chooses a triangle with u1, and the point within it with the remainder of u1 and u2
+    result_type sample(compute_type u1, compute_type u2) const
+    {
+      compute_type u1_in_triangle;
+      const auto& triangle = triangles_[detail::sample_alias_table(triangles_.data(), triangles_.size(), u1, u1_in_triangle)];
+
+      compute_type x = 0, y = 0;
+      unit_isoceles_right_triangle_distribution<std::pair<compute_type,compute_type>>::warp(u1_in_triangle, u2, x, y);
+
+      vector p = to_vector(triangle.v0) + x * to_vector(triangle.e1) + y * to_vector(triangle.e2);
+
+      return result_type{real_type1(p.x), real_type2(p.y), real_type3(p.z)};
+    }
+
+    static bool contains(const detail::mesh_triangle<real_type>& triangle, const vector& p)
+    {
+      const compute_type tolerance = detail::surface_tolerance<real_type>();
+
+      vector e1 = to_vector(triangle.e1);
+      vector e2 = to_vector(triangle.e2);
+      vector n = cross(e1, e2);
+      vector w = p - to_vector(triangle.v0);
+
+      compute_type nn = dot(n, n);
+      if(!(nn > 0)) return false;
+
+      // the barycentric coordinates of p's projection onto the triangle's plane, and p's distance from it
+      compute_type b1 = dot(cross(w, e2), n) / nn;
+      compute_type b2 = dot(cross(e1, w), n) / nn;
+      compute_type distance = std::fabs(dot(w, n)) / std::sqrt(nn);
+      compute_type size = std::sqrt(std::max(dot(e1, e1), dot(e2, e2)));
+
+      return b1 >= -tolerance && b2 >= -tolerance && b1 + b2 <= 1 + tolerance && distance <= tolerance * size;
+    }
+
+    std::vector<detail::mesh_triangle<real_type>, detail::aligned_allocator<detail::mesh_triangle<real_type>>> triangles_;
+    real_type area_;
+};
+
+
+} // end dist2d
+
@@ -0,0 +1,375 @@
+#pragma once
+
+#include "detail/simd.hpp"
+#include "detail/bits.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// this header replaces the library's former submodule https://github.com/jaredhoberock/morton
+// it reimplements that submodule's encode_morton_2d & decode_morton_2d from the standard bit-interleaving techniques,
+// rather than copying its code, so the library builds without network access
+//
+// DIST2D_MORTON_DECODER selects the implementation of dist2d::decode_morton_2d(std::uint64_t):
+// DIST2D_MORTON_DECODER_MAGIC_BITS, DIST2D_MORTON_DECODER_LOOKUP_TABLE, or DIST2D_MORTON_DECODER_PEXT
+//
+// by default, PEXT is used when compiling for a target with BMI2 and the magic bits are used otherwise
+// XXX AMD's Zen 1 & 2 implement PEXT in microcode, so they get the magic bits too
+#define DIST2D_MORTON_DECODER_MAGIC_BITS 1
+#define DIST2D_MORTON_DECODER_LOOKUP_TABLE 2
+#define DIST2D_MORTON_DECODER_PEXT 3
+
+#if !defined(DIST2D_MORTON_DECODER)
+#  if defined(__BMI2__) && !defined(__znver1__) && !defined(__znver2__)
+#    define DIST2D_MORTON_DECODER DIST2D_MORTON_DECODER_PEXT
+#  else
+#    define DIST2D_MORTON_DECODER DIST2D_MORTON_DECODER_MAGIC_BITS
+#  endif
+#endif
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// gathers the even bits of v into the low 32 bits of the result
+inline std::uint32_t compact_even_bits(std::uint64_t v)
+{
+  v &= 0x5555555555555555ull;
+  v = (v | (v >>  1)) & 0x3333333333333333ull;
+  v = (v | (v >>  2)) & 0x0f0f0f0f0f0f0f0full;
+  v = (v | (v >>  4)) & 0x00ff00ff00ff00ffull;
+  v = (v | (v >>  8)) & 0x0000ffff0000ffffull;
+  v = (v | (v >> 16)) & 0x00000000ffffffffull;
+  return static_cast<std::uint32_t>(v);
+}
+
+
+// the inverse of compact_even_bits
+inline std::uint64_t spread_bits(std::uint32_t x)
+{
+  std::uint64_t v = x;
+  v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+  v = (v | (v <<  8)) & 0x00ff00ff00ff00ffull;
+  v = (v | (v <<  4)) & 0x0f0f0f0f0f0f0f0full;
+  v = (v | (v <<  2)) & 0x3333333333333333ull;
+  v = (v | (v <<  1)) & 0x5555555555555555ull;
+  return v;
+}
+
+
+// entry b holds the 4 even bits of b in its low nibble and the 4 odd bits of b in its high nibble
+struct morton_lookup_table
+{
+  std::uint8_t entries[256];
+};
+
+
+constexpr morton_lookup_table make_morton_lookup_table()
+{
+  morton_lookup_table result{};
+
+  for(int b = 0; b < 256; ++b)
+  {
+    int even = 0, odd = 0;
+    for(int bit = 0; bit < 4; ++bit)
+    {
+      even |= ((b >> (2 * bit))     & 1) << bit;
+      odd  |= ((b >> (2 * bit + 1)) & 1) << bit;
+    }
+
+    result.entries[b] = static_cast<std::uint8_t>(even | (odd << 4));
+  }
+
+  return result;
+}
+
+
+} // end detail
+
+
+// each of these decodes a 2D Morton code m into (x, y)
+// the bits of x are the even bits of m and the bits of y are the odd bits of m
+
+inline std::pair<std::uint32_t,std::uint32_t> decode_morton_2d_magic_bits(std::uint64_t m)
+{
+  return std::make_pair(detail::compact_even_bits(m), detail::compact_even_bits(m >> 1));
+}
+
+
+inline std::pair<std::uint32_t,std::uint32_t> decode_morton_2d_lookup_table(std::uint64_t m)
+{
+  static constexpr detail::morton_lookup_table table = detail::make_morton_lookup_table();
+
+  std::uint32_t x = 0, y = 0;
+  for(int byte = 0; byte < 8; ++byte)
+  {
+    std::uint8_t entry = table.entries[(m >> (8 * byte)) & 0xff];
+    x |= std::uint32_t(entry & 0xf) << (4 * byte);
+    y |= std::uint32_t(entry >> 4)  << (4 * byte);
+  }
+
+  return std::make_pair(x, y);
+}
+
+
+#if defined(__BMI2__)
+inline std::pair<std::uint32_t,std::uint32_t> decode_morton_2d_pext(std::uint64_t m)
+{
+  return std::make_pair(static_cast<std::uint32_t>(_pext_u64(m, 0x5555555555555555ull)),
+                        static_cast<std::uint32_t>(_pext_u64(m, 0xaaaaaaaaaaaaaaaaull)));
+}
+#endif
+
+
+// the decoder selected by DIST2D_MORTON_DECODER
+inline std::pair<std::uint32_t,std::uint32_t> decode_morton_2d(std::uint64_t m)
+{
+#if DIST2D_MORTON_DECODER == DIST2D_MORTON_DECODER_PEXT
+  return decode_morton_2d_pext(m);
+#elif DIST2D_MORTON_DECODER == DIST2D_MORTON_DECODER_LOOKUP_TABLE
+  return decode_morton_2d_lookup_table(m);
+#else
+  return decode_morton_2d_magic_bits(m);
+#endif
+}
+
+
+// interleaves the bits of x and y into a 2D Morton code
+// the bits of x occupy the even bits of the result and the bits of y occupy the odd bits
+inline std::uint64_t encode_morton_2d(std::uint32_t x, std::uint32_t y)
+{
+  return detail::spread_bits(x) | (detail::spread_bits(y) << 1);
+}
+
+
+namespace detail
+{
+namespace simd
+{
+namespace scalar
+{
+
+
+inline void decode_morton_2d(const std::uint64_t* codes, std::size_t n, std::uint32_t* xs, std::uint32_t* ys)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    auto xy = dist2d::decode_morton_2d(codes[i]);
+    xs[i] = xy.first;
+    ys[i] = xy.second;
+  }
+}
+
+
+inline void decode_morton_2d_range(std::uint64_t first, std::size_t n, std::uint32_t* xs, std::uint32_t* ys)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    auto xy = dist2d::decode_morton_2d(first + i);
+    xs[i] = xy.first;
+    ys[i] = xy.second;
+  }
+}
+
+
+} // end scalar
+
+
+#if defined(DIST2D_HAS_X86_SIMD)
+// XXX GCC 12 warns spuriously about the AVX-512 intrinsics' undefined pass-through operands
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+namespace avx2
+{
+
+
+// the magic bits on 4 codes at once
+__attribute__((target("avx2")))
+inline __m256i compact_even_bits(__m256i v)
+{
+  v = _mm256_and_si256(v, _mm256_set1_epi64x(0x5555555555555555ll));
+  v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v,  1)), _mm256_set1_epi64x(0x3333333333333333ll));
+  v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v,  2)), _mm256_set1_epi64x(0x0f0f0f0f0f0f0f0fll));
+  v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v,  4)), _mm256_set1_epi64x(0x00ff00ff00ff00ffll));
+  v = _mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi64(v,  8)), _mm256_set1_epi64x(0x0000ffff0000ffffll));
+  v = _mm256_or_si256(v, _mm256_srli_epi64(v, 16));
+
+  // gather the low 32 bits of each code into the low 128 bits
+  return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+}
+
+
+__attribute__((target("avx2")))
+inline void decode_morton_2d(__m256i m, std::uint32_t* xs, std::uint32_t* ys)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(xs), _mm256_castsi256_si128(compact_even_bits(m)));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(ys), _mm256_castsi256_si128(compact_even_bits(_mm256_srli_epi64(m, 1))));
+}
+
+
+__attribute__((target("avx2")))
+inline void decode_morton_2d(const std::uint64_t* codes, std::size_t n, std::uint32_t* xs, std::uint32_t* ys)
+{
+  std::size_t i = 0;
+  for(; i + 4 <= n; i += 4)
+  {
+    decode_morton_2d(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(codes + i)), xs + i, ys + i);
+  }
+
+  scalar::decode_morton_2d(codes + i, n - i, xs + i, ys + i);
+}
+
+
+__attribute__((target("avx2")))
+inline void decode_morton_2d_range(std::uint64_t first, std::size_t n, std::uint32_t* xs, std::uint32_t* ys)
+{
+  __m256i m = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(first)), _mm256_setr_epi64x(0, 1, 2, 3));
+  const __m256i four = _mm256_set1_epi64x(4);
+
+  std::size_t i = 0;
+  for(; i + 4 <= n; i += 4, m = _mm256_add_epi64(m, four))
+  {
+    decode_morton_2d(m, xs + i, ys + i);
+  }
+
+  scalar::decode_morton_2d_range(first + i, n - i, xs + i, ys + i);
+}
+
+
+} // end avx2
+
+
+namespace avx512
+{
+
+
+// the magic bits on 8 codes at once
+__attribute__((target("avx512f")))
+inline __m256i compact_even_bits(__m512i v)
+{
+  v = _mm512_and_si512(v, _mm512_set1_epi64(0x5555555555555555ll));
+  v = _mm512_and_si512(_mm512_or_si512(v, _mm512_srli_epi64(v,  1)), _mm512_set1_epi64(0x3333333333333333ll));
+  v = _mm512_and_si512(_mm512_or_si512(v, _mm512_srli_epi64(v,  2)), _mm512_set1_epi64(0x0f0f0f0f0f0f0f0fll));
+  v = _mm512_and_si512(_mm512_or_si512(v, _mm512_srli_epi64(v,  4)), _mm512_set1_epi64(0x00ff00ff00ff00ffll));
+  v = _mm512_and_si512(_mm512_or_si512(v, _mm512_srli_epi64(v,  8)), _mm512_set1_epi64(0x0000ffff0000ffffll));
+  v = _mm512_or_si512(v, _mm512_srli_epi64(v, 16));
+
+  // truncate each code to its low 32 bits
+  return _mm512_cvtepi64_epi32(v);
+}
+
+
+__attribute__((target("avx512f")))
+inline void decode_morton_2d(__m512i m, std::uint32_t* xs, std::uint32_t* ys)
+{
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(xs), compact_even_bits(m));
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(ys), compact_even_bits(_mm512_srli_epi64(m, 1)));
+}
+
+
+__attribute__((target("avx512f")))
+inline void decode_morton_2d(const std::uint64_t* codes, std::size_t n, std::uint32_t* xs, std::uint32_t* ys)
+{
+  std::size_t i = 0;
+  for(; i + 8 <= n; i += 8)
+  {
+    decode_morton_2d(_mm512_loadu_si512(codes + i), xs + i, ys + i);
+  }
+
+  scalar::decode_morton_2d(codes + i, n - i, xs + i, ys + i);
+}
+
+
+__attribute__((target("avx512f")))
+inline void decode_morton_2d_range(std::uint64_t first, std::size_t n, std::uint32_t* xs, std::uint32_t* ys)
+{
+  __m512i m = _mm512_add_epi64(_mm512_set1_epi64(static_cast<long long>(first)), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m512i eight = _mm512_set1_epi64(8);
+
+  std::size_t i = 0;
+  for(; i + 8 <= n; i += 8, m = _mm512_add_epi64(m, eight))
+  {
+    decode_morton_2d(m, xs + i, ys + i);
+  }
+
+  scalar::decode_morton_2d_range(first + i, n - i, xs + i, ys + i);
+}
+
+
+} // end avx512
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif // DIST2D_HAS_X86_SIMD
+
+
+} // end simd
+} // end detail
+
+
+// decodes codes[i] into (xs[i], ys[i]) for each i in [0, n)
+// this chooses the widest vector decoder this processor supports at run time
+inline void decode_morton_2d(const std::uint64_t* codes, std::size_t n, std::uint32_t* xs, std::uint32_t* ys)
+{
+  switch(detail::simd::selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case detail::simd::isa::avx512: detail::simd::avx512::decode_morton_2d(codes, n, xs, ys); break;
+    case detail::simd::isa::avx2:   detail::simd::avx2::decode_morton_2d(codes, n, xs, ys);   break;
+#endif
+    default:                        detail::simd::scalar::decode_morton_2d(codes, n, xs, ys); break;
+  }
+}
+
+
+// decodes the consecutive codes first, first + 1, ..., first + n - 1 into (xs[i], ys[i])
+inline void decode_morton_2d_range(std::uint64_t first, std::size_t n, std::uint32_t* xs, std::uint32_t* ys)
+{
+  switch(detail::simd::selected_isa())
+  {
+#if defined(DIST2D_HAS_X86_SIMD)
+    case detail::simd::isa::avx512: detail::simd::avx512::decode_morton_2d_range(first, n, xs, ys); break;
+    case detail::simd::isa::avx2:   detail::simd::avx2::decode_morton_2d_range(first, n, xs, ys);   break;
+#endif
+    default:                        detail::simd::scalar::decode_morton_2d_range(first, n, xs, ys); break;
+  }
+}
+
+
+
+// the urns of the sample index i: the coordinates of the Morton code i with their bits reversed, rotated around [0,1)
+// unit_interval_distribution keeps an urn's high bits, and reversal moves the bits which vary fastest between
+// consecutive indices there, so the indices [0, 4^k) form a 2^k x 2^k grid of [0,1)^2 and any range of indices is
+// spread over the square rather than crowded into a corner
+// the rotation, by the fractions of the golden ratio and of sqrt(2), keeps one point to each cell of the grid, but moves
+// its first column & row off the square's edges, which e.g. the polar mappings collapse to a single point
+inline std::pair<std::uint32_t,std::uint32_t> morton_urns(std::uint64_t i)
+{
+  auto xy = decode_morton_2d(i);
+  return std::make_pair(detail::reverse_bits(xy.first) + 0x9e3779b9u, detail::reverse_bits(xy.second) + 0x6a09e667u);
+}
+
+
+// stores morton_urns(first + i) to (urn1s[i], urn2s[i]) for each i in [0, n)
+inline void morton_urns_range(std::uint64_t first, std::size_t n, std::uint32_t* urn1s, std::uint32_t* urn2s)
+{
+  decode_morton_2d_range(first, n, urn1s, urn2s);
+
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    urn1s[i] = detail::reverse_bits(urn1s[i]) + 0x9e3779b9u;
+    urn2s[i] = detail::reverse_bits(urn2s[i]) + 0x6a09e667u;
+  }
+}
+
+
+} // end dist2d
+
@@ -0,0 +1,298 @@
+#pragma once
+
+#include "detail/half.hpp"
+#include "detail/unorm16.hpp"
+#include "detail/octahedral.hpp"
+#include "detail/simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dist2d
+{
+
+
+// compact point types for streaming samples to other stages of a pipeline
+//
+// each is constructible from its coordinates, specializes std::tuple_element and std::tuple_size,
+// and has a get<I>() which decodes its I-th coordinate, so any of them may be used as the Point type
+// of a distribution of the same dimension, e.g.
+//
+//     unit_sphere_distribution<octahedral_unit_vector> sphere;
+//     octahedral_unit_vector direction = sphere(g);
+//     assert(sphere.contains(direction));
+//
+// contains(), inverse(), and probability_density() see the decoded point, which the quantization may move
+// e.g. a half2 very near the unit circle may round outside of it
+//
+// the distributions with batch generate() functions also pack into arrays of them without
+// storing the unpacked points, e.g.
+//
+//     unit_sphere_distribution<> sphere;
+//     std::vector<octahedral_unit_vector> directions(n);
+//     sphere.generate(0, n, directions.data());
+//
+// decode() returns the coordinates as floats
+
+
+// two IEEE 754 binary16 coordinates, in 4 bytes
+struct half2
+{
+  std::uint16_t x, y;
+
+  half2() = default;
+
+  half2(float x, float y)
+    : x(detail::float_to_half(x)),
+      y(detail::float_to_half(y))
+  {}
+
+  std::pair<float,float> decode() const
+  {
+    return std::make_pair(detail::half_to_float(x), detail::half_to_float(y));
+  }
+};
+
+
+// three IEEE 754 binary16 coordinates, in 6 bytes
+struct half3
+{
+  std::uint16_t x, y, z;
+
+  half3() = default;
+
+  half3(float x, float y, float z)
+    : x(detail::float_to_half(x)),
+      y(detail::float_to_half(y)),
+      z(detail::float_to_half(z))
+  {}
+
+  std::tuple<float,float,float> decode() const
+  {
+    return std::make_tuple(detail::half_to_float(x), detail::half_to_float(y), detail::half_to_float(z));
+  }
+};
+
+
+// a point in [-1,1]^2, such as a point on the unit disk, as two 16b fixed point coordinates in 4 bytes
+// the coordinates are uniformly spaced 2/65535 apart
+struct unorm16_disk_point
+{
+  std::uint16_t x, y;
+
+  unorm16_disk_point() = default;
+
+  unorm16_disk_point(float x, float y)
+    : x(detail::encode_unorm16(x, -1.f, 1.f)),
+      y(detail::encode_unorm16(y, -1.f, 1.f))
+  {}
+
+  std::pair<float,float> decode() const
+  {
+    return std::make_pair(detail::decode_unorm16(x, -1.f, 1.f), detail::decode_unorm16(y, -1.f, 1.f));
+  }
+};
+
+
+// a unit vector, octahedrally encoded as two 16b fixed point coordinates in 4 bytes
+// the decoded vector is within about 1.2e-5 radians of the encoded vector
+struct octahedral_unit_vector
+{
+  std::int16_t u, v;
+
+  octahedral_unit_vector() = default;
+
+  octahedral_unit_vector(float x, float y, float z)
+  {
+    float fu, fv;
+    detail::octahedral_encode(x, y, z, fu, fv);
+
+    u = detail::encode_snorm16(fu);
+    v = detail::encode_snorm16(fv);
+  }
+
+  std::tuple<float,float,float> decode() const
+  {
+    float x, y, z;
+    detail::octahedral_decode(detail::decode_snorm16(u), detail::decode_snorm16(v), x, y, z);
+
+    return std::make_tuple(x, y, z);
+  }
+};
+
+
+// the I-th decoded coordinate of p
+// the distributions find these by argument dependent lookup, see detail/coordinate.hpp
+template<std::size_t I>
+float get(const half2& p)
+{
+  return std::get<I>(p.decode());
+}
+
+template<std::size_t I>
+float get(const half3& p)
+{
+  return std::get<I>(p.decode());
+}
+
+template<std::size_t I>
+float get(const unorm16_disk_point& p)
+{
+  return std::get<I>(p.decode());
+}
+
+template<std::size_t I>
+float get(const octahedral_unit_vector& p)
+{
+  return std::get<I>(p.decode());
+}
+
+
+static_assert(sizeof(half2) == 4 && sizeof(half3) == 6 && sizeof(unorm16_disk_point) == 4 && sizeof(octahedral_unit_vector) == 4,
+              "the packed point types must not have padding");
+
+
+namespace detail
+{
+
+
+// packs the n points (xs[k], ys[k]) or (xs[k], ys[k], zs[k]) to out
+// the packed types of packed_point.hpp have vector kernels for float points, see detail/simd.hpp
+template<class Real1, class Real2, class Packed>
+void pack_points(const Real1* xs, const Real2* ys, std::size_t n, Packed* out)
+{
+  for(std::size_t k = 0; k < n; ++k)
+  {
+    out[k] = Packed(xs[k], ys[k]);
+  }
+}
+
+
+template<class Real1, class Real2, class Real3, class Packed>
+void pack_points(const Real1* xs, const Real2* ys, const Real3* zs, std::size_t n, Packed* out)
+{
+  for(std::size_t k = 0; k < n; ++k)
+  {
+    out[k] = Packed(xs[k], ys[k], zs[k]);
+  }
+}
+
+
+inline void pack_points(const float* xs, const float* ys, std::size_t n, half2* out)
+{
+  simd::pack_half(xs, ys, n, reinterpret_cast<std::uint16_t*>(out));
+}
+
+
+inline void pack_points(const float* xs, const float* ys, const float* zs, std::size_t n, half3* out)
+{
+  simd::pack_half(xs, ys, zs, n, reinterpret_cast<std::uint16_t*>(out));
+}
+
+
+inline void pack_points(const float* xs, const float* ys, std::size_t n, unorm16_disk_point* out)
+{
+  simd::pack_unorm16(xs, ys, n, -1.f, 1.f, reinterpret_cast<std::uint16_t*>(out));
+}
+
+
+inline void pack_points(const float* xs, const float* ys, const float* zs, std::size_t n, octahedral_unit_vector* out)
+{
+  simd::pack_octahedral(xs, ys, zs, n, reinterpret_cast<std::uint16_t*>(out));
+}
+
+
+// generates the points operator()(first_index), ... of dist a chunk at a time and packs each chunk to out,
+// so that the unpacked points never leave the cache
+template<class Distribution, class Integer, class Packed>
+void generate_packed(const Distribution& dist, Integer first_index, std::size_t count, Packed* out, std::integral_constant<std::size_t,2>)
+{
+  using point = typename Distribution::result_type;
+  using real_type1 = typename std::tuple_element<0,point>::type;
+  using real_type2 = typename std::tuple_element<1,point>::type;
+
+  real_type1 xs[simd::chunk_size];
+  real_type2 ys[simd::chunk_size];
+
+  for(std::size_t i = 0; i < count; i += simd::chunk_size)
+  {
+    std::size_t n = std::min(simd::chunk_size, count - i);
+    dist.generate(static_cast<Integer>(first_index + i), n, xs, ys);
+
+    pack_points(xs, ys, n, out + i);
+  }
+}
+
+
+template<class Distribution, class Integer, class Packed>
+void generate_packed(const Distribution& dist, Integer first_index, std::size_t count, Packed* out, std::integral_constant<std::size_t,3>)
+{
+  using point = typename Distribution::result_type;
+  using real_type1 = typename std::tuple_element<0,point>::type;
+  using real_type2 = typename std::tuple_element<1,point>::type;
+  using real_type3 = typename std::tuple_element<2,point>::type;
+
+  real_type1 xs[simd::chunk_size];
+  real_type2 ys[simd::chunk_size];
+  real_type3 zs[simd::chunk_size];
+
+  for(std::size_t i = 0; i < count; i += simd::chunk_size)
+  {
+    std::size_t n = std::min(simd::chunk_size, count - i);
+    dist.generate(static_cast<Integer>(first_index + i), n, xs, ys, zs);
+
+    pack_points(xs, ys, zs, n, out + i);
+  }
+}
+
+
+template<class Distribution, class Integer, class Packed>
+void generate_packed(const Distribution& dist, Integer first_index, std::size_t count, Packed* out)
+{
+  using dimension = std::tuple_size<typename Distribution::result_type>;
+  generate_packed(dist, first_index, count, out, std::integral_constant<std::size_t,dimension::value>());
+}
+
+
+} // end detail
+} // end dist2d
+
+
+namespace std
+{
+
+
+template<>
+struct tuple_size<dist2d::half2> : std::integral_constant<std::size_t,2> {};
+
+template<std::size_t I>
+struct tuple_element<I,dist2d::half2> { using type = float; };
+
+
+template<>
+struct tuple_size<dist2d::half3> : std::integral_constant<std::size_t,3> {};
+
+template<std::size_t I>
+struct tuple_element<I,dist2d::half3> { using type = float; };
+
+
+template<>
+struct tuple_size<dist2d::unorm16_disk_point> : std::integral_constant<std::size_t,2> {};
+
+template<std::size_t I>
+struct tuple_element<I,dist2d::unorm16_disk_point> { using type = float; };
+
+
+template<>
+struct tuple_size<dist2d::octahedral_unit_vector> : std::integral_constant<std::size_t,3> {};
+
+template<std::size_t I>
+struct tuple_element<I,dist2d::octahedral_unit_vector> { using type = float; };
+
+
+} // end std
+
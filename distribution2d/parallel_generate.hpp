@@ -0,0 +1,140 @@
+#pragma once
+
+#include "execution.hpp"
+#include "counter_based_generator.hpp"
+#include "detail/parallel_for.hpp"
+#include "detail/simd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dist2d
+{
+
+
+namespace detail
+{
+
+
+// true when Distribution has a batch generate(first_index, count, xs, ys) or generate(first_index, count, xs, ys, zs)
+// which stores its points' coordinates to one array per coordinate
+template<class Distribution, std::size_t dimension = std::tuple_size<typename Distribution::result_type>::value, class = void>
+struct has_batch_generate : std::false_type {};
+
+template<class Distribution>
+struct has_batch_generate<Distribution, 2, decltype(void(std::declval<const Distribution&>().generate(
+  std::uint64_t(0), std::size_t(0),
+  static_cast<typename std::tuple_element<0,typename Distribution::result_type>::type*>(nullptr),
+  static_cast<typename std::tuple_element<1,typename Distribution::result_type>::type*>(nullptr)
+)))> : std::true_type {};
+
+template<class Distribution>
+struct has_batch_generate<Distribution, 3, decltype(void(std::declval<const Distribution&>().generate(
+  std::uint64_t(0), std::size_t(0),
+  static_cast<typename std::tuple_element<0,typename Distribution::result_type>::type*>(nullptr),
+  static_cast<typename std::tuple_element<1,typename Distribution::result_type>::type*>(nullptr),
+  static_cast<typename std::tuple_element<2,typename Distribution::result_type>::type*>(nullptr)
+)))> : std::true_type {};
+
+
+// stores dist(first_index + k) to out[k] for each k in [begin, end)
+template<class Distribution, class RandomAccessIterator>
+void generate_range(const Distribution& dist, std::uint64_t first_index, std::size_t begin, std::size_t end, RandomAccessIterator out, std::false_type)
+{
+  for(std::size_t k = begin; k < end; ++k)
+  {
+    out[k] = dist(first_index + k);
+  }
+}
+
+
+// calls dist's batch generate() a chunk at a time, and stores the chunk's points while they're in cache
+template<class Distribution, class RandomAccessIterator>
+void generate_range(const Distribution& dist, std::uint64_t first_index, std::size_t begin, std::size_t end, RandomAccessIterator out, std::integral_constant<std::size_t,2>)
+{
+  using point = typename Distribution::result_type;
+
+  typename std::tuple_element<0,point>::type xs[simd::chunk_size];
+  typename std::tuple_element<1,point>::type ys[simd::chunk_size];
+
+  for(std::size_t i = begin; i < end; i += simd::chunk_size)
+  {
+    std::size_t n = std::min(simd::chunk_size, end - i);
+    dist.generate(first_index + i, n, xs, ys);
+
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      out[i + k] = point{xs[k], ys[k]};
+    }
+  }
+}
+
+
+template<class Distribution, class RandomAccessIterator>
+void generate_range(const Distribution& dist, std::uint64_t first_index, std::size_t begin, std::size_t end, RandomAccessIterator out, std::integral_constant<std::size_t,3>)
+{
+  using point = typename Distribution::result_type;
+
+  typename std::tuple_element<0,point>::type xs[simd::chunk_size];
+  typename std::tuple_element<1,point>::type ys[simd::chunk_size];
+  typename std::tuple_element<2,point>::type zs[simd::chunk_size];
+
+  for(std::size_t i = begin; i < end; i += simd::chunk_size)
+  {
+    std::size_t n = std::min(simd::chunk_size, end - i);
+    dist.generate(first_index + i, n, xs, ys, zs);
+
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      out[i + k] = point{xs[k], ys[k], zs[k]};
+    }
+  }
+}
+
+
+template<class Distribution, class RandomAccessIterator>
+void generate_range(const Distribution& dist, std::uint64_t first_index, std::size_t begin, std::size_t end, RandomAccessIterator out, std::true_type)
+{
+  using dimension = std::tuple_size<typename Distribution::result_type>;
+  generate_range(dist, first_index, begin, end, out, std::integral_constant<std::size_t,dimension::value>());
+}
+
+
+} // end detail
+
+
+// stores n samples of dist to out[0], ..., out[n-1] and returns out + n
+// sample k is the point of index first + k, where first = counter_based_generator<Function>(seed)(0, 0) is a random index,
+// so the samples depend only on the seed and their position, never on the policy, the number of threads, or how the work was divided
+// each thread calls dist's batch generate(), where it has one, on its share of the consecutive indices, so that the
+// vector kernels of detail/simd.hpp compute the samples where dist's generate() uses them; otherwise sample k is dist(first + k)
+// XXX like the points of any run of consecutive indices, the samples are stratified rather than independent
+template<class Function, class Distribution, class RandomAccessIterator, class ExecutionPolicy>
+RandomAccessIterator parallel_generate(const ExecutionPolicy& policy, const Distribution& dist, const counter_based_generator<Function>& rng, std::size_t n, RandomAccessIterator out)
+{
+  // big enough to amortize the shared counter, small enough to balance the load
+  const std::size_t grain_size = 1 << 16;
+
+  const std::uint64_t first = rng(0, 0);
+
+  detail::parallel_for(policy, n, grain_size, [&](std::size_t begin, std::size_t end)
+  {
+    detail::generate_range(dist, first, begin, end, out, detail::has_batch_generate<Distribution>());
+  });
+
+  return out + n;
+}
+
+
+template<class Distribution, class RandomAccessIterator, class ExecutionPolicy>
+RandomAccessIterator parallel_generate(const ExecutionPolicy& policy, const Distribution& dist, std::uint64_t seed, std::size_t n, RandomAccessIterator out)
+{
+  return dist2d::parallel_generate(policy, dist, counter_based_generator<>(seed), n, out);
+}
+
+
+} // end dist2d
+
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "unit_square_distribution.hpp"
+#include "execution.hpp"
+#include "detail/alias_table.hpp"
+#include "detail/parallel_for.hpp"
+#include "detail/coordinate.hpp"
+#include <utility>
+#include <tuple>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace dist2d
+{
+
+
+// a distribution of points in [0,1)^2 whose density is proportional to a width x height image of weights,
+// e.g. the luminance of an environment map
+//
+// weights is stored in row-major order: the weight of the pixel [x/width, (x+1)/width) x [y/height, (y+1)/height)
+// is weights[y * width + x]
+//
+// operator() chooses a row from the marginal distribution of the rows with urn2, and a pixel within the row from its
+// conditional distribution with urn1, each in constant time with an alias table
+// the remainder of each urn positions the point uniformly within its pixel
+// XXX the alias method doesn't preserve the stratification of its input points
+template<class Point = std::pair<float,float>>
+class piecewise_constant_2d_distribution
+{
+  public:
+    using result_type = Point;
+
+  private:
+    using real_type1 = typename std::tuple_element<0,result_type>::type;
+    using real_type2 = typename std::tuple_element<1,result_type>::type;
+
+  public:
+    using real_type = typename std::common_type<real_type1, real_type2>::type;
+
+    // builds the distribution's tables, dividing the rows among threads as requested by policy
+    template<class Weight, class ExecutionPolicy>
+    piecewise_constant_2d_distribution(const ExecutionPolicy& policy, const Weight* weights, std::size_t width, std::size_t height)
+      : width_(width),
+        height_(height),
+        conditional_(checked_size(width, height)),
+        support_area_(0)
+    {
+      std::vector<double> row_weights(height);
+      std::vector<std::size_t> row_support(height);
+
+      detail::parallel_for(policy, height, 16, [&](std::size_t begin, std::size_t end)
+      {
+        detail::alias_table_workspace workspace;
+
+        for(std::size_t y = begin; y < end; ++y)
+        {
+          const Weight* row = weights + y * width;
+
+          row_weights[y] = detail::build_alias_table(row, width, conditional_.data() + y * width, workspace);
+          row_support[y] = std::count_if(row, row + width, [](const Weight& w) { return w > 0; });
+        }
+      });
+
+      marginal_ = detail::alias_table<real_type>(row_weights.data(), height);
+
+      if(marginal_.total_weight() == 0)
+      {
+        throw std::invalid_argument("piecewise_constant_2d_distribution: some weight must be positive");
+      }
+
+      std::size_t support = 0;
+      for(std::size_t n : row_support) support += n;
+      support_area_ = real_type(double(support) / (double(width) * double(height)));
+    }
+
+    template<class Weight>
+    piecewise_constant_2d_distribution(const Weight* weights, std::size_t width, std::size_t height)
+      : piecewise_constant_2d_distribution(execution::par, weights, width, height)
+    {}
+
+    std::size_t width() const
+    {
+      return width_;
+    }
+
+    std::size_t height() const
+    {
+      return height_;
+    }
+
+    template<class Float1, class Float2>
+    typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      result_type
+    >::type
+      operator()(Float1 u1, Float2 u2) const
+    {
+      std::uint32_t x, y;
+      return sample(real_type(u1), real_type(u2), x, y);
+    }
+
+    template<class Integer1, class Integer2>
+    typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 urn1, Integer2 urn2) const
+    {
+      real_type u1 = unit_interval_distribution<real_type>()(urn1);
+      real_type u2 = unit_interval_distribution<real_type>()(urn2);
+
+      return operator()(u1, u2);
+    }
+
+    // returns operator()(u1, u2) with its density, from the pmfs of the row and pixel which the lookup chose
+    template<class Float1, class Float2>
+    typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      std::uint32_t x, y;
+      result_type p = sample(real_type(u1), real_type(u2), x, y);
+
+      return std::make_pair(p, density(x, y));
+    }
+
+    template<class Integer1, class Integer2>
+    typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      real_type u1 = unit_interval_distribution<real_type>()(urn1);
+      real_type u2 = unit_interval_distribution<real_type>()(urn2);
+
+      return sample_with_pdf(u1, u2);
+    }
+
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    result_type operator()(Integer i) const
+    {
+      auto xy = morton_urns(i);
+      return operator()(xy.first, xy.second);
+    }
+
+    // XXX this only makes sense if g generates numbers which span the entire range of the result type
+    //     some random number generators don't do that
+    template<class Generator,
+             class = typename std::enable_if<
+               detail::is_integral_generator<Generator>::value
+             >::type>
+    result_type operator()(Generator& g) const
+    {
+      auto u = detail::unit_square_from_generator<real_type,real_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs and ys
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto p = operator()(static_cast<Integer>(first_index + k));
+
+        xs[k] = detail::coordinate<0>(p);
+        ys[k] = detail::coordinate<1>(p);
+      }
+    }
+
+    // true if p lies in a pixel of positive weight
+    bool contains(const result_type& p) const
+    {
+      return unit_square_distribution<result_type>::contains(p) && probability_density(p) > 0;
+    }
+
+    // stores contains((xs[i], ys[i])) to mask[i] for each of the count points
+    void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask) const
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i]});
+      }
+    }
+
+    // if !unit_square_distribution<Point>::contains(p) the result is undefined
+    real_type probability_density(const result_type& p) const
+    {
+      return density(pixel(detail::coordinate<0>(p), width_), pixel(detail::coordinate<1>(p), height_));
+    }
+
+    // stores the density at each of the count points (xs[i], ys[i]) to pdfs[i], or 0 outside of [0,1)^2
+    // XXX each density is a dependent lookup into the tables, so this isn't vectorized
+    void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, real_type* pdfs) const
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        result_type p{xs[i], ys[i]};
+        pdfs[i] = unit_square_distribution<result_type>::contains(p) ? probability_density(p) : real_type(0);
+      }
+    }
+
+    // the area of the pixels of positive weight
+    real_type area() const
+    {
+      return support_area_;
+    }
+
+  private:
+    static std::size_t checked_size(std::size_t width, std::size_t height)
+    {
+      if(width == 0 || height == 0 ||
+         width > std::numeric_limits<std::uint32_t>::max() ||
+         height > std::numeric_limits<std::uint32_t>::max())
+      {
+        throw std::invalid_argument("piecewise_constant_2d_distribution: width and height must be in [1, 2^32)");
+      }
+
+      return width * height;
+    }
+
+    // chooses the pixel (x, y) and the point within it
+    result_type sample(real_type u1, real_type u2, std::uint32_t& x, std::uint32_t& y) const
+    {
+      real_type y_in_pixel;
+      y = marginal_(u2, y_in_pixel);
+
+      real_type x_in_pixel;
+      x = detail::sample_alias_table(conditional_.data() + y * width_, width_, u1, x_in_pixel);
+
+      return result_type{
+        real_type1(to_unit_interval(x, x_in_pixel, width_)),
+        real_type2(to_unit_interval(y, y_in_pixel, height_))
+      };
+    }
+
+    // the density of the points of pixel (x, y)
+    real_type density(std::size_t x, std::size_t y) const
+    {
+      return marginal_.pmf(y) * conditional_[y * width_ + x].pmf * real_type(width_) * real_type(height_);
+    }
+
+    // the pixel of n containing x in [0,1)
+    static std::size_t pixel(real_type x, std::size_t n)
+    {
+      using compute_type = typename std::common_type<real_type,double>::type;
+
+      return std::min(static_cast<std::size_t>(compute_type(x) * compute_type(n)), n - 1);
+    }
+
+    // maps the position fraction within pixel i of n to [0,1)
+    // the result is kept below the pixel's upper edge, which rounding would otherwise reach when fraction is near 1
+    static real_type to_unit_interval(std::uint32_t i, real_type fraction, std::size_t n)
+    {
+      using compute_type = typename std::common_type<real_type,double>::type;
+
+      real_type result = real_type((compute_type(i) + compute_type(fraction)) / compute_type(n));
+      while(compute_type(result) * compute_type(n) >= compute_type(i + 1))
+      {
+        result = std::nextafter(result, real_type(0));
+      }
+
+      return result;
+    }
+
+    std::size_t width_;
+    std::size_t height_;
+    detail::alias_table<real_type> marginal_;
+    std::vector<detail::alias_bin<real_type>> conditional_;
+    real_type support_area_;
+};
+
+
+} // end dist2d
+
@@ -0,0 +1,563 @@
+#pragma once
+
+#include "unit_interval_distribution.hpp"
+#include "stratified_sample_set.hpp"
+#include "counter_based_generator.hpp"
+#include "detail/orthonormal_basis.hpp"
+#include "detail/vector3.hpp"
+#include "detail/math_constants.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// a grid over the box [lower, lower + extent)^Dimension of cells at least radius wide, so that the points within radius
+// of a point lie in its cell and the cells around it
+// each cell heads a list of its points, linked through next_
+// the 2D grids are dense, and the sphere's 3D grid is an open addressing hash table, since only the cells near its
+// surface are ever occupied
+template<int Dimension>
+class poisson_disk_grid
+{
+  public:
+    poisson_disk_grid(double lower, double extent, double radius, bool periodic)
+      : lower_(lower),
+        resolution_(std::max<std::int64_t>(1, static_cast<std::int64_t>(std::floor(extent / radius)))),
+        inverse_cell_size_(double(resolution_) / extent),
+        periodic_(periodic),
+        hash_mask_(0)
+    {
+      if(Dimension == 2)
+      {
+        heads_.resize(std::size_t(resolution_ * resolution_), 0);
+      }
+      else
+      {
+        hash_mask_ = 1023;
+        keys_.resize(hash_mask_ + 1, std::uint64_t(empty_key));
+        heads_.resize(hash_mask_ + 1, 0);
+      }
+    }
+
+    void insert(const vector3<double>& p, std::uint32_t index)
+    {
+      std::int64_t c[3];
+      cell(p, c);
+
+      std::uint32_t& head = find_or_insert(key(c));
+      next_.push_back(head);
+      head = index + 1;
+    }
+
+    // returns true if f(index) is true for a point in p's cell or the cells around it
+    template<class Function>
+    bool any_nearby(const vector3<double>& p, Function f) const
+    {
+      std::int64_t c[3];
+      cell(p, c);
+
+      const std::int64_t reach_z = Dimension == 3 ? 1 : 0;
+
+      for(std::int64_t dz = -reach_z; dz <= reach_z; ++dz)
+      {
+        for(std::int64_t dy = -1; dy <= 1; ++dy)
+        {
+          for(std::int64_t dx = -1; dx <= 1; ++dx)
+          {
+            std::int64_t neighbor[3] = {c[0] + dx, c[1] + dy, c[2] + dz};
+            if(!wrap(neighbor)) continue;
+
+            for(std::uint32_t i = find(key(neighbor)); i != 0; i = next_[i - 1])
+            {
+              if(f(i - 1)) return true;
+            }
+          }
+        }
+      }
+
+      return false;
+    }
+
+  private:
+    static constexpr std::uint64_t empty_key = ~std::uint64_t(0);
+
+    void cell(const vector3<double>& p, std::int64_t* c) const
+    {
+      const double coordinates[3] = {p.x, p.y, p.z};
+
+      for(int d = 0; d < 3; ++d)
+      {
+        std::int64_t i = static_cast<std::int64_t>(std::floor((coordinates[d] - lower_) * inverse_cell_size_));
+        c[d] = d < Dimension ? std::max<std::int64_t>(0, std::min(i, resolution_ - 1)) : 0;
+      }
+    }
+
+    // wraps the cell c around a periodic grid, or returns false if it lies outside of a bounded one
+    // a periodic grid of fewer than 3 cells visits some cells twice, which is harmless
+    bool wrap(std::int64_t* c) const
+    {
+      for(int d = 0; d < Dimension; ++d)
+      {
+        if(c[d] >= 0 && c[d] < resolution_) continue;
+        if(!periodic_) return false;
+
+        c[d] = ((c[d] % resolution_) + resolution_) % resolution_;
+      }
+
+      return true;
+    }
+
+    std::uint64_t key(const std::int64_t* c) const
+    {
+      return std::uint64_t((c[2] * resolution_ + c[1]) * resolution_ + c[0]);
+    }
+
+    std::size_t slot(std::uint64_t key) const
+    {
+      return std::size_t(hash(static_cast<std::uint32_t>(key ^ (key >> 32)))) & hash_mask_;
+    }
+
+    // the head of the cell's list, or 0 if it's empty
+    std::uint32_t find(std::uint64_t key) const
+    {
+      if(Dimension == 2) return heads_[key];
+
+      for(std::size_t i = slot(key); ; i = (i + 1) & hash_mask_)
+      {
+        if(keys_[i] == key) return heads_[i];
+        if(keys_[i] == empty_key) return 0;
+      }
+    }
+
+    std::uint32_t& find_or_insert(std::uint64_t key)
+    {
+      if(Dimension == 2) return heads_[key];
+
+      // keep the table at most half full
+      if(2 * (occupied_ + 1) > keys_.size()) grow();
+
+      std::size_t i = slot(key);
+      for(; keys_[i] != key && keys_[i] != empty_key; i = (i + 1) & hash_mask_) {}
+
+      if(keys_[i] == empty_key)
+      {
+        keys_[i] = key;
+        ++occupied_;
+      }
+
+      return heads_[i];
+    }
+
+    void grow()
+    {
+      std::vector<std::uint64_t> keys(2 * keys_.size(), std::uint64_t(empty_key));
+      std::vector<std::uint32_t> heads(2 * heads_.size(), 0);
+      keys.swap(keys_);
+      heads.swap(heads_);
+      hash_mask_ = keys_.size() - 1;
+
+      for(std::size_t i = 0; i < keys.size(); ++i)
+      {
+        if(keys[i] == empty_key) continue;
+
+        std::size_t j = slot(keys[i]);
+        for(; keys_[j] != empty_key; j = (j + 1) & hash_mask_) {}
+
+        keys_[j] = keys[i];
+        heads_[j] = heads[i];
+      }
+    }
+
+    double lower_;
+    std::int64_t resolution_;
+    double inverse_cell_size_;
+    bool periodic_;
+    std::vector<std::uint32_t> heads_;
+    std::vector<std::uint32_t> next_;
+    std::vector<std::uint64_t> keys_;
+    std::size_t hash_mask_;
+    std::size_t occupied_ = 0;
+};
+
+
+// a candidate at a distance in [radius, 2 radius) from (x, y) in a uniformly chosen direction
+template<class Generator>
+vector3<double> poisson_disk_planar_candidate(const vector3<double>& p, double radius, Generator& g)
+{
+  double d = radius * (1 + unit_interval_distribution<double>()(g));
+  double phi = math_constants::two_pi * unit_interval_distribution<double>()(g);
+
+  return vector3<double>{p.x + d * std::cos(phi), p.y + d * std::sin(phi), 0};
+}
+
+
+// [0,1)^2, whose distances wrap around, so the set tiles the plane
+struct poisson_disk_torus
+{
+  static constexpr int dimension = 2;
+  static constexpr double lower = 0;
+  static constexpr double extent = 1;
+  static constexpr bool periodic = true;
+
+  template<class Generator>
+  vector3<double> random_point(Generator& g) const
+  {
+    double x = unit_interval_distribution<double>()(g);
+    double y = unit_interval_distribution<double>()(g);
+
+    return vector3<double>{x, y, 0};
+  }
+
+  template<class Generator>
+  bool candidate(const vector3<double>& p, double radius, Generator& g, vector3<double>& c) const
+  {
+    c = poisson_disk_planar_candidate(p, radius, g);
+    c.x = wrap(c.x);
+    c.y = wrap(c.y);
+
+    return true;
+  }
+
+  double distance_squared(const vector3<double>& a, const vector3<double>& b) const
+  {
+    double dx = std::fabs(a.x - b.x);
+    double dy = std::fabs(a.y - b.y);
+
+    dx = std::min(dx, 1 - dx);
+    dy = std::min(dy, 1 - dy);
+
+    return dx * dx + dy * dy;
+  }
+
+  // x mod 1, in [0,1)
+  static double wrap(double x)
+  {
+    x -= std::floor(x);
+    return x < 1 ? x : 0;
+  }
+};
+
+
+// the unit disk
+struct poisson_disk_disk
+{
+  static constexpr int dimension = 2;
+  static constexpr double lower = -1;
+  static constexpr double extent = 2;
+  static constexpr bool periodic = false;
+
+  template<class Generator>
+  vector3<double> random_point(Generator& g) const
+  {
+    vector3<double> p;
+    do
+    {
+      p = vector3<double>{2 * unit_interval_distribution<double>()(g) - 1, 2 * unit_interval_distribution<double>()(g) - 1, 0};
+    }
+    while(!contains(p));
+
+    return p;
+  }
+
+  template<class Generator>
+  bool candidate(const vector3<double>& p, double radius, Generator& g, vector3<double>& c) const
+  {
+    c = poisson_disk_planar_candidate(p, radius, g);
+    return contains(c);
+  }
+
+  double distance_squared(const vector3<double>& a, const vector3<double>& b) const
+  {
+    vector3<double> d = a - b;
+    return dot(d, d);
+  }
+
+  static bool contains(const vector3<double>& p)
+  {
+    return p.x * p.x + p.y * p.y < 1;
+  }
+};
+
+
+// the unit sphere, whose distances are the lengths of chords
+struct poisson_disk_sphere
+{
+  static constexpr int dimension = 3;
+  static constexpr double lower = -1;
+  static constexpr double extent = 2;
+  static constexpr bool periodic = false;
+
+  template<class Generator>
+  vector3<double> random_point(Generator& g) const
+  {
+    double z = 1 - 2 * unit_interval_distribution<double>()(g);
+    double r = std::sqrt(std::max(0., 1 - z * z));
+    double phi = math_constants::two_pi * unit_interval_distribution<double>()(g);
+
+    return vector3<double>{r * std::cos(phi), r * std::sin(phi), z};
+  }
+
+  // the candidate is rotated away from p by the angle whose chord is in [radius, 2 radius)
+  template<class Generator>
+  bool candidate(const vector3<double>& p, double radius, Generator& g, vector3<double>& c) const
+  {
+    double chord = std::min(radius * (1 + unit_interval_distribution<double>()(g)), 2.);
+    double theta = 2 * std::asin(chord / 2);
+    double phi = math_constants::two_pi * unit_interval_distribution<double>()(g);
+
+    vector3<double> t1, t2;
+    orthonormal_basis(p.x, p.y, p.z, t1.x, t1.y, t1.z, t2.x, t2.y, t2.z);
+
+    c = normalize(std::cos(theta) * p + std::sin(theta) * (std::cos(phi) * t1 + std::sin(phi) * t2));
+    return true;
+  }
+
+  double distance_squared(const vector3<double>& a, const vector3<double>& b) const
+  {
+    vector3<double> d = a - b;
+    return dot(d, d);
+  }
+};
+
+
+// Bridson's algorithm on Domain; see poisson_disk_unit_square
+template<class Domain, class Generator>
+std::vector<vector3<double>> poisson_disk(const Domain& domain, double radius, Generator& g, unsigned attempts)
+{
+  if(!(radius > 0))
+  {
+    throw std::invalid_argument("poisson_disk: the radius must be positive");
+  }
+
+  const double radius_squared = radius * radius;
+
+  poisson_disk_grid<Domain::dimension> grid(Domain::lower, Domain::extent, radius, Domain::periodic);
+  std::vector<vector3<double>> points;
+  std::vector<std::uint32_t> active;
+
+  auto add = [&](const vector3<double>& p)
+  {
+    if(points.size() == std::numeric_limits<std::uint32_t>::max())
+    {
+      throw std::invalid_argument("poisson_disk: the number of points must be less than 2^32");
+    }
+
+    std::uint32_t index = static_cast<std::uint32_t>(points.size());
+    points.push_back(p);
+    active.push_back(index);
+    grid.insert(p, index);
+  };
+
+  add(domain.random_point(g));
+
+  while(!active.empty())
+  {
+    std::size_t a = std::min(static_cast<std::size_t>(unit_interval_distribution<double>()(g) * double(active.size())), active.size() - 1);
+    vector3<double> p = points[active[a]];
+
+    bool found = false;
+    for(unsigned k = 0; k < attempts && !found; ++k)
+    {
+      vector3<double> c;
+      if(!domain.candidate(p, radius, g, c)) continue;
+
+      bool too_close = grid.any_nearby(c, [&](std::uint32_t i)
+      {
+        return domain.distance_squared(c, points[i]) < radius_squared;
+      });
+
+      if(!too_close)
+      {
+        add(c);
+        found = true;
+      }
+    }
+
+    // retire p when none of its candidates fit
+    if(!found)
+    {
+      active[a] = active.back();
+      active.pop_back();
+    }
+  }
+
+  return points;
+}
+
+
+template<class Point>
+std::vector<Point> to_points(const std::vector<vector3<double>>& points, std::integral_constant<int,2>)
+{
+  using real_type1 = typename std::tuple_element<0,Point>::type;
+  using real_type2 = typename std::tuple_element<1,Point>::type;
+
+  std::vector<Point> result;
+  result.reserve(points.size());
+  for(const auto& p : points) result.push_back(Point{real_type1(p.x), real_type2(p.y)});
+
+  return result;
+}
+
+
+template<class Point>
+std::vector<Point> to_points(const std::vector<vector3<double>>& points, std::integral_constant<int,3>)
+{
+  using real_type1 = typename std::tuple_element<0,Point>::type;
+  using real_type2 = typename std::tuple_element<1,Point>::type;
+  using real_type3 = typename std::tuple_element<2,Point>::type;
+
+  std::vector<Point> result;
+  result.reserve(points.size());
+  for(const auto& p : points) result.push_back(Point{real_type1(p.x), real_type2(p.y), real_type3(p.z)});
+
+  return result;
+}
+
+
+// returns the 32b fixed point fraction of x in [0,1)
+inline std::uint32_t to_fixed_point(double x)
+{
+  return static_cast<std::uint32_t>(std::min(x * 4294967296.0, 4294967295.0));
+}
+
+
+} // end detail
+
+
+// the following generate Poisson-disk points: no two are closer than radius, and no other point would fit among them
+// this is blue noise, whose points are spread more evenly than those of the sequences or the sample sets
+//
+// they use Bridson's algorithm, which grows the set from a random point by trying attempts candidates at distances in
+// [radius, 2 radius) around a random active point, and retires the point when none of its candidates fit
+// the domain is covered by a grid of cells at least radius wide, so each candidate is tested against the points of its
+// cell and the cells around it only, and the algorithm takes time linear in the points
+// see Bridson, Fast Poisson Disk Sampling in Arbitrary Dimensions, SIGGRAPH 2007 sketches
+//
+// g is a generator of integers, such as counter_based_engine
+// the points are in the order the algorithm accepted them, so prefixes of the set are clustered around the first point
+
+
+// Poisson-disk points in [0,1)^2, whose distances wrap around the square, so the set tiles the plane
+template<class Point = std::pair<float,float>, class Generator>
+std::vector<Point> poisson_disk_unit_square(double radius, Generator& g, unsigned attempts = 30)
+{
+  return detail::to_points<Point>(detail::poisson_disk(detail::poisson_disk_torus(), radius, g, attempts), std::integral_constant<int,2>());
+}
+
+
+// Poisson-disk points in the unit disk
+template<class Point = std::pair<float,float>, class Generator>
+std::vector<Point> poisson_disk_unit_disk(double radius, Generator& g, unsigned attempts = 30)
+{
+  return detail::to_points<Point>(detail::poisson_disk(detail::poisson_disk_disk(), radius, g, attempts), std::integral_constant<int,2>());
+}
+
+
+// Poisson-disk points on the unit sphere, whose radius is the length of the chord between points
+template<class Point = std::tuple<float,float,float>, class Generator>
+std::vector<Point> poisson_disk_unit_sphere(double radius, Generator& g, unsigned attempts = 30)
+{
+  return detail::to_points<Point>(detail::poisson_disk(detail::poisson_disk_sphere(), radius, g, attempts), std::integral_constant<int,3>());
+}
+
+
+// a tile of blue noise: Poisson-disk points in [0,1)^2 whose distances wrap around, so copies of the tile abut seamlessly
+// like the sample sets of stratified_sample_set.hpp, operator()(i) returns point i as a pair of integers which the
+// (urn1, urn2) overloads of the distributions map to the point's coordinates
+// the tile is computed once, e.g. at startup, and scrambled for each pixel with scrambled_blue_noise_sample_set
+class blue_noise_tile
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    // the Poisson-disk points of radius chosen by seed
+    explicit blue_noise_tile(double radius, std::uint64_t seed = 0, unsigned attempts = 30)
+    {
+      counter_based_engine<> g(seed);
+
+      for(const auto& p : detail::poisson_disk(detail::poisson_disk_torus(), radius, g, attempts))
+      {
+        points_.emplace_back(detail::to_fixed_point(p.x), detail::to_fixed_point(p.y));
+      }
+    }
+
+    // a tile precomputed elsewhere, whose points should wrap around as the computed tiles' do
+    explicit blue_noise_tile(std::vector<result_type> points)
+      : points_(std::move(points))
+    {
+      detail::checked_sample_count(points_.size());
+    }
+
+    std::uint32_t size() const
+    {
+      return static_cast<std::uint32_t>(points_.size());
+    }
+
+    result_type operator()(std::uint32_t i) const
+    {
+      return points_[i];
+    }
+
+    const std::vector<result_type>& points() const
+    {
+      return points_;
+    }
+
+  private:
+    std::vector<result_type> points_;
+};
+
+
+// the points of a blue_noise_tile shifted around [0,1)^2 by an offset, and reordered by a permutation, chosen by seed,
+// e.g. pixel_seed(x, y)
+// the shift wraps around as the tile's distances do, so each seed's points are blue noise, uncorrelated with other seeds'
+// the set refers to the tile, which must outlive it
+class scrambled_blue_noise_sample_set
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    scrambled_blue_noise_sample_set(const blue_noise_tile& tile, std::uint32_t seed)
+      : tile_(&tile),
+        seed_(seed),
+        offset1_(detail::jitter(0, seed * 0xa399d265u)),
+        offset2_(detail::jitter(0, seed * 0x711ad6a5u))
+    {}
+
+    std::uint32_t size() const
+    {
+      return tile_->size();
+    }
+
+    result_type operator()(std::uint32_t i) const
+    {
+      result_type p = (*tile_)(detail::permute(i, size(), seed_ * 0x51633e2du));
+
+      // 32b fixed point addition wraps around [0,1)
+      return result_type{
+        static_cast<std::uint32_t>(p.first + offset1_),
+        static_cast<std::uint32_t>(p.second + offset2_)
+      };
+    }
+
+  private:
+    const blue_noise_tile* tile_;
+    std::uint32_t seed_;
+    std::uint32_t offset1_, offset2_;
+};
+
+
+} // end dist2d
+
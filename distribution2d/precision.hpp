@@ -0,0 +1,85 @@
+#pragma once
+
+#include "detail/constexpr_math.hpp"
+#include "detail/math_constants.hpp"
+#include "detail/sincos.hpp"
+#include <type_traits>
+
+namespace dist2d
+{
+
+
+// these select how the polar distributions, unit_disk_distribution, unit_sphere_distribution, and
+// unit_hemisphere_distribution, the concentric distributions, concentric_unit_disk_distribution and
+// cosine_weighted_unit_hemisphere_distribution, and the warp pipelines of warp_pipeline.hpp evaluate their warps
+//
+// each provides compute_type<Real>, the type in which a warp of Real coordinates is evaluated and then rounded,
+// and sincos_turns(t, s, c), which computes sin(2 pi t) and cos(2 pi t) in it
+// the integer overloads & generate() convert their urns to [0,1) in compute_type too, so with double_precision a float
+// point's warp sees all 32 bits of each urn, rather than float's 24
+//
+// the policy selects nothing else: the distributions' constants are correctly rounded to their real_type, and their
+// contains() accepts points within detail::surface_tolerance<real_type>() of their surfaces, because the points it
+// tests are stored in real_type whatever type they were computed in
+//
+// to store points more compactly than they're computed, e.g. to compute in float and store half, use the packed
+// generate() of each distribution with the types of packed_point.hpp
+
+
+// the warp is evaluated in Real with std::sin & std::cos, or detail::constexpr_sin & constexpr_cos during constant evaluation
+// this is the default
+struct accurate_precision
+{
+  template<class Real>
+  using compute_type = Real;
+
+  template<class Real>
+  constexpr static void sincos_turns(Real t, Real& s, Real& c)
+  {
+    Real phi = Real(detail::math_constants::two_pi) * t;
+    s = detail::sin(phi);
+    c = detail::cos(phi);
+  }
+};
+
+
+// for float, sin & cos are the polynomials of detail::sincos_turns, whose error is at most 9.2e-8
+// these are the polynomials the vector kernels of detail/simd.hpp evaluate, so operator() agrees with the batch generate()
+// to within the rounding of the remaining few operations, and avoids the cost of std::sin & std::cos' range reduction
+// for other types this is accurate_precision
+struct fast_precision
+{
+  template<class Real>
+  using compute_type = Real;
+
+  static void sincos_turns(float t, float& s, float& c)
+  {
+    detail::sincos_turns(t, s, c);
+  }
+
+  template<class Real>
+  constexpr static void sincos_turns(Real t, Real& s, Real& c)
+  {
+    accurate_precision::sincos_turns(t, s, c);
+  }
+};
+
+
+// the warp is evaluated in at least double precision and each coordinate is rounded once to Real,
+// so float points are correctly rounded but in the rare cases when the exact result lies within double's rounding of a tie
+// this costs double precision sin & cos, and the batch generate() of float points forgoes the vector kernels
+struct double_precision
+{
+  template<class Real>
+  using compute_type = typename std::common_type<Real, double>::type;
+
+  template<class Real>
+  constexpr static void sincos_turns(Real t, Real& s, Real& c)
+  {
+    accurate_precision::sincos_turns(t, s, c);
+  }
+};
+
+
+} // end dist2d
+
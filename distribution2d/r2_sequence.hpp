@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+namespace dist2d
+{
+
+
+// Roberts' R2 sequence, the two dimensional additive recurrence based on the plastic number g:
+//
+//     x_n = frac(1/2 + n / g)
+//     y_n = frac(1/2 + n / g^2)
+//
+// the recurrence is evaluated in 32b fixed point, so it is exact and costs two integer multiply-adds
+// operator()(n) returns the nth point as a pair of integers which the (urn1, urn2) overloads
+// of the distributions map to the point's coordinates in [0,1)^2
+class r2_sequence
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    // offset is added to every point modulo 1, i.e., a Cranley-Patterson rotation
+    constexpr explicit r2_sequence(result_type offset = result_type{0x80000000u, 0x80000000u})
+      : offset_(offset)
+    {}
+
+    constexpr result_type operator()(std::uint32_t n) const
+    {
+      // 2^32 / g and 2^32 / g^2, rounded to the nearest integer
+      const std::uint32_t alpha1 = 0xc13fa9a9u;
+      const std::uint32_t alpha2 = 0x91e10da6u;
+
+      return result_type{
+        offset_.first  + alpha1 * n,
+        offset_.second + alpha2 * n
+      };
+    }
+
+  private:
+    result_type offset_;
+};
+
+
+} // end dist2d
+
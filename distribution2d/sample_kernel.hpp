@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+template<class Distribution, class PointSet>
+constexpr typename Distribution::result_type sample_kernel_point(const Distribution& dist, const PointSet& points, std::uint32_t i)
+{
+  auto urns = points(i);
+  return dist(urns.first, urns.second);
+}
+
+
+template<class Distribution, class PointSet, std::size_t... I>
+constexpr std::array<typename Distribution::result_type, sizeof...(I)>
+  make_sample_kernel(const Distribution& dist, const PointSet& points, std::index_sequence<I...>)
+{
+  return {{sample_kernel_point(dist, points, static_cast<std::uint32_t>(I))...}};
+}
+
+
+} // end detail
+
+
+// returns the N points dist(points(0)), ..., dist(points(N - 1)) as a std::array,
+// where points is a sequence or a sample set, such as r2_sequence or correlated_multi_jittered_sample_set
+//
+// the (urn1, urn2) overloads of the distributions and the operator()s of the sequences and sample sets are constexpr,
+// so small fixed kernels may be computed at compile time and stored in the binary, e.g.
+//
+//     constexpr auto blur_taps = make_sample_kernel<16>(concentric_unit_disk_distribution<>(), sobol_sequence());
+//     constexpr auto ao_directions = make_sample_kernel<64>(cosine_weighted_unit_hemisphere_distribution<>(), r2_sequence());
+//
+// see detail/constexpr_math.hpp for how the results of compile time evaluation may differ from those at run time
+template<std::size_t N, class Distribution, class PointSet>
+constexpr std::array<typename Distribution::result_type, N> make_sample_kernel(const Distribution& dist, const PointSet& points)
+{
+  return detail::make_sample_kernel(dist, points, std::make_index_sequence<N>());
+}
+
+
+} // end dist2d
+
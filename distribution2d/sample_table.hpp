@@ -0,0 +1,489 @@
+#pragma once
+
+#include "execution.hpp"
+#include "counter_based_generator.hpp"
+#include "detail/parallel_for.hpp"
+#include "detail/mapped_file.hpp"
+#include "detail/half.hpp"
+#include "detail/unorm16.hpp"
+#include "detail/coordinate.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dist2d
+{
+
+
+// how the coordinates of a sample_table are stored
+enum class sample_encoding : std::uint32_t
+{
+  float32 = 0,
+  float16 = 1,
+
+  // 16b fixed point between the minimum and maximum of each coordinate over the table
+  unorm16 = 2
+};
+
+
+namespace detail
+{
+
+
+// the layout of a sample table file, version 1:
+//
+//     sample_table_header    128 bytes
+//     coordinate 0           count elements, at offsets[0]
+//     coordinate 1           count elements, at offsets[1]
+//     [coordinate 2]         count elements, at offsets[2]
+//
+// each coordinate array begins at a multiple of 64 bytes, so a mapped table can be read with aligned vector loads
+// all values are little endian
+struct sample_table_header
+{
+  char          magic[8];
+  std::uint32_t version;
+  std::uint32_t encoding;
+  std::uint32_t dimension;
+  std::uint32_t reserved;
+  std::uint64_t count;
+  std::uint64_t seed;
+  std::uint64_t offsets[3];
+
+  // for unorm16, coordinate i of sample k is minimum[i] + (maximum[i] - minimum[i]) * q / 65535
+  float         minimum[3];
+  float         maximum[3];
+
+  char          description[40];
+};
+
+static_assert(sizeof(sample_table_header) == 128, "sample_table_header must be 128 bytes");
+
+
+constexpr char sample_table_magic[8] = {'D','I','S','T','2','D','S','T'};
+constexpr std::uint32_t sample_table_version = 1;
+constexpr std::size_t sample_table_alignment = 64;
+
+
+inline bool is_little_endian()
+{
+  std::uint32_t one = 1;
+  unsigned char first_byte;
+  std::memcpy(&first_byte, &one, 1);
+  return first_byte == 1;
+}
+
+
+inline std::size_t sample_encoding_size(sample_encoding encoding)
+{
+  return encoding == sample_encoding::float32 ? 4 : 2;
+}
+
+
+template<class Point, std::size_t... I>
+void store_coordinates(const Point& p, float* coordinates, std::index_sequence<I...>)
+{
+  int unused[] = {(coordinates[I] = static_cast<float>(detail::coordinate<I>(p)), 0)...};
+  (void)unused;
+}
+
+
+// dist(i) for an integer from a point source, such as a Morton index
+template<class Distribution, class Integer>
+typename std::enable_if<
+  std::is_integral<Integer>::value,
+  typename Distribution::result_type
+>::type
+  sample_point(const Distribution& dist, Integer i)
+{
+  return dist(i);
+}
+
+
+// dist(urn1, urn2) for a pair of urns from a point source, such as a sample set or sequence
+template<class Distribution, class Urn1, class Urn2>
+typename Distribution::result_type sample_point(const Distribution& dist, const std::pair<Urn1,Urn2>& urns)
+{
+  return dist(urns.first, urns.second);
+}
+
+
+// the seed recorded in a table's header: source.seed() if the point source has one, and 0 otherwise
+template<class PointSource>
+auto point_source_seed(const PointSource& source, int) -> decltype(std::uint64_t(source.seed()))
+{
+  return std::uint64_t(source.seed());
+}
+
+template<class PointSource>
+std::uint64_t point_source_seed(const PointSource&, long)
+{
+  return 0;
+}
+
+
+// the number of points of a finite point source, such as a sample set, and the maximum of std::uint64_t otherwise
+template<class PointSource>
+auto point_source_size(const PointSource& source, int) -> decltype(std::uint64_t(source.size()))
+{
+  return std::uint64_t(source.size());
+}
+
+template<class PointSource>
+std::uint64_t point_source_size(const PointSource&, long)
+{
+  return std::numeric_limits<std::uint64_t>::max();
+}
+
+
+} // end detail
+
+
+// the point sources of bake_sample_table
+// besides these, any sample set or sequence, e.g. correlated_multi_jittered_sample_set or owen_scrambled_sobol_sequence,
+// is a point source whose points are pairs of urns
+
+
+// the consecutive indices first, first + 1, ..., so that sample k of a table is dist(first + k),
+// and the table is indexed like the distribution's operator()(Integer i)
+class index_range
+{
+  public:
+    constexpr explicit index_range(std::uint64_t first = 0)
+      : first_(first)
+    {}
+
+    constexpr std::uint64_t operator()(std::uint64_t k) const
+    {
+      return first_ + k;
+    }
+
+  private:
+    std::uint64_t first_;
+};
+
+
+// independent random points: sample k of a table is dist(counter_based_generator<>(seed)(stream, k)),
+// the same as parallel_generate's, so a table can be replaced by computing its samples when it is absent
+class random_indices
+{
+  public:
+    explicit random_indices(std::uint64_t seed = 0, std::uint64_t stream = 0)
+      : generator_(seed), stream_(stream)
+    {}
+
+    std::uint64_t seed() const
+    {
+      return generator_.seed();
+    }
+
+    std::uint64_t operator()(std::uint64_t k) const
+    {
+      return generator_(stream_, k);
+    }
+
+  private:
+    counter_based_generator<> generator_;
+    std::uint64_t stream_;
+};
+
+
+// bakes count samples of dist into the sample table file at path
+// sample k is dist(source(k)), or dist(source(k).first, source(k).second) when source(k) is a pair of urns,
+// so a table may hold a stratified sample set, a sequence, the Morton order of operator()(Integer i), or random points
+// count must not exceed source.size() when the source has a size
+// the table's header records source.seed() when the source has a seed
+// the samples are computed and written in blocks, so tables larger than memory may be baked
+template<class Distribution, class PointSource, class ExecutionPolicy = execution::parallel_policy>
+void bake_sample_table(const std::string& path,
+                       const Distribution& dist,
+                       const PointSource& source,
+                       std::uint64_t count,
+                       sample_encoding encoding,
+                       const ExecutionPolicy& policy = execution::par,
+                       const std::string& description = "")
+{
+  using point = typename Distribution::result_type;
+  constexpr std::size_t dimension = std::tuple_size<point>::value;
+
+  static_assert(dimension == 2 || dimension == 3, "bake_sample_table: the distribution's points must have 2 or 3 coordinates");
+
+  if(!detail::is_little_endian())
+  {
+    throw std::runtime_error("bake_sample_table: sample tables are only supported on little endian machines");
+  }
+
+  if(count > detail::point_source_size(source, 0))
+  {
+    throw std::invalid_argument("bake_sample_table: count exceeds the number of points of the source");
+  }
+
+  const std::size_t block_size = std::size_t(1) << 20;
+  const std::size_t grain_size = 1 << 14;
+
+  // computes the coordinates of samples [first, first + n) into buffer
+  auto compute_block = [&](std::uint64_t first, std::size_t n, std::vector<float>& buffer)
+  {
+    buffer.resize(n * dimension);
+    detail::parallel_for(policy, n, grain_size, [&](std::size_t begin, std::size_t end)
+    {
+      for(std::size_t k = begin; k < end; ++k)
+      {
+        detail::store_coordinates(detail::sample_point(dist, source(first + k)), &buffer[k * dimension], std::make_index_sequence<dimension>());
+      }
+    });
+  };
+
+  detail::sample_table_header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, detail::sample_table_magic, sizeof(header.magic));
+  header.version = detail::sample_table_version;
+  header.encoding = static_cast<std::uint32_t>(encoding);
+  header.dimension = static_cast<std::uint32_t>(dimension);
+  header.count = count;
+  header.seed = detail::point_source_seed(source, 0);
+  std::strncpy(header.description, description.c_str(), sizeof(header.description) - 1);
+
+  const std::size_t element_size = detail::sample_encoding_size(encoding);
+  std::uint64_t offset = sizeof(header);
+  for(std::size_t i = 0; i < dimension; ++i)
+  {
+    offset = (offset + detail::sample_table_alignment - 1) / detail::sample_table_alignment * detail::sample_table_alignment;
+    header.offsets[i] = offset;
+    offset += count * element_size;
+  }
+
+  std::vector<float> buffer;
+
+  // unorm16 needs the range of each coordinate before it can encode any of them
+  for(std::size_t i = 0; i < dimension; ++i)
+  {
+    header.minimum[i] = std::numeric_limits<float>::max();
+    header.maximum[i] = std::numeric_limits<float>::lowest();
+  }
+
+  if(encoding == sample_encoding::unorm16)
+  {
+    for(std::uint64_t first = 0; first < count; first += block_size)
+    {
+      std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(block_size, count - first));
+      compute_block(first, n, buffer);
+
+      for(std::size_t k = 0; k < n; ++k)
+      {
+        for(std::size_t i = 0; i < dimension; ++i)
+        {
+          header.minimum[i] = std::min(header.minimum[i], buffer[k * dimension + i]);
+          header.maximum[i] = std::max(header.maximum[i], buffer[k * dimension + i]);
+        }
+      }
+    }
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if(!file) throw std::runtime_error("bake_sample_table: couldn't open " + path);
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::vector<char> encoded;
+  for(std::uint64_t first = 0; first < count; first += block_size)
+  {
+    std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(block_size, count - first));
+    compute_block(first, n, buffer);
+
+    encoded.resize(n * element_size);
+    for(std::size_t i = 0; i < dimension; ++i)
+    {
+      for(std::size_t k = 0; k < n; ++k)
+      {
+        float x = buffer[k * dimension + i];
+
+        switch(encoding)
+        {
+          case sample_encoding::float32:
+          {
+            std::memcpy(&encoded[4 * k], &x, 4);
+            break;
+          }
+
+          case sample_encoding::float16:
+          {
+            std::uint16_t h = detail::float_to_half(x);
+            std::memcpy(&encoded[2 * k], &h, 2);
+            break;
+          }
+
+          case sample_encoding::unorm16:
+          {
+            std::uint16_t q = detail::encode_unorm16(x, header.minimum[i], header.maximum[i]);
+            std::memcpy(&encoded[2 * k], &q, 2);
+            break;
+          }
+        }
+      }
+
+      file.seekp(static_cast<std::streamoff>(header.offsets[i] + first * element_size));
+      file.write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+    }
+  }
+
+  file.flush();
+
+  if(!file) throw std::runtime_error("bake_sample_table: couldn't write " + path);
+}
+
+
+// a table of samples baked by bake_sample_table, mapped into memory without copying
+// operator()(i) returns sample i, which equals dist(source(i)) of the distribution and point source the table was baked from,
+// to within the precision of the table's encoding
+template<class Point = std::pair<float,float>>
+class sample_table
+{
+  public:
+    using result_type = Point;
+
+  private:
+    static constexpr std::size_t dimension = std::tuple_size<result_type>::value;
+
+  public:
+    explicit sample_table(const std::string& path)
+      : file_(path)
+    {
+      if(file_.size() < sizeof(detail::sample_table_header))
+      {
+        throw std::runtime_error("sample_table: " + path + " is too small to be a sample table");
+      }
+
+      std::memcpy(&header_, file_.data(), sizeof(header_));
+
+      if(std::memcmp(header_.magic, detail::sample_table_magic, sizeof(header_.magic)) != 0)
+      {
+        throw std::runtime_error("sample_table: " + path + " is not a sample table");
+      }
+
+      if(header_.version != detail::sample_table_version)
+      {
+        throw std::runtime_error("sample_table: " + path + " has unsupported version " + std::to_string(header_.version));
+      }
+
+      if(header_.dimension != dimension)
+      {
+        throw std::runtime_error("sample_table: " + path + " has " + std::to_string(header_.dimension) + " coordinates per sample");
+      }
+
+      if(header_.encoding > static_cast<std::uint32_t>(sample_encoding::unorm16))
+      {
+        throw std::runtime_error("sample_table: " + path + " has an unknown encoding");
+      }
+
+      if(!detail::is_little_endian())
+      {
+        throw std::runtime_error("sample_table: sample tables are only supported on little endian machines");
+      }
+
+      // compare count with the elements which fit after each offset, so that no crafted count or offset can overflow
+      const std::size_t element_size = detail::sample_encoding_size(encoding());
+      for(std::size_t i = 0; i < dimension; ++i)
+      {
+        if(header_.offsets[i] > file_.size() || header_.count > (file_.size() - header_.offsets[i]) / element_size)
+        {
+          throw std::runtime_error("sample_table: " + path + " is truncated");
+        }
+      }
+    }
+
+    std::size_t size() const
+    {
+      return static_cast<std::size_t>(header_.count);
+    }
+
+    // the seed of the point source the table was baked from, or 0 if it had none
+    std::uint64_t seed() const
+    {
+      return header_.seed;
+    }
+
+    sample_encoding encoding() const
+    {
+      return static_cast<sample_encoding>(header_.encoding);
+    }
+
+    std::string description() const
+    {
+      return std::string(header_.description, description_length(header_.description, sizeof(header_.description)));
+    }
+
+    // returns the array of coordinate i of every sample, encoded as encoding()
+    // for float32 this is a const float*, otherwise a const std::uint16_t*
+    const void* data(std::size_t i) const
+    {
+      return file_.data() + header_.offsets[i];
+    }
+
+    // i must be less than size()
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    result_type operator()(Integer i) const
+    {
+      return make_point(static_cast<std::size_t>(i), std::make_index_sequence<dimension>());
+    }
+
+  private:
+    template<std::size_t... I>
+    result_type make_point(std::size_t k, std::index_sequence<I...>) const
+    {
+      return result_type{static_cast<typename std::tuple_element<I,result_type>::type>(coordinate(I, k))...};
+    }
+
+    float coordinate(std::size_t i, std::size_t k) const
+    {
+      const unsigned char* ptr = file_.data() + header_.offsets[i];
+
+      switch(encoding())
+      {
+        case sample_encoding::float16:
+        {
+          std::uint16_t h;
+          std::memcpy(&h, ptr + 2 * k, 2);
+          return detail::half_to_float(h);
+        }
+
+        case sample_encoding::unorm16:
+        {
+          std::uint16_t q;
+          std::memcpy(&q, ptr + 2 * k, 2);
+          return detail::decode_unorm16(q, header_.minimum[i], header_.maximum[i]);
+        }
+
+        default:
+        {
+          float result;
+          std::memcpy(&result, ptr + 4 * k, 4);
+          return result;
+        }
+      }
+    }
+
+    static std::size_t description_length(const char* s, std::size_t n)
+    {
+      return std::find(s, s + n, '\0') - s;
+    }
+
+    detail::mapped_file file_;
+    detail::sample_table_header header_;
+};
+
+
+} // end dist2d
+
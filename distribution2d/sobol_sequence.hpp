@@ -0,0 +1,118 @@
+#pragma once
+
+#include "detail/bits.hpp"
+#include <cstdint>
+#include <utility>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// the first dimension of the Sobol sequence is the van der Corput sequence
+constexpr std::uint32_t sobol_dimension0(std::uint32_t n)
+{
+  return reverse_bits(n);
+}
+
+
+// the second dimension of the Sobol sequence
+// its primitive polynomial is x + 1, whose direction numbers are v_0 = 2^31 and v_k = v_{k-1} ^ (v_{k-1} >> 1)
+constexpr std::uint32_t sobol_dimension1(std::uint32_t n)
+{
+  std::uint32_t result = 0;
+
+  for(std::uint32_t v = 1u << 31; n; n >>= 1, v ^= v >> 1)
+  {
+    if(n & 1) result ^= v;
+  }
+
+  return result;
+}
+
+
+// see Burley, "Practical Hash-based Owen Scrambling", 2020
+constexpr std::uint32_t laine_karras_permutation(std::uint32_t x, std::uint32_t seed)
+{
+  x += seed;
+  x ^= x * 0x6c50b47cu;
+  x ^= x * 0xb82f1e52u;
+  x ^= x * 0xc7afe638u;
+  x ^= x * 0x8d22f6e6u;
+  return x;
+}
+
+
+constexpr std::uint32_t nested_uniform_scramble(std::uint32_t x, std::uint32_t seed)
+{
+  return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+}
+
+
+} // end detail
+
+
+// the first two dimensions of the Sobol (0,2)-sequence
+// operator()(n) returns the nth point as a pair of integers which the (urn1, urn2) overloads
+// of the distributions map to the point's coordinates in [0,1)^2:
+//
+//     sobol_sequence sobol;
+//     auto urns = sobol(i);
+//     auto p = dist(urns.first, urns.second);
+//
+// every power of two prefix of the sequence is stratified in each elementary interval of [0,1)^2
+class sobol_sequence
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    constexpr result_type operator()(std::uint32_t n) const
+    {
+      return result_type{
+        detail::sobol_dimension0(n),
+        detail::sobol_dimension1(n)
+      };
+    }
+};
+
+
+// the Sobol sequence randomized with Owen's nested uniform scrambling
+// each seed yields an independent realization which retains the stratification of the sequence,
+// so, for example, seeding with a hash of the pixel decorrelates the samples of neighboring pixels
+// the order of the points is also shuffled, so that prefixes of the sequence remain well distributed
+class owen_scrambled_sobol_sequence
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    constexpr explicit owen_scrambled_sobol_sequence(std::uint32_t seed = 0)
+      : seed_(seed)
+    {}
+
+    constexpr std::uint32_t seed() const
+    {
+      return seed_;
+    }
+
+    // as in Burley's shuffled_scrambled_sobol4d, dimension d is scrambled with hash_combine(seed, hash(d))
+    // the index is shuffled with a seed hashed as if it were a third dimension, so that the shuffle is independent
+    // of both coordinates' scrambles, even for seed 0
+    // the shuffle maps each power of two prefix to an aligned block of the sequence, so prefixes remain (0,m,2)-nets
+    constexpr result_type operator()(std::uint32_t n) const
+    {
+      std::uint32_t i = detail::nested_uniform_scramble(n, detail::hash_combine(seed_, detail::hash(2)));
+
+      std::uint32_t x = detail::nested_uniform_scramble(detail::sobol_dimension0(i), detail::hash_combine(seed_, detail::hash(0)));
+      std::uint32_t y = detail::nested_uniform_scramble(detail::sobol_dimension1(i), detail::hash_combine(seed_, detail::hash(1)));
+
+      return result_type{x, y};
+    }
+
+  private:
+    std::uint32_t seed_;
+};
+
+
+} // end dist2d
+
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "unit_square_distribution.hpp"
+#include "detail/simd.hpp"
+#include "detail/vector3.hpp"
+#include "detail/math_constants.hpp"
+#include "detail/coordinate.hpp"
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace dist2d
+{
+
+
+// a uniform distribution of the directions, i.e. points on the unit sphere, from an origin toward a rectangle,
+// such as a quad light seen from a shading point
+// its density is with respect to solid angle, so a light sampled this way needs no 1/r^2 or cosine conversion
+//
+// operator() is the area-preserving mapping of Urena et al.: u1 chooses the x of the sub-rectangle [x0, x] x [y0, y1]
+// which subtends u1 * area(), and u2 chooses the y on that line uniformly in y / sqrt(x^2 + y^2 + z0^2)
+// see Urena, Fajardo & King, An Area-Preserving Parametrization for Spherical Rectangles, EGSR 2013
+// it is continuous and area preserving, so stratified points stay stratified, and inverse() undoes it
+//
+// the rectangle's geometry is precomputed in double, and each point is warped in double and rounded
+template<class Point = std::tuple<float,float,float>>
+class spherical_rectangle_distribution
+{
+  public:
+    using result_type = Point;
+
+  private:
+    using real_type1 = typename std::tuple_element<0,result_type>::type;
+    using real_type2 = typename std::tuple_element<1,result_type>::type;
+    using real_type3 = typename std::tuple_element<2,result_type>::type;
+
+  public:
+    using real_type = typename std::common_type<real_type1, real_type2, real_type3>::type;
+
+  private:
+    using compute_type = typename std::common_type<real_type, double>::type;
+    using vector = detail::vector3<compute_type>;
+
+  public:
+    // the rectangle with the corner s and the perpendicular edges ex and ey, seen from origin
+    // throws std::invalid_argument if ex and ey aren't perpendicular, i.e. they form a parallelogram, whose
+    // sub-rectangles the mapping would misplace
+    spherical_rectangle_distribution(const result_type& origin, const result_type& s, const result_type& ex, const result_type& ey)
+    {
+      vector o = detail::to_vector3<compute_type>(origin);
+      vector corner = detail::to_vector3<compute_type>(s);
+      vector edge_x = detail::to_vector3<compute_type>(ex);
+      vector edge_y = detail::to_vector3<compute_type>(ey);
+
+      // the rectangle's local frame, whose z points away from it toward origin
+      x_ = detail::normalize(edge_x);
+      y_ = detail::normalize(edge_y);
+
+      if(!(std::fabs(dot(x_, y_)) <= detail::surface_tolerance<real_type>()))
+      {
+        throw std::invalid_argument("spherical_rectangle_distribution: the edges must be perpendicular");
+      }
+
+      z_ = cross(x_, y_);
+
+      vector d = corner - o;
+      z0_ = dot(d, z_);
+      if(z0_ > 0)
+      {
+        z_ = -z_;
+        z0_ = -z0_;
+      }
+
+      x0_ = dot(d, x_);
+      y0_ = dot(d, y_);
+      x1_ = x0_ + detail::length(edge_x);
+      y1_ = y0_ + detail::length(edge_y);
+
+      // the inward normals of the planes through origin and each edge
+      vector n0 = edge_normal(x0_, y0_, x1_, y0_);
+      vector n1 = edge_normal(x1_, y0_, x1_, y1_);
+      vector n2 = edge_normal(x1_, y1_, x0_, y1_);
+      vector n3 = edge_normal(x0_, y1_, x0_, y0_);
+
+      // the internal angles of the spherical rectangle
+      compute_type g0 = angle(n0, n1);
+      compute_type g1 = angle(n1, n2);
+      compute_type g2 = angle(n2, n3);
+      compute_type g3 = angle(n3, n0);
+
+      n0_ = n0;
+      n2_ = n2;
+      b0_ = n0.z;
+      b1_ = n2.z;
+      k_ = 2 * pi - g2 - g3;
+      area_ = g0 + g1 - k_;
+
+      if(!(area_ > 0) || !(z0_ < 0))
+      {
+        throw std::invalid_argument("spherical_rectangle_distribution: the rectangle must subtend a positive solid angle");
+      }
+    }
+
+    // maps (u1, u2) in [0,1)^2 to the point (x, y, z) of the spherical rectangle
+    void warp(real_type u1, real_type u2, real_type1& x, real_type2& y, real_type3& z) const
+    {
+      // the x of the sub-rectangle which subtends u1 * area()
+      compute_type au = compute_type(u1) * area_ + k_;
+      compute_type fu = (std::cos(au) * b0_ - b1_) / std::sin(au);
+      compute_type cu = (fu > 0 ? 1 : -1) / std::sqrt(fu * fu + b0_ * b0_);
+      cu = std::max(compute_type(-1), std::min(cu, compute_type(1)));
+
+      compute_type xu = -(cu * z0_) / std::sqrt(std::max(compute_type(0), 1 - cu * cu));
+      xu = std::max(x0_, std::min(xu, x1_));
+
+      // the y on the line at xu
+      compute_type d = std::sqrt(xu * xu + z0_ * z0_);
+      compute_type h0 = y0_ / std::sqrt(d * d + y0_ * y0_);
+      compute_type h1 = y1_ / std::sqrt(d * d + y1_ * y1_);
+      compute_type hv = h0 + compute_type(u2) * (h1 - h0);
+      compute_type hv2 = hv * hv;
+      compute_type yv = hv2 < 1 - std::numeric_limits<compute_type>::epsilon() ? (hv * d) / std::sqrt(1 - hv2) : y1_;
+
+      vector p = detail::normalize(xu * x_ + yv * y_ + z0_ * z_);
+
+      x = real_type1(p.x);
+      y = real_type2(p.y);
+      z = real_type3(p.z);
+    }
+
+    // the inverse of warp: maps the point (x, y, z) of the spherical rectangle to (u1, u2) in [0,1)^2
+    void inverse_warp(real_type1 x, real_type2 y, real_type3 z, real_type& u1, real_type& u2) const
+    {
+      vector p{compute_type(x), compute_type(y), compute_type(z)};
+
+      // the point where the direction meets the rectangle's plane
+      compute_type t = z0_ / dot(p, z_);
+      compute_type xu = std::max(x0_, std::min(t * dot(p, x_), x1_));
+      compute_type yv = std::max(y0_, std::min(t * dot(p, y_), y1_));
+
+      // the solid angle of the sub-rectangle [x0, xu] x [y0, y1], whose angles at the edge x = x0 are unchanged
+      vector n1 = edge_normal(xu, y0_, xu, y1_);
+      compute_type sub_area = xu > x0_ ? angle(n0_, n1) + angle(n1, n2_) - k_ : 0;
+
+      compute_type d = std::sqrt(xu * xu + z0_ * z0_);
+      compute_type h0 = y0_ / std::sqrt(d * d + y0_ * y0_);
+      compute_type h1 = y1_ / std::sqrt(d * d + y1_ * y1_);
+      compute_type hv = yv / std::sqrt(d * d + yv * yv);
+
+      u1 = detail::clamp_to_unit_interval(real_type(sub_area / area_));
+      u2 = detail::clamp_to_unit_interval(real_type((hv - h0) / (h1 - h0)));
+    }
+
+    template<class Float1, class Float2,
+             class = typename std::enable_if<
+               std::is_floating_point<Float1>::value &&
+               std::is_floating_point<Float2>::value
+             >::type>
+    result_type operator()(Float1 u1, Float2 u2) const
+    {
+      real_type1 x;
+      real_type2 y;
+      real_type3 z;
+      warp(real_type(u1), real_type(u2), x, y, z);
+
+      return result_type{x, y, z};
+    }
+
+    template<class Integer1, class Integer2>
+    typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 urn1, Integer2 urn2) const
+    {
+      real_type u1 = unit_interval_distribution<real_type>()(urn1);
+      real_type u2 = unit_interval_distribution<real_type>()(urn2);
+
+      return operator()(u1, u2);
+    }
+
+    // returns operator()(u1, u2) with its density, 1 / area()
+    template<class Float1, class Float2>
+    typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      return std::make_pair(operator()(u1, u2), real_type(1) / area());
+    }
+
+    template<class Integer1, class Integer2>
+    typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      return std::make_pair(operator()(urn1, urn2), real_type(1) / area());
+    }
+
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    result_type operator()(Integer i) const
+    {
+      auto xy = morton_urns(i);
+      return operator()(xy.first, xy.second);
+    }
+
+    template<class Generator,
+             class = typename std::enable_if<
+               detail::is_integral_generator<Generator>::value
+             >::type>
+    result_type operator()(Generator& g) const
+    {
+      auto u = detail::unit_square_from_generator<real_type,real_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs, ys, and zs
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          real_type u1 = unit_interval_distribution<real_type>()(urn1s[k]);
+          real_type u2 = unit_interval_distribution<real_type>()(urn2s[k]);
+
+          warp(u1, u2, xs[i + k], ys[i + k], zs[i + k]);
+        }
+      }
+    }
+
+    // maps the point p back to the (u1, u2) in [0,1)^2 which operator() maps to it
+    std::pair<real_type,real_type> inverse(const result_type& p) const
+    {
+      real_type u1, u2;
+      inverse_warp(detail::coordinate<0>(p), detail::coordinate<1>(p), detail::coordinate<2>(p), u1, u2);
+
+      return std::make_pair(u1, u2);
+    }
+
+    // stores the inverse of each of the points (xs[i], ys[i], zs[i]) to (u1s[i], u2s[i])
+    void inverse(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* u1s, real_type* u2s) const
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        inverse_warp(xs[i], ys[i], zs[i], u1s[i], u2s[i]);
+      }
+    }
+
+    // the point must lie on the unit sphere, as unit_sphere_distribution::contains tests it, and its ray from origin must hit the rectangle
+    bool contains(const result_type& p) const
+    {
+      vector v = detail::to_vector3<compute_type>(p);
+
+      compute_type vz = dot(v, z_);
+      if(!(std::fabs(1 - dot(v, v)) < detail::surface_tolerance<real_type>()) || !(vz < 0)) return false;
+
+      compute_type t = z0_ / vz;
+      compute_type xu = t * dot(v, x_);
+      compute_type yv = t * dot(v, y_);
+
+      return x0_ <= xu && xu <= x1_ && y0_ <= yv && yv <= y1_;
+    }
+
+    // stores contains((xs[i], ys[i], zs[i])) to mask[i] for each of the count points
+    void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask) const
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i], zs[i]});
+      }
+    }
+
+    // if !contains(p) the result is undefined
+    real_type probability_density(const result_type&) const
+    {
+      return real_type(1) / area();
+    }
+
+    // stores the density at each of the count points (xs[i], ys[i], zs[i]) to pdfs[i], or 0 where the point is not contained
+    void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* pdfs) const
+    {
+      const real_type density = real_type(1) / area();
+
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, zs + i, mask);
+
+        detail::simd::select_density(mask, n, density, pdfs + i);
+      }
+    }
+
+    // the solid angle of the rectangle
+    real_type area() const
+    {
+      return real_type(area_);
+    }
+
+  private:
+    static constexpr compute_type pi = detail::math_constants::pi;
+
+    // the normal of the plane through origin and the edge from (xa, ya, z0) to (xb, yb, z0) in the local frame
+    vector edge_normal(compute_type xa, compute_type ya, compute_type xb, compute_type yb) const
+    {
+      return detail::normalize(cross(vector{xa, ya, z0_}, vector{xb, yb, z0_}));
+    }
+
+    // the internal angle between the planes with the normals n and m
+    static compute_type angle(const vector& n, const vector& m)
+    {
+      return std::acos(std::max(compute_type(-1), std::min(-dot(n, m), compute_type(1))));
+    }
+
+    vector x_, y_, z_;
+    compute_type x0_, y0_, x1_, y1_, z0_;
+    vector n0_, n2_;
+    compute_type b0_, b1_, k_;
+    compute_type area_;
+};
+
+
+} // end dist2d
+
@@ -0,0 +1,311 @@
+#pragma once
+
+#include "unit_square_distribution.hpp"
+#include "detail/simd.hpp"
+#include "detail/vector3.hpp"
+#include "detail/math_constants.hpp"
+#include "detail/coordinate.hpp"
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace dist2d
+{
+
+
+// a uniform distribution of directions, i.e. points on the unit sphere, within a spherical triangle,
+// such as the directions from a shading point toward a triangular light
+// its density is with respect to solid angle, so a light sampled this way needs no 1/r^2 or cosine conversion
+//
+// operator() is Arvo's area-preserving mapping: u1 chooses the sub-triangle a b c' with area u1 * area(),
+// and u2 chooses the point on the arc from b to c' by its cosine to b
+// see Arvo, Stratified Sampling of Spherical Triangles, SIGGRAPH 1995
+// it is continuous and area preserving, so stratified points stay stratified, and inverse() undoes it
+//
+// the triangle's geometry is precomputed in double, and each point is warped in double and rounded,
+// because the mapping loses precision for small triangles
+template<class Point = std::tuple<float,float,float>>
+class spherical_triangle_distribution
+{
+  public:
+    using result_type = Point;
+
+  private:
+    using real_type1 = typename std::tuple_element<0,result_type>::type;
+    using real_type2 = typename std::tuple_element<1,result_type>::type;
+    using real_type3 = typename std::tuple_element<2,result_type>::type;
+
+  public:
+    using real_type = typename std::common_type<real_type1, real_type2, real_type3>::type;
+
+  private:
+    using compute_type = typename std::common_type<real_type, double>::type;
+    using vector = detail::vector3<compute_type>;
+
+  public:
+    // the spherical triangle with the vertices a, b, and c, which are normalized
+    spherical_triangle_distribution(const result_type& a, const result_type& b, const result_type& c)
+      : a_(detail::normalize(detail::to_vector3<compute_type>(a))),
+        b_(detail::normalize(detail::to_vector3<compute_type>(b))),
+        c_(detail::normalize(detail::to_vector3<compute_type>(c)))
+    {
+      area_ = detail::spherical_triangle_area(a_, b_, c_);
+
+      if(!(area_ > 0))
+      {
+        throw std::invalid_argument("spherical_triangle_distribution: the triangle must subtend a positive solid angle");
+      }
+
+      // the inward normals of the edges' great circles
+      compute_type orientation = dot(a_, cross(b_, c_)) < 0 ? -1 : 1;
+      n_ab_ = orientation * cross(a_, b_);
+      n_bc_ = orientation * cross(b_, c_);
+      n_ca_ = orientation * cross(c_, a_);
+
+      // the angle at a between the arcs to b and c
+      vector n_ab = detail::normalize(cross(a_, b_));
+      vector n_ac = detail::normalize(cross(a_, c_));
+      compute_type alpha = std::atan2(detail::length(cross(n_ab, n_ac)), dot(n_ab, n_ac));
+
+      alpha_ = alpha;
+      cos_alpha_ = std::cos(alpha);
+      sin_alpha_ = std::sin(alpha);
+      cos_c_ = dot(a_, b_);
+
+      // the unit vector perpendicular to a in the plane of a & c, toward c
+      c_perp_ = detail::normalize(c_ - dot(c_, a_) * a_);
+    }
+
+    // the spherical triangle which the triangle v0 v1 v2 subtends when seen from origin
+    spherical_triangle_distribution(const result_type& origin, const result_type& v0, const result_type& v1, const result_type& v2)
+      : spherical_triangle_distribution(difference(v0, origin), difference(v1, origin), difference(v2, origin))
+    {}
+
+    // maps (u1, u2) in [0,1)^2 to the point (x, y, z) of the triangle
+    void warp(real_type u1, real_type u2, real_type1& x, real_type2& y, real_type3& z) const
+    {
+      // the vertex c' of the sub-triangle a b c' with area u1 * area()
+      compute_type s = std::sin(compute_type(u1) * area_ - alpha_);
+      compute_type t = std::cos(compute_type(u1) * area_ - alpha_);
+      compute_type u = t - cos_alpha_;
+      compute_type v = s + sin_alpha_ * cos_c_;
+      compute_type q = ((v * t - u * s) * cos_alpha_ - v) / ((v * s + u * t) * sin_alpha_);
+      q = std::max(compute_type(-1), std::min(q, compute_type(1)));
+
+      vector c_hat = q * a_ + std::sqrt(std::max(compute_type(0), 1 - q * q)) * c_perp_;
+
+      // the point on the arc from b to c'
+      compute_type cos_theta = 1 - compute_type(u2) * (1 - dot(c_hat, b_));
+      vector p = cos_theta * b_ + std::sqrt(std::max(compute_type(0), 1 - cos_theta * cos_theta)) * detail::normalize(c_hat - dot(c_hat, b_) * b_);
+
+      x = real_type1(p.x);
+      y = real_type2(p.y);
+      z = real_type3(p.z);
+    }
+
+    // the inverse of warp: maps the point (x, y, z) of the triangle to (u1, u2) in [0,1)^2
+    void inverse_warp(real_type1 x, real_type2 y, real_type3 z, real_type& u1, real_type& u2) const
+    {
+      vector p = detail::normalize(vector{compute_type(x), compute_type(y), compute_type(z)});
+
+      // c' is where the great circle through b and p meets the arc from a to c
+      vector b_cross_p = cross(b_, p);
+      vector c_hat = detail::normalize(cross(b_cross_p, cross(a_, c_)));
+      if(dot(c_hat, a_ + c_) < 0) c_hat = -c_hat;
+
+      // every u1 maps u2 = 0 to b, where the great circle is undefined, as it is within the rounding of real_type
+      bool at_b = detail::length(b_cross_p) <= 4 * std::numeric_limits<real_type>::epsilon();
+      compute_type sub_area = at_b ? 0 : detail::spherical_triangle_area(a_, b_, c_hat);
+      compute_type denominator = 1 - dot(c_hat, b_);
+
+      u1 = detail::clamp_to_unit_interval(real_type(sub_area / area_));
+      u2 = detail::clamp_to_unit_interval(real_type(denominator > 0 ? (1 - dot(p, b_)) / denominator : 0));
+    }
+
+    template<class Float1, class Float2,
+             class = typename std::enable_if<
+               std::is_floating_point<Float1>::value &&
+               std::is_floating_point<Float2>::value
+             >::type>
+    result_type operator()(Float1 u1, Float2 u2) const
+    {
+      real_type1 x;
+      real_type2 y;
+      real_type3 z;
+      warp(real_type(u1), real_type(u2), x, y, z);
+
+      return result_type{x, y, z};
+    }
+
+    template<class Integer1, class Integer2>
+    typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 urn1, Integer2 urn2) const
+    {
+      real_type u1 = unit_interval_distribution<real_type>()(urn1);
+      real_type u2 = unit_interval_distribution<real_type>()(urn2);
+
+      return operator()(u1, u2);
+    }
+
+    // returns operator()(u1, u2) with its density, 1 / area()
+    template<class Float1, class Float2>
+    typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      return std::make_pair(operator()(u1, u2), real_type(1) / area());
+    }
+
+    template<class Integer1, class Integer2>
+    typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      return std::make_pair(operator()(urn1, urn2), real_type(1) / area());
+    }
+
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    result_type operator()(Integer i) const
+    {
+      auto xy = morton_urns(i);
+      return operator()(xy.first, xy.second);
+    }
+
+    template<class Generator,
+             class = typename std::enable_if<
+               detail::is_integral_generator<Generator>::value
+             >::type>
+    result_type operator()(Generator& g) const
+    {
+      auto u = detail::unit_square_from_generator<real_type,real_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs, ys, and zs
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          real_type u1 = unit_interval_distribution<real_type>()(urn1s[k]);
+          real_type u2 = unit_interval_distribution<real_type>()(urn2s[k]);
+
+          warp(u1, u2, xs[i + k], ys[i + k], zs[i + k]);
+        }
+      }
+    }
+
+    // maps the point p back to the (u1, u2) in [0,1)^2 which operator() maps to it
+    std::pair<real_type,real_type> inverse(const result_type& p) const
+    {
+      real_type u1, u2;
+      inverse_warp(detail::coordinate<0>(p), detail::coordinate<1>(p), detail::coordinate<2>(p), u1, u2);
+
+      return std::make_pair(u1, u2);
+    }
+
+    // stores the inverse of each of the points (xs[i], ys[i], zs[i]) to (u1s[i], u2s[i])
+    void inverse(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* u1s, real_type* u2s) const
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        inverse_warp(xs[i], ys[i], zs[i], u1s[i], u2s[i]);
+      }
+    }
+
+    // the point must lie on the unit sphere, as unit_sphere_distribution::contains tests it, and within the triangle's edges
+    bool contains(const result_type& p) const
+    {
+      vector v = detail::to_vector3<compute_type>(p);
+
+      return std::fabs(1 - dot(v, v)) < detail::surface_tolerance<real_type>() &&
+             dot(n_ab_, v) >= 0 &&
+             dot(n_bc_, v) >= 0 &&
+             dot(n_ca_, v) >= 0;
+    }
+
+    // stores contains((xs[i], ys[i], zs[i])) to mask[i] for each of the count points
+    void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask) const
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i], zs[i]});
+      }
+    }
+
+    // if !contains(p) the result is undefined
+    real_type probability_density(const result_type&) const
+    {
+      return real_type(1) / area();
+    }
+
+    // stores the density at each of the count points (xs[i], ys[i], zs[i]) to pdfs[i], or 0 where the point is not contained
+    void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* pdfs) const
+    {
+      const real_type density = real_type(1) / area();
+
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, zs + i, mask);
+
+        detail::simd::select_density(mask, n, density, pdfs + i);
+      }
+    }
+
+    // the solid angle of the triangle
+    real_type area() const
+    {
+      return real_type(area_);
+    }
+
+  private:
+    static result_type difference(const result_type& p, const result_type& q)
+    {
+      return result_type{
+        real_type1(detail::coordinate<0>(p) - detail::coordinate<0>(q)),
+        real_type2(detail::coordinate<1>(p) - detail::coordinate<1>(q)),
+        real_type3(detail::coordinate<2>(p) - detail::coordinate<2>(q))
+      };
+    }
+
+    vector a_, b_, c_;
+    vector n_ab_, n_bc_, n_ca_;
+    vector c_perp_;
+    compute_type area_;
+    compute_type alpha_, cos_alpha_, sin_alpha_;
+    compute_type cos_c_;
+};
+
+
+} // end dist2d
+
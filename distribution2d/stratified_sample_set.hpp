@@ -0,0 +1,224 @@
+#pragma once
+
+#include "detail/bits.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+// a pseudorandom permutation of [0, n) chosen by seed, evaluated one element at a time
+// see Kensler, Correlated Multi-Jittered Sampling, 2013
+constexpr std::uint32_t permute(std::uint32_t i, std::uint32_t n, std::uint32_t seed)
+{
+  std::uint32_t w = n - 1;
+  w |= w >> 1;
+  w |= w >> 2;
+  w |= w >> 4;
+  w |= w >> 8;
+  w |= w >> 16;
+
+  // cycle walk until the permutation of [0, w] lands in [0, n)
+  do
+  {
+    i ^= seed;               i *= 0xe170893du;
+    i ^= seed >> 16;
+    i ^= (i & w) >> 4;
+    i ^= seed >> 8;          i *= 0x0929eb3fu;
+    i ^= seed >> 23;
+    i ^= (i & w) >> 1;       i *= 1 | seed >> 27;
+                             i *= 0x6935fa69u;
+    i ^= (i & w) >> 11;      i *= 0x74dcb303u;
+    i ^= (i & w) >> 2;       i *= 0x9e501cc3u;
+    i ^= (i & w) >> 2;       i *= 0xc860a3dfu;
+    i &= w;
+    i ^= i >> 5;
+  }
+  while(i >= n);
+
+  return static_cast<std::uint32_t>((std::uint64_t(i) + seed) % n);
+}
+
+
+// a hash of i and seed, used as a 32b fixed point jitter in [0,1)
+// see Kensler, Correlated Multi-Jittered Sampling, 2013
+constexpr std::uint32_t jitter(std::uint32_t i, std::uint32_t seed)
+{
+  i ^= seed;
+  i ^= i >> 17;
+  i ^= i >> 10;
+  i *= 0xb36534e5u;
+  i ^= i >> 12;
+  i ^= i >> 21;
+  i *= 0x93fc4795u;
+  i ^= 0xdf6e307fu;
+  i ^= i >> 17;
+  i *= 1 | seed >> 18;
+  return i;
+}
+
+
+// returns the 32b fixed point fraction of (cell + fraction / 2^32) / n
+constexpr std::uint32_t stratum_to_fixed_point(std::uint64_t cell, std::uint32_t fraction, std::uint64_t n)
+{
+  return static_cast<std::uint32_t>(((cell << 32) + fraction) / n);
+}
+
+
+constexpr std::uint32_t checked_sample_count(std::uint64_t n)
+{
+  if(n == 0 || n > std::numeric_limits<std::uint32_t>::max())
+  {
+    throw std::invalid_argument("sample set: the number of samples must be in [1, 2^32)");
+  }
+
+  return static_cast<std::uint32_t>(n);
+}
+
+
+} // end detail
+
+
+// returns a seed for the sample sets of pixel (x, y), so that neighboring pixels' sample sets are uncorrelated
+constexpr std::uint32_t pixel_seed(std::uint32_t x, std::uint32_t y, std::uint32_t seed = 0)
+{
+  return detail::hash(detail::hash_combine(detail::hash_combine(detail::hash(seed), x), y));
+}
+
+
+// the following are finite sets of points in [0,1)^2, stratified in different ways
+// like the sequences, operator()(i) returns point i of the set as a pair of integers which the (urn1, urn2) overloads
+// of the distributions map to the point's coordinates, e.g.
+//
+//     correlated_multi_jittered_sample_set set(4, 4, pixel_seed(x, y));
+//     for(std::uint32_t i = 0; i < set.size(); ++i)
+//     {
+//       auto urns = set(i);
+//       auto p = dist(urns.first, urns.second);
+//     }
+//
+// each seed yields an independent randomization of the set
+
+
+// one point jittered uniformly within each cell of an nx x ny grid
+class jittered_sample_set
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    constexpr jittered_sample_set(std::uint32_t nx, std::uint32_t ny, std::uint32_t seed = 0)
+      : nx_(nx), ny_(ny), size_(detail::checked_sample_count(std::uint64_t(nx) * ny)), seed_(seed)
+    {}
+
+    constexpr std::uint32_t size() const
+    {
+      return size_;
+    }
+
+    constexpr result_type operator()(std::uint32_t i) const
+    {
+      return result_type{
+        detail::stratum_to_fixed_point(i % nx_, detail::jitter(i, seed_ * 0xa399d265u), nx_),
+        detail::stratum_to_fixed_point(i / nx_, detail::jitter(i, seed_ * 0x711ad6a5u), ny_)
+      };
+    }
+
+  private:
+    std::uint32_t nx_, ny_, size_;
+    std::uint32_t seed_;
+};
+
+
+// Kensler's correlated multi-jittered points, which are jittered within an m x n grid like jittered_sample_set,
+// and are also stratified within each of the m * n columns and rows of [0,1)^2, like latin_hypercube_sample_set
+// the order of the points is shuffled, so that prefixes of the set remain well distributed
+// see Kensler, Correlated Multi-Jittered Sampling, 2013
+class correlated_multi_jittered_sample_set
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    constexpr correlated_multi_jittered_sample_set(std::uint32_t m, std::uint32_t n, std::uint32_t seed = 0)
+      : m_(m), n_(n), size_(detail::checked_sample_count(std::uint64_t(m) * n)), seed_(seed)
+    {}
+
+    constexpr std::uint32_t size() const
+    {
+      return size_;
+    }
+
+    constexpr result_type operator()(std::uint32_t i) const
+    {
+      std::uint32_t s = detail::permute(i, size_, seed_ * 0x51633e2du);
+
+      std::uint32_t column = s % m_;
+      std::uint32_t row = s / m_;
+
+      // shuffle the substrata of each column & row identically, so the points remain stratified in both
+      std::uint32_t sx = detail::permute(column, m_, seed_ * 0xa511e9b3u);
+      std::uint32_t sy = detail::permute(row, n_, seed_ * 0x63d83595u);
+
+      return result_type{
+        detail::stratum_to_fixed_point(std::uint64_t(column) * n_ + sy, detail::jitter(s, seed_ * 0xa399d265u), size_),
+        detail::stratum_to_fixed_point(std::uint64_t(row) * m_ + sx, detail::jitter(s, seed_ * 0x711ad6a5u), size_)
+      };
+    }
+
+  private:
+    std::uint32_t m_, n_, size_;
+    std::uint32_t seed_;
+};
+
+
+// n points with exactly one in each of the n columns and n rows of [0,1)^2, jittered within its cell
+class latin_hypercube_sample_set
+{
+  public:
+    using result_type = std::pair<std::uint32_t,std::uint32_t>;
+
+    constexpr explicit latin_hypercube_sample_set(std::uint32_t n, std::uint32_t seed = 0)
+      : n_(detail::checked_sample_count(n)), seed_(seed)
+    {}
+
+    constexpr std::uint32_t size() const
+    {
+      return n_;
+    }
+
+    constexpr result_type operator()(std::uint32_t i) const
+    {
+      return result_type{
+        detail::stratum_to_fixed_point(detail::permute(i, n_, seed_ * 0xa511e9b3u), detail::jitter(i, seed_ * 0xa399d265u), n_),
+        detail::stratum_to_fixed_point(detail::permute(i, n_, seed_ * 0x63d83595u), detail::jitter(i, seed_ * 0x711ad6a5u), n_)
+      };
+    }
+
+  private:
+    std::uint32_t n_;
+    std::uint32_t seed_;
+};
+
+
+// stores dist(set(i).first, set(i).second) to out[i] for each point i of the sample set and returns the end of the output
+// this works with any distribution which has an (urn1, urn2) overload
+template<class Distribution, class SampleSet, class OutputIterator>
+OutputIterator generate_sample_set(const Distribution& dist, const SampleSet& set, OutputIterator out)
+{
+  for(std::uint32_t i = 0; i < set.size(); ++i, ++out)
+  {
+    auto urns = set(i);
+    *out = dist(urns.first, urns.second);
+  }
+
+  return out;
+}
+
+
+} // end dist2d
+
@@ -1,18 +1,29 @@
 #pragma once
 
 #include "unit_square_distribution.hpp"
+#include "detail/constexpr_math.hpp"
+#include "packed_point.hpp"
+#include "detail/simd.hpp"
+#include "detail/atan.hpp"
+#include "detail/math_constants.hpp"
+#include "precision.hpp"
+#include "detail/coordinate.hpp"
 #include <utility>
 #include <tuple>
 #include <limits>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
 
 namespace dist2d
 {
 
 
 // a uniform distribution of points on the unit disk
-template<class Point = std::pair<float,float>>
+// Precision selects how the warp is evaluated, see precision.hpp
+template<class Point = std::pair<float,float>, class Precision = accurate_precision>
 class unit_disk_distribution
 {
   public:
@@ -26,22 +37,76 @@ class unit_disk_distribution
     using real_type = typename std::common_type<real_type1, real_type2>::type;
 
   private:
-    static constexpr real_type pi = 3.14159265;
+    using compute_type = typename Precision::template compute_type<real_type>;
+
+    static constexpr real_type pi = real_type(detail::math_constants::pi);
 
   public:
+    // maps (u, v) in [0,1)^2 to the point (x, y) on the unit disk
+    constexpr static void warp(compute_type u, compute_type v, real_type1& x, real_type2& y)
+    {
+      compute_type r = detail::sqrt(u);
+
+      compute_type s = 0, c = 0;
+      Precision::sincos_turns(v, s, c);
+
+      x = real_type1(r * c);
+      y = real_type2(r * s);
+    }
+
+    // the inverse of warp: maps the point (x, y) on the unit disk to (u, v) in [0,1)^2
+    static void inverse_warp(real_type1 x, real_type2 y, real_type1& u, real_type2& v)
+    {
+      u = detail::clamp_to_unit_interval(x*x + real_type1(y*y));
+      v = real_type2(detail::atan2_turns(real_type(y), real_type(x)));
+    }
+
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      result_type
+    >::type
+      operator()(Float1 u, Float2 v) const
+    {
+      real_type1 x = 0;
+      real_type2 y = 0;
+      warp(u, v, x, y);
+
+      return result_type{x, y};
+    }
+
     template<class Integer1, class Integer2>
-    result_type operator()(Integer1 x, Integer2 y) const
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 x, Integer2 y) const
     {
-      unit_square_distribution<Point> square;
+      // the square's coordinates are compute_types, even if Point's coordinates are e.g. packed
+      auto u = unit_square_distribution<std::pair<compute_type,compute_type>>()(x, y);
 
-      real_type1 u;
-      real_type2 v;
-      std::tie(u,v) = square(x,y);
+      return operator()(u.first, u.second);
+    }
 
-      real_type1 r = std::sqrt(u);
-      real_type2 theta = real_type2(2) * pi * v;
+    // returns operator()(u1, u2) with its density, which is the constant 1 / area()
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      return std::make_pair(operator()(u1, u2), real_type(1) / area());
+    }
 
-      return result_type{r * std::cos(theta), real_type2(r) * std::sin(theta)};
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      return std::make_pair(operator()(urn1, urn2), real_type(1) / area());
     }
 
     template<class Integer,
@@ -50,7 +115,7 @@ class unit_disk_distribution
              >::type>
     result_type operator()(Integer i) const
     {
-      auto xy = decode_morton_2d(i);
+      auto xy = morton_urns(i);
       return operator()(xy.first, xy.second);
     }
 
@@ -60,26 +125,158 @@ class unit_disk_distribution
              >::type>
     result_type operator()(Generator& g) const
     {
-      return operator()(g());
+      auto u = detail::unit_square_from_generator<compute_type,compute_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs and ys
+    // when every coordinate is a float, the points are computed by the vector kernels of detail/simd.hpp,
+    // which agree with operator() to within the error of detail::sincos_turns, or to within rounding with fast_precision
+    // with double_precision, they're computed by operator()
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys) const
+    {
+      generate(first_index, count, xs, ys, use_simd_warp());
+    }
+
+    // stores the points operator()(first_index), ..., operator()(first_index + count - 1) to out,
+    // packed into a type constructible from their coordinates, such as half2 or unorm16_disk_point of packed_point.hpp
+    // the points are generated a chunk at a time and packed while in cache, so no array of unpacked points is stored
+    template<class Integer, class Packed,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value &&
+               std::is_constructible<Packed, real_type1, real_type2>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, Packed* out) const
+    {
+      detail::generate_packed(*this, first_index, count, out);
+    }
+
+    // maps the point p back to the (u1, u2) in [0,1)^2 which operator() maps to it
+    static std::pair<real_type1,real_type2> inverse(const result_type& p)
+    {
+      real_type1 u1;
+      real_type2 u2;
+      inverse_warp(detail::coordinate<0>(p), detail::coordinate<1>(p), u1, u2);
+
+      return std::make_pair(u1, u2);
+    }
+
+    // stores the inverse of each of the points (xs[i], ys[i]) to (u1s[i], u2s[i])
+    // for float this loop is branch free, and vectorizes when compiled with -fno-math-errno -fno-trapping-math
+    static void inverse(std::size_t count, const real_type1* xs, const real_type2* ys, real_type1* u1s, real_type2* u2s)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        inverse_warp(xs[i], ys[i], u1s[i], u2s[i]);
+      }
     }
 
     static bool contains(const result_type& p)
     {
-      real_type radius_squared = std::get<0>(p) * std::get<0>(p) + std::get<1>(p) * std::get<1>(p);
+      real_type radius_squared = detail::coordinate<0>(p) * detail::coordinate<0>(p) + detail::coordinate<1>(p) * detail::coordinate<1>(p);
 
       return real_type(0) <= radius_squared && radius_squared < real_type(1);
     }
 
+    // stores contains((xs[i], ys[i])) to mask[i] for each of the count points
+    // when every coordinate is a float, this is computed by the vector kernels of detail/simd.hpp
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask)
+    {
+      contains(count, xs, ys, mask, use_simd_kernels());
+    }
+
     // if !contains(p) the result is undefined
-    constexpr static real_type probability_density(const result_type& p)
+    constexpr static real_type probability_density(const result_type&)
     {
       return real_type(1) / area();
     }
 
+    // stores the density at each of the count points (xs[i], ys[i]) to pdfs[i], or 0 where the point is not contained
+    static void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, real_type* pdfs)
+    {
+      const real_type density = real_type(1) / area();
+
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, mask);
+
+        detail::simd::select_density(mask, n, density, pdfs + i);
+      }
+    }
+
     constexpr static real_type area()
     {
       return pi;
     }
+
+  private:
+    using use_simd_kernels = std::integral_constant<
+      bool,
+      std::is_same<real_type1,float>::value &&
+      std::is_same<real_type2,float>::value
+    >;
+
+    using use_simd_warp = std::integral_constant<
+      bool,
+      use_simd_kernels::value &&
+      std::is_same<compute_type,float>::value
+    >;
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask, std::false_type)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i]});
+      }
+    }
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask, std::true_type)
+    {
+      detail::simd::disk_contains(xs, ys, count, false, mask);
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, std::false_type) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto xy = morton_urns(static_cast<Integer>(first_index + k));
+
+        compute_type u = unit_interval_distribution<compute_type>()(xy.first);
+        compute_type v = unit_interval_distribution<compute_type>()(xy.second);
+
+        warp(u, v, xs[k], ys[k]);
+      }
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, std::true_type) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        // stage the chunk's points in [0,1)^2 in xs & ys and warp them in place
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          xs[i + k] = unit_interval_distribution<float>()(urn1s[k]);
+          ys[i + k] = unit_interval_distribution<float>()(urn2s[k]);
+        }
+
+        detail::simd::disk_warp(xs + i, ys + i, n, xs + i, ys + i);
+      }
+    }
 };
 
 
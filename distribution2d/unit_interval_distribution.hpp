@@ -1,9 +1,13 @@
 #pragma once
 
+#include "detail/bits.hpp"
 #include <limits>
 #include <random>
 #include <type_traits>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
 
 namespace dist2d
 {
@@ -17,30 +21,203 @@ using is_integral_generator = typename std::is_integral<
 >::type;
 
 
+// 2^-n
+template<class Real>
+constexpr Real exp2_negative(int n)
+{
+  Real result = 1;
+  for(int i = 0; i < n; ++i)
+  {
+    result *= Real(0.5);
+  }
+  return result;
+}
+
+
+// clamps x to [0,1), e.g. to keep rounding error from carrying the result of an inverse mapping outside [0,1)
+template<class Real>
+Real clamp_to_unit_interval(Real x)
+{
+  const Real one_minus_epsilon = Real(1) - std::numeric_limits<Real>::epsilon() / 2;
+
+  return std::min(std::max(x, Real(0)), one_minus_epsilon);
+}
+
+
+// converts the Bits-bit integer x to Real exactly
+// this goes through a signed type when it can, because that converts faster
+template<int Bits, class Real, class UInt>
+constexpr Real integer_to_real(UInt x)
+{
+  using int_type = typename std::conditional<
+    (Bits < 32),
+    std::int32_t,
+    typename std::conditional<(Bits < 64), std::int64_t, std::uint64_t>::type
+  >::type;
+
+  return Real(static_cast<int_type>(x));
+}
+
+
+// maps the Width-bit integer x to a multiple of 2^-b in [0,1), where b = min(Width, digits of Real)
+// the b high bits of x determine the result
+template<class Real, int Width, class UInt>
+constexpr Real fixed_point_unit_interval(UInt x)
+{
+  constexpr int bits = std::min(Width, std::numeric_limits<Real>::digits);
+  constexpr Real scale = exp2_negative<Real>(bits);
+
+  return integer_to_real<bits,Real>(x >> (Width - bits)) * scale;
+}
+
+
+// maps the Width-bit integer x to a real in [0,1), choosing each representable real with probability
+// proportional to the distance to its successor, down to 2^-Width
+// see Downey, Generating Pseudo-random Floating-Point Values, 2007
+template<class Real, int Width, class UInt>
+Real dense_unit_interval(UInt x)
+{
+  constexpr int significand_bits = std::numeric_limits<Real>::digits - 1;
+  constexpr Real scale = exp2_negative<Real>(significand_bits);
+
+  // left-justify x so that its leading zeros select the binade [2^-(e+1), 2^-e)
+  std::uint64_t bits = static_cast<std::uint64_t>(x) << (64 - Width);
+  if(bits == 0) return Real(0);
+
+  int e = count_leading_zeros(bits);
+
+  // the bits below the leading 1 are the significand
+  // XXX when Width - e - 1 < significand_bits, the missing low bits are 0
+  std::uint64_t significand = (e == 63) ? 0 : (bits << (e + 1)) >> (64 - significand_bits);
+
+  return std::ldexp(Real(1) + integer_to_real<significand_bits,Real>(significand) * scale, -(e + 1));
+}
+
+
+// the number of bits b such that [0, 2^b) fits in [0, range]
+constexpr int bits_in_range(std::uint64_t range)
+{
+  int result = 0;
+  while(result < 64 && (range >> result) != 0)
+  {
+    ++result;
+  }
+
+  // if range isn't 2^result - 1, the top bit isn't uniform
+  if(result < 64 && range != (std::uint64_t(1) << result) - 1)
+  {
+    --result;
+  }
+
+  return result;
+}
+
+
+// describes the uniformly random bits in each result of g()
+// these are the bits spanned by [Generator::min(), Generator::max()] if Generator provides them,
+// and every bit of its result otherwise
+template<class Generator, class = void>
+struct generator_bits
+  : std::integral_constant<int, std::numeric_limits<typename std::result_of<Generator&()>::type>::digits>
+{
+  static constexpr std::uint64_t min()
+  {
+    return 0;
+  }
+};
+
+
+template<class Generator>
+struct generator_bits<Generator, decltype(void(Generator::min()), void(Generator::max()))>
+  : std::integral_constant<int, bits_in_range(static_cast<std::uint64_t>(Generator::max() - Generator::min()))>
+{
+  static constexpr std::uint64_t min()
+  {
+    return static_cast<std::uint64_t>(Generator::min());
+  }
+};
+
+
+// returns generator_bits<Generator>::value uniformly random low bits
+template<class Generator>
+std::uint64_t draw_bits(Generator& g)
+{
+  constexpr int width = generator_bits<Generator>::value;
+  constexpr std::uint64_t mask = width >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+
+  return (static_cast<std::uint64_t>(g()) - generator_bits<Generator>::min()) & mask;
+}
+
+
+// concatenates enough calls to g() to provide Bits bits, up to 64
+// the number of valid low bits of the result is draw_width<Generator,Bits>::value
+template<class Generator, int Bits>
+struct draw_width
+  : std::integral_constant<
+      int,
+      generator_bits<Generator>::value * std::min(
+        (std::min(Bits, 64) + generator_bits<Generator>::value - 1) / generator_bits<Generator>::value,
+        64 / generator_bits<Generator>::value
+      )
+    >
+{};
+
+
+template<int Bits, class Generator>
+std::uint64_t draw_at_least(Generator& g)
+{
+  constexpr int width = generator_bits<Generator>::value;
+  constexpr int draws = draw_width<Generator,Bits>::value / width;
+
+  // when draws > 1, width < 64
+  constexpr int shift = width % 64;
+
+  std::uint64_t result = draw_bits(g);
+  for(int i = 1; i < draws; ++i)
+  {
+    result = (result << shift) | draw_bits(g);
+  }
+
+  return result;
+}
+
+
 } // end detail
 
 
+// these select how unit_interval_distribution maps integers to reals
+
+// the results are equally spaced: an integer's high bits become the fraction
+struct fixed_point_conversion {};
+
+// the results include every representable value in [0,1) down to 2^-(number of input bits),
+// each with probability proportional to its spacing
+struct dense_conversion {};
+
+
 // a uniform distribution of points in [0,1)
-template<class Point = float>
+template<class Point = float, class Conversion = fixed_point_conversion>
 class unit_interval_distribution
 {
   public:
     using real_type = Point;
 
-    template<class Integer>
-    real_type operator()(Integer i) const
+    // the result is determined by the high bits of i: 24 for float and 53 for double
+    // if i has fewer bits than real_type's significand, all of them are used
+    // with fixed_point_conversion, this may be evaluated at compile time
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    constexpr real_type operator()(Integer i) const
     {
-      // see https://xor0110.wordpress.com/2010/09/24/how-to-generate-floating-point-random-numbers-efficiently/
-      union
-      {
-        Integer i;
-        float f;
-      } u;
-
-      u.i = (i & 0x007fffff) | 0x3f800000;
-      return u.f-1.f;
+      using unsigned_type = typename std::make_unsigned<Integer>::type;
+      constexpr int width = std::numeric_limits<unsigned_type>::digits;
+
+      return convert<width>(static_cast<unsigned_type>(i), Conversion());
     }
 
+    // this calls g() as many times as required to fill real_type's significand
     // XXX this only makes sense if g generates numbers which span the entire range of the result type
     //     some random number generators don't do that
     template<class Generator,
@@ -49,7 +226,10 @@ class unit_interval_distribution
              >::type>
     real_type operator()(Generator& g) const
     {
-      return operator()(g());
+      constexpr int bits = std::is_same<Conversion,dense_conversion>::value ? 64 : std::numeric_limits<real_type>::digits;
+      constexpr int width = detail::draw_width<Generator,bits>::value;
+
+      return convert<width>(detail::draw_at_least<bits>(g), Conversion());
     }
 
     static bool contains(const real_type& x)
@@ -67,11 +247,64 @@ class unit_interval_distribution
     {
       return 1.f;
     }
+
+  private:
+    template<int Width, class UInt>
+    constexpr static real_type convert(UInt x, fixed_point_conversion)
+    {
+      return detail::fixed_point_unit_interval<real_type,Width>(x);
+    }
+
+    template<int Width, class UInt>
+    static real_type convert(UInt x, dense_conversion)
+    {
+      return detail::dense_unit_interval<real_type,Width>(x);
+    }
 };
 
 
 constexpr unit_interval_distribution<> u01f{};
 
 
+namespace detail
+{
+
+
+// returns a point uniformly distributed in [0,1)^2 with full precision in each coordinate
+// when a single result of g() has enough bits for both coordinates, e.g. a 64b result for two floats,
+// this calls g() only once
+template<class Real1, class Real2, class Generator>
+std::pair<Real1,Real2> unit_square_from_generator(Generator& g, std::true_type)
+{
+  constexpr int width = generator_bits<Generator>::value;
+  constexpr int bits1 = std::numeric_limits<Real1>::digits;
+  constexpr int bits2 = std::numeric_limits<Real2>::digits;
+
+  std::uint64_t x = draw_bits(g);
+
+  return std::make_pair(fixed_point_unit_interval<Real1,bits1>(x >> (width - bits1)),
+                        fixed_point_unit_interval<Real2,bits2>((x >> (width - bits1 - bits2)) & ((std::uint64_t(1) << bits2) - 1)));
+}
+
+
+template<class Real1, class Real2, class Generator>
+std::pair<Real1,Real2> unit_square_from_generator(Generator& g, std::false_type)
+{
+  Real1 u = unit_interval_distribution<Real1>()(g);
+  Real2 v = unit_interval_distribution<Real2>()(g);
+  return std::make_pair(u, v);
+}
+
+
+template<class Real1, class Real2, class Generator>
+std::pair<Real1,Real2> unit_square_from_generator(Generator& g)
+{
+  constexpr bool one_draw = std::numeric_limits<Real1>::digits + std::numeric_limits<Real2>::digits <= generator_bits<Generator>::value;
+
+  return unit_square_from_generator<Real1,Real2>(g, std::integral_constant<bool,one_draw>());
+}
+
+
+} // end detail
 } // end dist2d
 
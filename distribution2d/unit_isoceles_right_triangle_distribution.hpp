@@ -1,12 +1,16 @@
 #pragma once
 
 #include "unit_square_distribution.hpp"
+#include "detail/constexpr_math.hpp"
+#include "detail/coordinate.hpp"
 #include <utility>
 #include <tuple>
 #include <limits>
 #include <iostream>
 #include <random>
 #include <type_traits>
+#include <cstddef>
+#include <cmath>
 
 namespace dist2d
 {
@@ -37,20 +41,16 @@ class unit_isoceles_right_triangle_distribution
   public:
     using real_type = typename std::common_type<real_type1,real_type2>::type;
 
-    template<class Float1, class Float2>
-    typename std::enable_if<
-      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
-      result_type
-    >::type
-      operator()(Float1 u1, Float2 u2) const
+    // maps (u1, u2) in [0,1)^2 to the point (x, y) on the triangle
+    constexpr static void warp(real_type1 u1, real_type2 u2, real_type1& x, real_type2& y)
     {
       // (u1, u2) in [0,1)^2
-      real_type1 su1 = std::sqrt(u1);
+      real_type1 su1 = detail::sqrt(u1);
 
       // su1 in [0,1)
 
       // x varies from (0, 1]
-      real_type1 x = real_type1(1) - su1;
+      x = real_type1(1) - su1;
 
       // many sources define y like this:
       //
@@ -67,25 +67,64 @@ class unit_isoceles_right_triangle_distribution
       //
       //     y = u2 * (1 - x)
       //
-      real_type2 y = u2 * (real_type1(1) - x);
+      y = u2 * (real_type1(1) - x);
+    }
+
+    // the inverse of warp: maps the point (x, y) on the triangle to (u1, u2) in [0,1)^2
+    static void inverse_warp(real_type1 x, real_type2 y, real_type1& u1, real_type2& u2)
+    {
+      real_type1 su1 = real_type1(1) - x;
+
+      u1 = detail::clamp_to_unit_interval(su1 * su1);
+      // the apex has su1 == 0 and y == 0
+      u2 = detail::clamp_to_unit_interval(real_type2(y / (su1 > real_type1(0) ? su1 : real_type1(1))));
+    }
+
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      result_type
+    >::type
+      operator()(Float1 u1, Float2 u2) const
+    {
+      real_type1 x = 0;
+      real_type2 y = 0;
+      warp(u1, u2, x, y);
 
       return result_type{x, y};
     }
 
     template<class Integer1, class Integer2>
-    typename std::enable_if<
+    constexpr typename std::enable_if<
       std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
       result_type
     >::type
       operator()(Integer1 urn1, Integer2 urn2) const
     {
-      real_type1 u1;
-      real_type2 u2;
-      unit_square_distribution<std::pair<real_type1,real_type2>> square;
+      auto u = unit_square_distribution<std::pair<real_type1,real_type2>>()(urn1, urn2);
+
+      return operator()(u.first, u.second);
+    }
 
-      std::tie(u1,u2) = square(urn1, urn2);
+    // returns operator()(u1, u2) with its density, which is the constant 1 / area()
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      return std::make_pair(operator()(u1, u2), real_type(1) / area());
+    }
 
-      return operator()(u1,u2);
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      return std::make_pair(operator()(urn1, urn2), real_type(1) / area());
     }
 
     template<class Integer,
@@ -94,7 +133,7 @@ class unit_isoceles_right_triangle_distribution
              >::type>
     result_type operator()(Integer i) const
     {
-      auto xy = decode_morton_2d(i);
+      auto xy = morton_urns(i);
       return operator()(xy.first, xy.second);
     }
 
@@ -104,27 +143,110 @@ class unit_isoceles_right_triangle_distribution
              >::type>
     result_type operator()(Generator& g) const
     {
-      return operator()(g());
+      auto u = detail::unit_square_from_generator<real_type1,real_type2>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs and ys
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto xy = morton_urns(static_cast<Integer>(first_index + k));
+
+        real_type1 u1 = unit_interval_distribution<real_type1>()(xy.first);
+        real_type2 u2 = unit_interval_distribution<real_type2>()(xy.second);
+
+        warp(u1, u2, xs[k], ys[k]);
+      }
+    }
+
+    // maps the point p back to the (u1, u2) in [0,1)^2 which operator() maps to it
+    static std::pair<real_type1,real_type2> inverse(const result_type& p)
+    {
+      real_type1 u1;
+      real_type2 u2;
+      inverse_warp(detail::coordinate<0>(p), detail::coordinate<1>(p), u1, u2);
+
+      return std::make_pair(u1, u2);
+    }
+
+    // stores the inverse of each of the points (xs[i], ys[i]) to (u1s[i], u2s[i])
+    // for float this loop is branch free, and vectorizes when compiled with -fno-math-errno -fno-trapping-math
+    static void inverse(std::size_t count, const real_type1* xs, const real_type2* ys, real_type1* u1s, real_type2* u2s)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        inverse_warp(xs[i], ys[i], u1s[i], u2s[i]);
+      }
     }
 
     static bool contains(const result_type& p)
     {
-      const real_type1& x = std::get<0>(p);
-      const real_type2& y = std::get<1>(p);
+      const real_type1& x = detail::coordinate<0>(p);
+      const real_type2& y = detail::coordinate<1>(p);
 
       return (real_type1(0) < x && x <= real_type1(1)) && (real_type2(0) <= y && y <= real_type2(real_type1(1) - x));
     }
 
+    // stores contains((xs[i], ys[i])) to mask[i] for each of the count points
+    // when every coordinate is a float, this is computed by the vector kernels of detail/simd.hpp
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask)
+    {
+      contains(count, xs, ys, mask, use_simd_contains());
+    }
+
     // if !contains(p) the result is undefined
-    static real_type probability_density(const result_type&)
+    constexpr static real_type probability_density(const result_type&)
     {
       return real_type(1) / area();
     }
 
-    static real_type area()
+    // stores the density at each of the count points (xs[i], ys[i]) to pdfs[i], or 0 where the point is not contained
+    static void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, real_type* pdfs)
+    {
+      const real_type density = real_type(1) / area();
+
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, mask);
+
+        detail::simd::select_density(mask, n, density, pdfs + i);
+      }
+    }
+
+    constexpr static real_type area()
     {
       return 0.5;
     }
+
+  private:
+    using use_simd_contains = std::integral_constant<
+      bool,
+      std::is_same<real_type1,float>::value &&
+      std::is_same<real_type2,float>::value
+    >;
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask, std::false_type)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i]});
+      }
+    }
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask, std::true_type)
+    {
+      detail::simd::triangle_contains(xs, ys, count, mask);
+    }
 };
 
 
@@ -1,18 +1,27 @@
 #pragma once
 
 #include "unit_square_distribution.hpp"
+#include "detail/constexpr_math.hpp"
+#include "packed_point.hpp"
+#include "detail/simd.hpp"
+#include "detail/atan.hpp"
+#include "detail/math_constants.hpp"
+#include "precision.hpp"
+#include "detail/coordinate.hpp"
 #include <tuple>
 #include <utility>
 #include <algorithm>
 #include <cmath>
 #include <type_traits>
+#include <cstddef>
 
 namespace dist2d
 {
 
 
 // a uniform distribution of points on the unit sphere
-template<class Point = std::tuple<float,float,float>>
+// Precision selects how the warp is evaluated, see precision.hpp
+template<class Point = std::tuple<float,float,float>, class Precision = accurate_precision>
 class unit_sphere_distribution
 {
   public:
@@ -27,40 +36,78 @@ class unit_sphere_distribution
     using real_type = typename std::common_type<real_type1, real_type2, real_type3>::type;
 
   private:
-    static constexpr real_type pi = 3.14159265;
-    static constexpr real_type two_pi = real_type(2) * pi;
+    using compute_type = typename Precision::template compute_type<real_type>;
+
+    static constexpr real_type pi = real_type(detail::math_constants::pi);
 
   public:
+    // maps (u1, u2) in [0,1)^2 to the point (x, y, z) on the unit sphere
+    constexpr static void warp(compute_type u1, compute_type u2, real_type1& x, real_type2& y, real_type3& z)
+    {
+      compute_type cz = compute_type(1) - compute_type(2)*u1;
+      compute_type r = detail::sqrt(std::max(compute_type(0), compute_type(1) - cz*cz));
+
+      compute_type s = 0, c = 0;
+      Precision::sincos_turns(u2, s, c);
+
+      x = real_type1(r * c);
+      y = real_type2(r * s);
+      z = real_type3(cz);
+    }
+
+    // the inverse of warp: maps the point (x, y, z) on the unit sphere to (u1, u2) in [0,1)^2
+    static void inverse_warp(real_type1 x, real_type2 y, real_type3 z, real_type& u1, real_type& u2)
+    {
+      u1 = detail::clamp_to_unit_interval(real_type(0.5) - real_type(0.5)*z);
+      u2 = detail::atan2_turns(real_type(y), real_type(x));
+    }
+
     template<class Float1, class Float2,
              class = typename std::enable_if<
                std::is_floating_point<Float1>::value &&
                std::is_floating_point<Float2>::value
              >::type>
-    result_type operator()(Float1 u1, Float2 u2) const
+    constexpr result_type operator()(Float1 u1, Float2 u2) const
     {
-      real_type3 z = real_type3(1) - real_type3(2)*u1;
-      real_type r = std::sqrt(std::max(real_type(0), real_type(1) - z*z));
-      real_type phi = two_pi * u2;
-      real_type1 x = r * std::cos(phi);
-      real_type2 y = r * std::sin(phi);
+      real_type1 x = 0;
+      real_type2 y = 0;
+      real_type3 z = 0;
+      warp(u1, u2, x, y, z);
 
       return result_type{x,y,z};
     }
 
     template<class Integer1, class Integer2>
-    typename std::enable_if<
+    constexpr typename std::enable_if<
       std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
       result_type
     >::type
       operator()(Integer1 urn1, Integer2 urn2) const
     {
-      unit_square_distribution<std::pair<real_type,real_type>> square;
+      auto u = unit_square_distribution<std::pair<compute_type,compute_type>>()(urn1, urn2);
 
-      real_type u1;
-      real_type u2;
-      std::tie(u1,u2) = square(urn1,urn2);
+      return operator()(u.first, u.second);
+    }
 
-      return operator()(u1, u2);
+    // returns operator()(u1, u2) with its density, which is the constant 1 / area()
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      return std::make_pair(operator()(u1, u2), real_type(1) / area());
+    }
+
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      return std::make_pair(operator()(urn1, urn2), real_type(1) / area());
     }
 
     template<class Integer,
@@ -69,7 +116,7 @@ class unit_sphere_distribution
              >::type>
     result_type operator()(Integer i) const
     {
-      auto xy = decode_morton_2d(i);
+      auto xy = morton_urns(i);
       return operator()(xy.first, xy.second);
     }
 
@@ -79,26 +126,158 @@ class unit_sphere_distribution
              >::type>
     result_type operator()(Generator& g) const
     {
-      return operator()(g());
+      auto u = detail::unit_square_from_generator<compute_type,compute_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs, ys, and zs
+    // when every coordinate is a float, the points are computed by the vector kernels of detail/simd.hpp,
+    // which agree with operator() to within the error of detail::sincos_turns, or to within rounding with fast_precision
+    // with double_precision, they're computed by operator()
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs) const
+    {
+      generate(first_index, count, xs, ys, zs, use_simd_warp());
+    }
+
+    // stores the points operator()(first_index), ..., operator()(first_index + count - 1) to out,
+    // packed into a type constructible from their coordinates, such as octahedral_unit_vector or half3 of packed_point.hpp
+    // the points are generated a chunk at a time and packed while in cache, so no array of unpacked points is stored
+    template<class Integer, class Packed,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value &&
+               std::is_constructible<Packed, real_type1, real_type2, real_type3>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, Packed* out) const
+    {
+      detail::generate_packed(*this, first_index, count, out);
+    }
+
+    // maps the point p back to the (u1, u2) in [0,1)^2 which operator() maps to it
+    static std::pair<real_type,real_type> inverse(const result_type& p)
+    {
+      real_type u1, u2;
+      inverse_warp(detail::coordinate<0>(p), detail::coordinate<1>(p), detail::coordinate<2>(p), u1, u2);
+
+      return std::make_pair(u1, u2);
+    }
+
+    // stores the inverse of each of the points (xs[i], ys[i], zs[i]) to (u1s[i], u2s[i])
+    // for float this loop is branch free, and vectorizes when compiled with -fno-math-errno -fno-trapping-math
+    static void inverse(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* u1s, real_type* u2s)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        inverse_warp(xs[i], ys[i], zs[i], u1s[i], u2s[i]);
+      }
     }
 
     static bool contains(const result_type& p)
     {
-      real_type radius_squared = std::get<0>(p) * std::get<0>(p) + std::get<1>(p) * std::get<1>(p) + std::get<2>(p) * std::get<2>(p);
+      real_type radius_squared = detail::coordinate<0>(p) * detail::coordinate<0>(p) + detail::coordinate<1>(p) * detail::coordinate<1>(p) + detail::coordinate<2>(p) * detail::coordinate<2>(p);
 
-      return std::fabs(real_type(1) - radius_squared) < 0.000005f;
+      return std::fabs(real_type(1) - radius_squared) < detail::surface_tolerance<real_type>();
+    }
+
+    // stores contains((xs[i], ys[i], zs[i])) to mask[i] for each of the count points
+    // when every coordinate is a float, this is computed by the vector kernels of detail/simd.hpp
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask)
+    {
+      contains(count, xs, ys, zs, mask, use_simd_kernels());
     }
 
     // if !contains(p) the result is undefined
-    constexpr static real_type probability_density(const result_type& p)
+    constexpr static real_type probability_density(const result_type&)
     {
       return real_type(1) / area();
     }
 
+    // stores the density at each of the count points (xs[i], ys[i], zs[i]) to pdfs[i], or 0 where the point is not contained
+    static void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, real_type* pdfs)
+    {
+      const real_type density = real_type(1) / area();
+
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, zs + i, mask);
+
+        detail::simd::select_density(mask, n, density, pdfs + i);
+      }
+    }
+
     constexpr static real_type area()
     {
       return real_type(4) * pi;
     }
+
+  private:
+    using use_simd_kernels = std::integral_constant<
+      bool,
+      std::is_same<real_type1,float>::value &&
+      std::is_same<real_type2,float>::value &&
+      std::is_same<real_type3,float>::value
+    >;
+
+    using use_simd_warp = std::integral_constant<
+      bool,
+      use_simd_kernels::value &&
+      std::is_same<compute_type,float>::value
+    >;
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask, std::false_type)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i], zs[i]});
+      }
+    }
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, const real_type3* zs, bool* mask, std::true_type)
+    {
+      detail::simd::sphere_contains(xs, ys, zs, count, mask);
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs, std::false_type) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto xy = morton_urns(static_cast<Integer>(first_index + k));
+
+        compute_type u1 = unit_interval_distribution<compute_type>()(xy.first);
+        compute_type u2 = unit_interval_distribution<compute_type>()(xy.second);
+
+        warp(u1, u2, xs[k], ys[k], zs[k]);
+      }
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type1* xs, real_type2* ys, real_type3* zs, std::true_type) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        // stage the chunk's points in [0,1)^2 in xs & ys and warp them in place
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          xs[i + k] = unit_interval_distribution<float>()(urn1s[k]);
+          ys[i + k] = unit_interval_distribution<float>()(urn2s[k]);
+        }
+
+        detail::simd::sphere_warp(xs + i, ys + i, n, xs + i, ys + i, zs + i);
+      }
+    }
 };
 
 
@@ -1,11 +1,14 @@
 #pragma once
 
-#include "morton/morton.hpp"
+#include "morton_code.hpp"
 #include "unit_interval_distribution.hpp"
+#include "detail/coordinate.hpp"
 #include <utility>
 #include <tuple>
 #include <limits>
 #include <type_traits>
+#include <cstddef>
+#include <algorithm>
 
 namespace dist2d
 {
@@ -24,8 +27,22 @@ class unit_square_distribution
     using real_type2 = typename std::tuple_element<1,result_type>::type;
 
   public:
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      result_type
+    >::type
+      operator()(Float1 u, Float2 v) const
+    {
+      return result_type{real_type1(u), real_type2(v)};
+    }
+
     template<class Integer1, class Integer2>
-    result_type operator()(Integer1 x, Integer2 y) const
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 x, Integer2 y) const
     {
       real_type1 u = unit_interval_distribution<real_type1>()(x);
       real_type2 v = unit_interval_distribution<real_type2>()(y);
@@ -33,13 +50,34 @@ class unit_square_distribution
       return result_type{u, v};
     }
 
+    // returns operator()(u1, u2) with its density, which is the constant 1 / area()
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      return std::make_pair(operator()(u1, u2), real_type(1) / area());
+    }
+
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      return std::make_pair(operator()(urn1, urn2), real_type(1) / area());
+    }
+
     template<class Integer,
              class = typename std::enable_if<
                std::is_integral<Integer>::value
              >::type>
     result_type operator()(Integer i) const
     {
-      auto xy = decode_morton_2d(i);
+      auto xy = morton_urns(i);
       return operator()(xy.first, xy.second);
     }
 
@@ -51,27 +89,101 @@ class unit_square_distribution
              >::type>
     result_type operator()(Generator& g) const
     {
-      return operator()(g());
+      auto u = detail::unit_square_from_generator<real_type1,real_type2>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays us and vs
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    void generate(Integer first_index, std::size_t count, real_type1* us, real_type2* vs) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto xy = morton_urns(static_cast<Integer>(first_index + k));
+
+        us[k] = unit_interval_distribution<real_type1>()(xy.first);
+        vs[k] = unit_interval_distribution<real_type2>()(xy.second);
+      }
+    }
+
+    // maps the point p back to the (u, v) in [0,1)^2 which operator() maps to it, i.e. p itself
+    static std::pair<real_type1,real_type2> inverse(const result_type& p)
+    {
+      return std::make_pair(detail::coordinate<0>(p), detail::coordinate<1>(p));
+    }
+
+    // stores the inverse of each of the points (xs[i], ys[i]) to (us[i], vs[i])
+    static void inverse(std::size_t count, const real_type1* xs, const real_type2* ys, real_type1* us, real_type2* vs)
+    {
+      std::copy(xs, xs + count, us);
+      std::copy(ys, ys + count, vs);
     }
 
     static bool contains(const result_type& p)
     {
-      const auto& u = std::get<0>(p);
-      const auto& v = std::get<1>(p);
+      const auto& u = detail::coordinate<0>(p);
+      const auto& v = detail::coordinate<1>(p);
 
       return real_type1(0) <= u && u < real_type1(1) && real_type2(0) <= v && v < real_type2(1);
     }
 
+    // stores contains((xs[i], ys[i])) to mask[i] for each of the count points
+    // when every coordinate is a float, this is computed by the vector kernels of detail/simd.hpp
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask)
+    {
+      contains(count, xs, ys, mask, use_simd_contains());
+    }
+
     // if !contains(p) the result is undefined
-    static real_type probability_density(const result_type& p)
+    constexpr static real_type probability_density(const result_type&)
     {
       return real_type(1);
     }
 
-    static real_type area()
+    // stores the density at each of the count points (xs[i], ys[i]) to pdfs[i], or 0 where the point is not contained
+    static void probability_density(std::size_t count, const real_type1* xs, const real_type2* ys, real_type* pdfs)
+    {
+      const real_type density = real_type(1) / area();
+
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        bool mask[detail::simd::chunk_size];
+        contains(n, xs + i, ys + i, mask);
+
+        detail::simd::select_density(mask, n, density, pdfs + i);
+      }
+    }
+
+    constexpr static real_type area()
     {
       return real_type(1);
     }
+
+  private:
+    using use_simd_contains = std::integral_constant<
+      bool,
+      std::is_same<real_type1,float>::value &&
+      std::is_same<real_type2,float>::value
+    >;
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask, std::false_type)
+    {
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        mask[i] = contains(result_type{xs[i], ys[i]});
+      }
+    }
+
+    static void contains(std::size_t count, const real_type1* xs, const real_type2* ys, bool* mask, std::true_type)
+    {
+      detail::simd::square_contains(xs, ys, count, mask);
+    }
 };
 
 
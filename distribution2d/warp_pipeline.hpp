@@ -0,0 +1,255 @@
+#pragma once
+
+#include "warp_stages.hpp"
+#include "unit_square_distribution.hpp"
+#include "detail/simd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dist2d
+{
+namespace detail
+{
+
+
+template<int Dimension>
+struct default_warp_point;
+
+template<>
+struct default_warp_point<2>
+{
+  using type = std::pair<float,float>;
+};
+
+template<>
+struct default_warp_point<3>
+{
+  using type = std::tuple<float,float,float>;
+};
+
+
+} // end detail
+
+
+// a distribution of the points to which the warp pipeline Warp maps [0,1)^2, e.g.
+//
+//     auto cosine_around_n = make_warp_distribution(warps::square | warps::concentric_disk | warps::lift_to_hemisphere | warps::rotate_to(nx, ny, nz));
+//
+//     auto sample = cosine_around_n.sample_with_pdf(urn1, urn2);
+//
+// the pipeline is a single composed function, so no intermediate point is materialized, and each sample's
+// density is the product of the ratios its stages computed along the way
+//
+// Precision selects the type in which the pipeline is evaluated, and how its stages evaluate sin & cos, see precision.hpp
+// it is fast_precision by default, whose polynomials the vector kernels share: when the point's coordinates are floats
+// and every stage has a vector form, generate() then evaluates the whole pipeline in one vector kernel of detail/simd.hpp
+// with the same results as operator(); see warp_stages.hpp
+// with other policies, generate() evaluates the pipeline one sample at a time
+//
+// the batch arrays all hold real_type, the type of Point's first coordinate
+template<class Warp,
+         class Point = typename detail::default_warp_point<Warp::output_dimension>::type,
+         class Precision = fast_precision>
+class warp_distribution
+{
+  static_assert(std::is_same<typename Warp::input_domain, unit_square_domain>::value, "warp_distribution: Warp must map from [0,1)^2");
+  static_assert(Warp::output_dimension == int(std::tuple_size<Point>::value), "warp_distribution: Point must have Warp's output dimension");
+
+  public:
+    using result_type = Point;
+    using real_type = typename std::tuple_element<0,result_type>::type;
+
+  private:
+    using compute_type = typename Precision::template compute_type<real_type>;
+    using sample_type = warp_sample<compute_type,Precision>;
+
+  public:
+    constexpr explicit warp_distribution(const Warp& warp = Warp())
+      : warp_(warp)
+    {}
+
+    constexpr const Warp& warp() const
+    {
+      return warp_;
+    }
+
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      result_type
+    >::type
+      operator()(Float1 u1, Float2 u2) const
+    {
+      return sample_with_pdf(u1, u2).first;
+    }
+
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      result_type
+    >::type
+      operator()(Integer1 urn1, Integer2 urn2) const
+    {
+      return sample_with_pdf(urn1, urn2).first;
+    }
+
+    // returns operator()(u1, u2) with its density, the product of the pipeline's stages' density ratios
+    template<class Float1, class Float2>
+    constexpr typename std::enable_if<
+      std::is_floating_point<Float1>::value && std::is_floating_point<Float2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Float1 u1, Float2 u2) const
+    {
+      sample_type s{compute_type(u1), compute_type(u2), compute_type(0), compute_type(1)};
+      warp_(s);
+
+      return std::make_pair(point(s, dimension()), real_type(s.pdf));
+    }
+
+    template<class Integer1, class Integer2>
+    constexpr typename std::enable_if<
+      std::is_integral<Integer1>::value && std::is_integral<Integer2>::value,
+      std::pair<result_type,real_type>
+    >::type
+      sample_with_pdf(Integer1 urn1, Integer2 urn2) const
+    {
+      auto u = unit_square_distribution<std::pair<compute_type,compute_type>>()(urn1, urn2);
+
+      return sample_with_pdf(u.first, u.second);
+    }
+
+    template<class Integer,
+             class = typename std::enable_if<
+               std::is_integral<Integer>::value
+             >::type>
+    result_type operator()(Integer i) const
+    {
+      auto xy = morton_urns(i);
+      return operator()(xy.first, xy.second);
+    }
+
+    template<class Generator,
+             class = typename std::enable_if<
+               detail::is_integral_generator<Generator>::value
+             >::type>
+    result_type operator()(Generator& g) const
+    {
+      auto u = detail::unit_square_from_generator<compute_type,compute_type>(g);
+      return operator()(u.first, u.second);
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs and ys, and their densities to pdfs unless it is null
+    template<class Integer>
+    typename std::enable_if<
+      std::is_integral<Integer>::value && Warp::output_dimension == 2
+    >::type
+      generate(Integer first_index, std::size_t count, real_type* xs, real_type* ys, real_type* pdfs = nullptr) const
+    {
+      generate(first_index, count, xs, ys, nullptr, pdfs, use_simd_kernels());
+    }
+
+    // stores the coordinates of the points operator()(first_index), ..., operator()(first_index + count - 1)
+    // to the arrays xs, ys, and zs, and their densities to pdfs unless it is null
+    template<class Integer>
+    typename std::enable_if<
+      std::is_integral<Integer>::value && Warp::output_dimension == 3
+    >::type
+      generate(Integer first_index, std::size_t count, real_type* xs, real_type* ys, real_type* zs, real_type* pdfs = nullptr) const
+    {
+      generate(first_index, count, xs, ys, zs, pdfs, use_simd_kernels());
+    }
+
+  private:
+    using dimension = std::integral_constant<int, Warp::output_dimension>;
+
+    using use_simd_kernels = std::integral_constant<
+      bool,
+      std::is_same<real_type,float>::value &&
+      std::is_same<Precision,fast_precision>::value &&
+      detail::is_vector_warp<Warp>::value
+    >;
+
+    static constexpr result_type point(const sample_type& s, std::integral_constant<int,2>)
+    {
+      using real_type2 = typename std::tuple_element<1,result_type>::type;
+
+      return result_type{real_type(s.x), real_type2(s.y)};
+    }
+
+    static constexpr result_type point(const sample_type& s, std::integral_constant<int,3>)
+    {
+      using real_type2 = typename std::tuple_element<1,result_type>::type;
+      using real_type3 = typename std::tuple_element<2,result_type>::type;
+
+      return result_type{real_type(s.x), real_type2(s.y), real_type3(s.z)};
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type* xs, real_type* ys, real_type* zs, real_type* pdfs, std::false_type) const
+    {
+      for(std::size_t k = 0; k < count; ++k)
+      {
+        auto xy = morton_urns(static_cast<Integer>(first_index + k));
+
+        sample_type s{
+          unit_interval_distribution<compute_type>()(xy.first),
+          unit_interval_distribution<compute_type>()(xy.second),
+          compute_type(0),
+          compute_type(1)
+        };
+        warp_(s);
+
+        xs[k] = real_type(s.x);
+        ys[k] = real_type(s.y);
+        if(zs) zs[k] = real_type(s.z);
+        if(pdfs) pdfs[k] = real_type(s.pdf);
+      }
+    }
+
+    template<class Integer>
+    void generate(Integer first_index, std::size_t count, real_type* xs, real_type* ys, real_type* zs, real_type* pdfs, std::true_type) const
+    {
+      for(std::size_t i = 0; i < count; i += detail::simd::chunk_size)
+      {
+        std::size_t n = std::min(detail::simd::chunk_size, count - i);
+
+        // stage the chunk's points in [0,1)^2 in xs & ys and warp them in place
+        std::uint32_t urn1s[detail::simd::chunk_size], urn2s[detail::simd::chunk_size];
+        morton_urns_range(static_cast<std::uint64_t>(first_index) + i, n, urn1s, urn2s);
+
+        for(std::size_t k = 0; k < n; ++k)
+        {
+          xs[i + k] = unit_interval_distribution<float>()(urn1s[k]);
+          ys[i + k] = unit_interval_distribution<float>()(urn2s[k]);
+        }
+
+        detail::simd::warp_pipeline(warp_, xs + i, ys + i, n, xs + i, ys + i, zs ? zs + i : nullptr, pdfs ? pdfs + i : nullptr);
+      }
+    }
+
+    Warp warp_;
+};
+
+
+template<class Warp>
+constexpr warp_distribution<Warp> make_warp_distribution(const Warp& warp)
+{
+  return warp_distribution<Warp>(warp);
+}
+
+
+template<class Point, class Warp>
+constexpr warp_distribution<Warp,Point> make_warp_distribution(const Warp& warp)
+{
+  return warp_distribution<Warp,Point>(warp);
+}
+
+
+} // end dist2d
+
@@ -0,0 +1,357 @@
+#pragma once
+
+#include "precision.hpp"
+#include "detail/sincos.hpp"
+#include "detail/concentric_warp.hpp"
+#include "detail/constexpr_math.hpp"
+#include "detail/math_constants.hpp"
+#include "detail/orthonormal_basis.hpp"
+#include <algorithm>
+#include <type_traits>
+
+namespace dist2d
+{
+
+
+// the stages of warp pipelines, which compose with operator| into a single mapping from [0,1)^2, e.g.
+//
+//     auto warp = warps::square | warps::concentric_disk | warps::lift_to_hemisphere | warps::rotate_to(nx, ny, nz);
+//
+// is cosine-weighted sampling of the hemisphere around the unit vector (nx, ny, nz). see warp_pipeline.hpp
+//
+// a stage is any type with
+//
+//     using input_domain = ..., output_domain = ...;
+//     static constexpr int input_dimension, output_dimension;
+//     template<class Real, class Precision> void operator()(warp_sample<Real,Precision>& s) const;
+//
+// whose domains are the tags below, and whose operator() maps the point of s in place from its input domain to its
+// output domain, evaluating any sin & cos with Precision::sincos_turns, and multiplies its pdf by the ratio of the output density
+// to the input density, computed from the values the mapping produces, e.g. z for lift_to_hemisphere
+// a composed warp's pdf is thus the product of its stages' ratios
+//
+// the stages below also have vector forms in detail/simd.hpp, which evaluate the same operations in the same order
+// as fast_precision, so for float, a pipeline of them gives bitwise identical results in batch and one sample at a time
+// other stages compose with them, but their pipelines are evaluated one sample at a time
+
+
+// the domains of the stages, between which they map
+// a composition of stages must map each stage's output domain to the next stage's input domain,
+// or the density ratios of the stages would be measured against the wrong densities
+struct unit_square_domain { static constexpr int dimension = 2; };
+struct unit_disk_domain { static constexpr int dimension = 2; };
+
+// directions, of which the sphere & the hemisphere around +z are subsets
+// a stage whose input is any direction accepts either
+struct direction_domain { static constexpr int dimension = 3; };
+struct unit_sphere_domain : direction_domain {};
+struct unit_hemisphere_domain : direction_domain {};
+
+
+// a sample flowing through a warp pipeline: its point, of up to three coordinates, and its density
+// Precision selects how the stages evaluate sin & cos, see precision.hpp
+template<class Real, class Precision = fast_precision>
+struct warp_sample
+{
+  Real x, y, z;
+  Real pdf;
+};
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+
+// the identity on [0,1)^2, which begins a pipeline
+struct unit_square_warp
+{
+  using input_domain = unit_square_domain;
+  using output_domain = unit_square_domain;
+
+  static constexpr int input_dimension = input_domain::dimension;
+  static constexpr int output_dimension = output_domain::dimension;
+
+  template<class Real, class Precision>
+  constexpr void operator()(warp_sample<Real,Precision>&) const {}
+};
+
+
+// [0,1)^2 to the unit disk by the concentric mapping, evaluated as branchless_concentric_mapping does
+struct concentric_disk_warp
+{
+  using input_domain = unit_square_domain;
+  using output_domain = unit_disk_domain;
+
+  static constexpr int input_dimension = input_domain::dimension;
+  static constexpr int output_dimension = output_domain::dimension;
+
+  template<class Real, class Precision>
+  constexpr void operator()(warp_sample<Real,Precision>& s) const
+  {
+    DIST2D_FP_CONTRACT_OFF
+
+    detail::branchless_concentric_warp(s.x, s.y, s.x, s.y);
+    s.pdf *= Real(detail::math_constants::one_over_pi);
+  }
+};
+
+
+// [0,1)^2 to the unit disk by r = sqrt(u1), phi = 2 pi u2, as unit_disk_distribution maps it
+struct polar_disk_warp
+{
+  using input_domain = unit_square_domain;
+  using output_domain = unit_disk_domain;
+
+  static constexpr int input_dimension = input_domain::dimension;
+  static constexpr int output_dimension = output_domain::dimension;
+
+  template<class Real, class Precision>
+  constexpr void operator()(warp_sample<Real,Precision>& s) const
+  {
+    DIST2D_FP_CONTRACT_OFF
+
+    Real r = detail::sqrt(s.x);
+
+    Real sine = 0, cosine = 0;
+    Precision::sincos_turns(s.y, sine, cosine);
+
+    s.x = r * cosine;
+    s.y = r * sine;
+    s.pdf *= Real(detail::math_constants::one_over_pi);
+  }
+};
+
+
+// [0,1)^2 to the unit sphere, as unit_sphere_distribution maps it
+struct uniform_sphere_warp
+{
+  using input_domain = unit_square_domain;
+  using output_domain = unit_sphere_domain;
+
+  static constexpr int input_dimension = input_domain::dimension;
+  static constexpr int output_dimension = output_domain::dimension;
+
+  template<class Real, class Precision>
+  constexpr void operator()(warp_sample<Real,Precision>& s) const
+  {
+    DIST2D_FP_CONTRACT_OFF
+
+    Real z = Real(1) - Real(2) * s.x;
+    Real r = detail::sqrt(std::max(Real(0), Real(1) - z*z));
+
+    Real sine = 0, cosine = 0;
+    Precision::sincos_turns(s.y, sine, cosine);
+
+    s.x = r * cosine;
+    s.y = r * sine;
+    s.z = z;
+    s.pdf *= Real(detail::math_constants::one_over_four_pi);
+  }
+};
+
+
+// [0,1)^2 to the unit hemisphere around +z, as unit_hemisphere_distribution maps it
+struct uniform_hemisphere_warp
+{
+  using input_domain = unit_square_domain;
+  using output_domain = unit_hemisphere_domain;
+
+  static constexpr int input_dimension = input_domain::dimension;
+  static constexpr int output_dimension = output_domain::dimension;
+
+  template<class Real, class Precision>
+  constexpr void operator()(warp_sample<Real,Precision>& s) const
+  {
+    DIST2D_FP_CONTRACT_OFF
+
+    Real z = s.x;
+    Real r = detail::sqrt(std::max(Real(0), Real(1) - z*z));
+
+    Real sine = 0, cosine = 0;
+    Precision::sincos_turns(s.y, sine, cosine);
+
+    s.x = r * cosine;
+    s.y = r * sine;
+    s.z = z;
+    s.pdf *= Real(detail::math_constants::one_over_two_pi);
+  }
+};
+
+
+// the unit disk to the unit hemisphere around +z by vertical projection (Malley's method)
+// density with respect to area on the disk becomes density with respect to solid angle, times cos(theta) = z
+struct lift_to_hemisphere_warp
+{
+  using input_domain = unit_disk_domain;
+  using output_domain = unit_hemisphere_domain;
+
+  static constexpr int input_dimension = input_domain::dimension;
+  static constexpr int output_dimension = output_domain::dimension;
+
+  template<class Real, class Precision>
+  constexpr void operator()(warp_sample<Real,Precision>& s) const
+  {
+    s.z = detail::lift_to_hemisphere(s.x, s.y);
+    s.pdf *= s.z;
+  }
+};
+
+
+// rotates directions from the frame around +z to the frame around a unit normal, which preserves density
+// the basis is built once, by detail::orthonormal_basis
+// a rotated hemisphere is no longer the one around +z, so the output's domain is only directions
+template<class Real>
+struct rotate_to_frame_warp
+{
+  using input_domain = direction_domain;
+  using output_domain = direction_domain;
+
+  static constexpr int input_dimension = input_domain::dimension;
+  static constexpr int output_dimension = output_domain::dimension;
+
+  Real nx, ny, nz;
+  Real t1x, t1y, t1z;
+  Real t2x, t2y, t2z;
+
+  constexpr rotate_to_frame_warp(Real nx, Real ny, Real nz)
+    : nx(nx), ny(ny), nz(nz),
+      t1x(0), t1y(0), t1z(0),
+      t2x(0), t2y(0), t2z(0)
+  {
+    detail::orthonormal_basis(nx, ny, nz, t1x, t1y, t1z, t2x, t2y, t2z);
+  }
+
+  // a sample of another Real, e.g. of double_precision, is rotated in its own type
+  template<class SampleReal, class Precision>
+  constexpr void operator()(warp_sample<SampleReal,Precision>& s) const
+  {
+    DIST2D_FP_CONTRACT_OFF
+
+    SampleReal x = s.x, y = s.y, z = s.z;
+
+    s.x = x * SampleReal(t1x) + y * SampleReal(t2x) + z * SampleReal(nx);
+    s.y = x * SampleReal(t1y) + y * SampleReal(t2y) + z * SampleReal(ny);
+    s.z = x * SampleReal(t1z) + y * SampleReal(t2z) + z * SampleReal(nz);
+  }
+};
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+
+template<class T, class = void>
+struct is_warp : std::false_type {};
+
+template<class T>
+struct is_warp<T, decltype(void(sizeof(typename T::input_domain) + sizeof(typename T::output_domain) + T::input_dimension + T::output_dimension))> : std::true_type {};
+
+
+// true when Second may follow First in a pipeline, i.e. First's output domain is Second's input domain, or a subset of it
+template<class First, class Second>
+struct is_composable_warp
+  : std::is_base_of<typename Second::input_domain, typename First::output_domain>
+{};
+
+
+// First followed by Second
+template<class First, class Second>
+class composed_warp
+{
+  static_assert(is_composable_warp<First,Second>::value, "composed_warp: the output domain of First must be the input domain of Second");
+
+  public:
+    using input_domain = typename First::input_domain;
+    using output_domain = typename Second::output_domain;
+
+    static constexpr int input_dimension = First::input_dimension;
+    static constexpr int output_dimension = Second::output_dimension;
+
+    constexpr composed_warp(const First& first, const Second& second)
+      : first_(first),
+        second_(second)
+    {}
+
+    constexpr const First& first() const
+    {
+      return first_;
+    }
+
+    constexpr const Second& second() const
+    {
+      return second_;
+    }
+
+    template<class Real, class Precision>
+    constexpr void operator()(warp_sample<Real,Precision>& s) const
+    {
+      first_(s);
+      second_(s);
+    }
+
+  private:
+    First first_;
+    Second second_;
+};
+
+
+template<class First, class Second,
+         class = typename std::enable_if<
+           is_warp<First>::value && is_warp<Second>::value
+         >::type>
+constexpr composed_warp<First,Second> operator|(const First& first, const Second& second)
+{
+  return composed_warp<First,Second>(first, second);
+}
+
+
+namespace warps
+{
+
+
+constexpr unit_square_warp square{};
+constexpr concentric_disk_warp concentric_disk{};
+constexpr polar_disk_warp polar_disk{};
+constexpr uniform_sphere_warp uniform_sphere{};
+constexpr uniform_hemisphere_warp uniform_hemisphere{};
+constexpr lift_to_hemisphere_warp lift_to_hemisphere{};
+
+
+template<class Real>
+constexpr rotate_to_frame_warp<Real> rotate_to(Real nx, Real ny, Real nz)
+{
+  return rotate_to_frame_warp<Real>(nx, ny, nz);
+}
+
+
+} // end warps
+
+
+namespace detail
+{
+
+
+// true when the vector kernels of simd.hpp can evaluate the pipeline Warp on floats
+template<class Warp>
+struct is_vector_warp : std::false_type {};
+
+template<> struct is_vector_warp<unit_square_warp> : std::true_type {};
+template<> struct is_vector_warp<concentric_disk_warp> : std::true_type {};
+template<> struct is_vector_warp<polar_disk_warp> : std::true_type {};
+template<> struct is_vector_warp<uniform_sphere_warp> : std::true_type {};
+template<> struct is_vector_warp<uniform_hemisphere_warp> : std::true_type {};
+template<> struct is_vector_warp<lift_to_hemisphere_warp> : std::true_type {};
+template<> struct is_vector_warp<rotate_to_frame_warp<float>> : std::true_type {};
+
+template<class First, class Second>
+struct is_vector_warp<composed_warp<First,Second>>
+  : std::integral_constant<bool, is_vector_warp<First>::value && is_vector_warp<Second>::value>
+{};
+
+
+} // end detail
+} // end dist2d
+
@@ -0,0 +1,1455 @@
+#include "distribution2d/unit_square_distribution.hpp"
+#include "distribution2d/unit_disk_distribution.hpp"
+#include "distribution2d/concentric_unit_disk_distribution.hpp"
+#include "distribution2d/unit_sphere_distribution.hpp"
+#include "distribution2d/unit_hemisphere_distribution.hpp"
+#include "distribution2d/cosine_weighted_unit_hemisphere_distribution.hpp"
+#include "distribution2d/unit_isoceles_right_triangle_distribution.hpp"
+#include "distribution2d/piecewise_constant_2d_distribution.hpp"
+#include "distribution2d/spherical_triangle_distribution.hpp"
+#include "distribution2d/spherical_rectangle_distribution.hpp"
+#include "distribution2d/mesh_surface_distribution.hpp"
+#include "distribution2d/warp_pipeline.hpp"
+#include "distribution2d/packed_point.hpp"
+#include "distribution2d/counter_based_generator.hpp"
+#include "distribution2d/sobol_sequence.hpp"
+#include "distribution2d/execution.hpp"
+#include "distribution2d/detail/parallel_for.hpp"
+#include "distribution2d/detail/orthonormal_basis.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// statistical validation of every distribution
+//
+// usage: validate [--distribution=<name>] [--samples=<n>] [--threads=<n>] [--seed=<n>]
+//
+// for each distribution, this
+//
+// * bins samples in the distribution's own parameter space, e.g. (r, phi) for the disks, and compares the counts
+//   with the integral of probability_density() over each bin with a chi-square test
+// * compares each marginal of the parameters with the integral of probability_density() with a Kolmogorov-Smirnov test
+// * checks that probability_density() integrates to 1, and that area() is the area of its support
+// * measures the star discrepancy of Sobol points mapped through the distribution and back through inverse(),
+//   which remains that of the Sobol points when the mapping preserves their stratification
+// * checks that the batch generate() agrees with operator(), that its points are distinct and spread over every part
+//   of the distribution, and that sample_with_pdf() agrees with operator() and probability_density()
+// * checks that the hemispheres' generate() around normals agrees with generate() followed by a rotation in double
+// * checks that the packing kernels of every instruction set this processor supports pack the float points of generate()
+//   to the same codes as the constructors of the types of packed_point.hpp
+//
+// the samples are drawn in parallel with counter_based_engine, so the results don't depend on the number of threads
+// the throughput of operator(), generate(), and of the statistical test itself is reported in samples per second,
+// so that the accuracy of a faster variant can be measured along with its speed
+//
+// a test fails when its p-value is below the 1% significance level, corrected for the number of tests,
+// and the exit status is nonzero if any test fails
+
+
+const double pi = 3.14159265358979323846;
+const double two_pi = 2 * pi;
+
+
+struct options
+{
+  std::string distribution;
+  std::uint64_t samples = std::uint64_t(1) << 22;
+  std::size_t threads = 0;
+  std::uint64_t seed = 0;
+
+  // each test's significance level, set once the number of tests is known
+  double significance = 0.01;
+};
+
+
+// the number of bins along each axis of the parameter space
+// the chi-square test merges these into coarser bins, and the Kolmogorov-Smirnov tests compare the marginals at their edges
+const std::size_t fine_bins = 256;
+const std::size_t coarse_bins = 32;
+
+// the number of Sobol points of the star discrepancy
+const std::size_t discrepancy_points = 1024;
+
+// the number of points with which generate() is compared to operator()
+const std::size_t batch_points = std::size_t(1) << 18;
+
+// the number of bins along each axis in which generate()'s batch must leave no bin empty
+// the batch is a lattice 512 points wide, so these are coarse enough that its image reaches every bin
+const std::size_t spread_bins = 8;
+
+
+// the parameterizations map (s, t) in [0,1)^2 to a point of each distribution's domain
+
+// returns the angle of (x, y) counterclockwise from the positive x axis in [0,1) turns
+double turns(double y, double x)
+{
+  double t = std::atan2(y, x) / two_pi;
+  return t < 0 ? t + 1 : t;
+}
+
+
+struct square_parameterization
+{
+  // stores the point at (s, t) to p and returns the Jacobian determinant of the mapping there
+  static double point(double s, double t, double* p)
+  {
+    p[0] = s;
+    p[1] = t;
+    return 1;
+  }
+
+  static void parameters(const double* p, double& s, double& t)
+  {
+    s = p[0];
+    t = p[1];
+  }
+};
+
+
+// (r, phi)
+struct polar_parameterization
+{
+  static double point(double s, double t, double* p)
+  {
+    p[0] = s * std::cos(two_pi * t);
+    p[1] = s * std::sin(two_pi * t);
+    return two_pi * s;
+  }
+
+  static void parameters(const double* p, double& s, double& t)
+  {
+    s = std::sqrt(p[0] * p[0] + p[1] * p[1]);
+    t = turns(p[1], p[0]);
+  }
+};
+
+
+// (x, y / (1 - x))
+struct triangle_parameterization
+{
+  static double point(double s, double t, double* p)
+  {
+    p[0] = s;
+    p[1] = t * (1 - s);
+    return 1 - s;
+  }
+
+  static void parameters(const double* p, double& s, double& t)
+  {
+    s = p[0];
+    t = p[0] < 1 ? p[1] / (1 - p[0]) : 0;
+  }
+};
+
+
+// ((z + 1) / 2, phi)
+struct sphere_parameterization
+{
+  static double point(double s, double t, double* p)
+  {
+    double z = 2 * s - 1;
+    double r = std::sqrt(std::max(0., 1 - z * z));
+
+    p[0] = r * std::cos(two_pi * t);
+    p[1] = r * std::sin(two_pi * t);
+    p[2] = z;
+    return 2 * two_pi;
+  }
+
+  static void parameters(const double* p, double& s, double& t)
+  {
+    s = (p[2] + 1) / 2;
+    t = turns(p[1], p[0]);
+  }
+};
+
+
+// (z, phi)
+struct hemisphere_parameterization
+{
+  static double point(double s, double t, double* p)
+  {
+    double r = std::sqrt(std::max(0., 1 - s * s));
+
+    p[0] = r * std::cos(two_pi * t);
+    p[1] = r * std::sin(two_pi * t);
+    p[2] = s;
+    return two_pi;
+  }
+
+  static void parameters(const double* p, double& s, double& t)
+  {
+    s = p[2];
+    t = turns(p[1], p[0]);
+  }
+};
+
+
+// the spherical triangle and rectangle of the solid angle distributions, seen from the origin
+const double spherical_triangle[3][3] = {{1, 0.2, 0.3}, {0.1, 1, 0.2}, {0.3, 0.4, 1}};
+const double spherical_rectangle[3][3] = {{-0.7, -0.4, 1}, {1.6, 0, 0.3}, {0, 1.2, 0}};
+
+
+double dot(const double* a, const double* b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+void cross(const double* a, const double* b, double* c)
+{
+  c[0] = a[1] * b[2] - a[2] * b[1];
+  c[1] = a[2] * b[0] - a[0] * b[2];
+  c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+
+// the directions toward q = a + s e1 + t e2 on the plane of a parallelogram (x, y) or, by Duffy's map, a triangle (x, x y)
+// the Jacobian is that of the parameters to the plane, times |n . q| / |q|^3 from the plane to solid angle
+struct planar_solid_angle
+{
+  static double point(const double* a, const double* e1, const double* e2, double s, double t, double* p)
+  {
+    double q[3], n[3];
+    for(int i = 0; i < 3; ++i) q[i] = a[i] + s * e1[i] + t * e2[i];
+    cross(e1, e2, n);
+
+    double length = std::sqrt(dot(q, q));
+    for(int i = 0; i < 3; ++i) p[i] = q[i] / length;
+
+    return std::fabs(dot(n, q)) / (length * length * length);
+  }
+
+  // the (s, t) of the point where the direction p meets the plane
+  static void parameters(const double* a, const double* e1, const double* e2, const double* p, double& s, double& t)
+  {
+    double n[3], w[3], c[3];
+    cross(e1, e2, n);
+
+    double scale = dot(n, a) / dot(n, p);
+    for(int i = 0; i < 3; ++i) w[i] = scale * p[i] - a[i];
+
+    double nn = dot(n, n);
+    cross(w, e2, c);
+    s = dot(c, n) / nn;
+    cross(e1, w, c);
+    t = dot(c, n) / nn;
+  }
+};
+
+
+// (s, t / s) of the spherical_triangle's vertices a + s (b - a) + t (c - b), projected from its plane
+struct spherical_triangle_parameterization
+{
+  static void vertices(double* a, double* e1, double* e2)
+  {
+    double v[3][3];
+    for(int j = 0; j < 3; ++j)
+    {
+      double length = std::sqrt(dot(spherical_triangle[j], spherical_triangle[j]));
+      for(int i = 0; i < 3; ++i) v[j][i] = spherical_triangle[j][i] / length;
+    }
+
+    for(int i = 0; i < 3; ++i)
+    {
+      a[i] = v[0][i];
+      e1[i] = v[1][i] - v[0][i];
+      e2[i] = v[2][i] - v[1][i];
+    }
+  }
+
+  static double point(double s, double t, double* p)
+  {
+    double a[3], e1[3], e2[3];
+    vertices(a, e1, e2);
+    return s * planar_solid_angle::point(a, e1, e2, s, s * t, p);
+  }
+
+  static void parameters(const double* p, double& s, double& t)
+  {
+    double a[3], e1[3], e2[3];
+    vertices(a, e1, e2);
+    planar_solid_angle::parameters(a, e1, e2, p, s, t);
+    t = s > 0 ? t / s : 0;
+  }
+};
+
+
+// (x, y) of the spherical_rectangle's corner + x ex + y ey, projected from its plane
+struct spherical_rectangle_parameterization
+{
+  static double point(double s, double t, double* p)
+  {
+    return planar_solid_angle::point(spherical_rectangle[0], spherical_rectangle[1], spherical_rectangle[2], s, t, p);
+  }
+
+  static void parameters(const double* p, double& s, double& t)
+  {
+    planar_solid_angle::parameters(spherical_rectangle[0], spherical_rectangle[1], spherical_rectangle[2], p, s, t);
+  }
+};
+
+
+template<class Point>
+using dimension = std::integral_constant<int, int(std::tuple_size<Point>::value)>;
+
+
+template<class Point>
+void coordinates(const Point& p, double* c, std::integral_constant<int,2>)
+{
+  c[0] = double(std::get<0>(p));
+  c[1] = double(std::get<1>(p));
+  c[2] = 0;
+}
+
+template<class Point>
+void coordinates(const Point& p, double* c, std::integral_constant<int,3>)
+{
+  c[0] = double(std::get<0>(p));
+  c[1] = double(std::get<1>(p));
+  c[2] = double(std::get<2>(p));
+}
+
+
+template<class Distribution, class Real>
+void probability_density(const Distribution& dist, std::size_t n, const Real* xs, const Real* ys, const Real*, Real* pdfs, std::integral_constant<int,2>)
+{
+  dist.probability_density(n, xs, ys, pdfs);
+}
+
+template<class Distribution, class Real>
+void probability_density(const Distribution& dist, std::size_t n, const Real* xs, const Real* ys, const Real* zs, Real* pdfs, std::integral_constant<int,3>)
+{
+  dist.probability_density(n, xs, ys, zs, pdfs);
+}
+
+
+template<class Distribution, class Real>
+void generate(const Distribution& dist, std::uint64_t first, std::size_t n, Real* xs, Real* ys, Real*, std::integral_constant<int,2>)
+{
+  dist.generate(first, n, xs, ys);
+}
+
+template<class Distribution, class Real>
+void generate(const Distribution& dist, std::uint64_t first, std::size_t n, Real* xs, Real* ys, Real* zs, std::integral_constant<int,3>)
+{
+  dist.generate(first, n, xs, ys, zs);
+}
+
+
+template<class Distribution, class = void>
+struct has_frame_generate : std::false_type {};
+
+template<class Distribution>
+struct has_frame_generate<
+  Distribution,
+  decltype(void(std::declval<const Distribution&>().generate(
+    std::uint64_t(0), std::size_t(0),
+    std::declval<const typename Distribution::real_type*>(),
+    std::declval<const typename Distribution::real_type*>(),
+    std::declval<const typename Distribution::real_type*>(),
+    std::declval<typename Distribution::real_type*>(),
+    std::declval<typename Distribution::real_type*>(),
+    std::declval<typename Distribution::real_type*>())))
+> : std::true_type {};
+
+
+template<class Distribution, class = void>
+struct has_inverse : std::false_type {};
+
+template<class Distribution>
+struct has_inverse<Distribution, decltype(void(std::declval<const Distribution&>().inverse(std::declval<typename Distribution::result_type>())))> : std::true_type {};
+
+
+// returns the probability of each fine bin, integrating probability_density() with 3 point Gauss-Legendre quadrature
+// in each dimension of each bin
+// the area of the domain where probability_density() is positive is stored to area
+template<class Parameterization, class Distribution>
+std::vector<double> bin_probabilities(const Distribution& dist, double& area)
+{
+  using real = typename Distribution::real_type;
+  using dim = dimension<typename Distribution::result_type>;
+
+  const double nodes[3] = {0.5 - 0.5 * std::sqrt(0.6), 0.5, 0.5 + 0.5 * std::sqrt(0.6)};
+  const double weights[3] = {5. / 18, 8. / 18, 5. / 18};
+  const std::size_t points_per_row = fine_bins * 9;
+  const double cell_area = 1. / double(fine_bins * fine_bins);
+
+  std::vector<double> result(fine_bins * fine_bins, 0);
+  std::vector<real> xs(points_per_row), ys(points_per_row), zs(points_per_row), pdfs(points_per_row);
+  std::vector<double> jacobians(points_per_row);
+
+  area = 0;
+
+  for(std::size_t i = 0; i < fine_bins; ++i)
+  {
+    // evaluate the row of bins with a single batch of probability_density()
+    for(std::size_t j = 0, k = 0; j < fine_bins; ++j)
+    {
+      for(int a = 0; a < 3; ++a)
+      {
+        for(int b = 0; b < 3; ++b, ++k)
+        {
+          double p[3] = {};
+          jacobians[k] = Parameterization::point((i + nodes[a]) / fine_bins, (j + nodes[b]) / fine_bins, p);
+
+          xs[k] = real(p[0]);
+          ys[k] = real(p[1]);
+          zs[k] = real(p[2]);
+        }
+      }
+    }
+
+    probability_density(dist, points_per_row, xs.data(), ys.data(), zs.data(), pdfs.data(), dim());
+
+    for(std::size_t j = 0, k = 0; j < fine_bins; ++j)
+    {
+      for(int a = 0; a < 3; ++a)
+      {
+        for(int b = 0; b < 3; ++b, ++k)
+        {
+          double w = weights[a] * weights[b] * cell_area * jacobians[k];
+
+          result[i * fine_bins + j] += w * double(pdfs[k]);
+          if(pdfs[k] > 0) area += w;
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+
+std::size_t fine_bin(double x)
+{
+  // NaN lands in bin 0
+  return x > 0 ? std::min(static_cast<std::size_t>(x * fine_bins), fine_bins - 1) : 0;
+}
+
+
+// counts options.samples samples of dist in each fine bin
+template<class Parameterization, class Distribution>
+std::vector<std::uint64_t> bin_samples(const Distribution& dist, const options& opts)
+{
+  using dim = dimension<typename Distribution::result_type>;
+
+  const std::size_t grain_size = std::size_t(1) << 20;
+
+  std::vector<std::uint64_t> result(fine_bins * fine_bins, 0);
+  std::mutex result_mutex;
+
+  dist2d::detail::parallel_for(dist2d::execution::parallel_policy(opts.threads, grain_size), opts.samples, grain_size, [&](std::size_t begin, std::size_t end)
+  {
+    // each grain's samples are a stream of its own
+    dist2d::counter_based_engine<> g(opts.seed, begin);
+
+    std::vector<std::uint32_t> counts(fine_bins * fine_bins, 0);
+
+    for(std::size_t k = begin; k < end; ++k)
+    {
+      double p[3];
+      coordinates(dist(g), p, dim());
+
+      double s, t;
+      Parameterization::parameters(p, s, t);
+
+      ++counts[fine_bin(s) * fine_bins + fine_bin(t)];
+    }
+
+    std::lock_guard<std::mutex> lock(result_mutex);
+    for(std::size_t i = 0; i < counts.size(); ++i)
+    {
+      result[i] += counts[i];
+    }
+  });
+
+  return result;
+}
+
+
+// the regularized upper incomplete gamma function Q(a, x)
+// see Press et al., Numerical Recipes, 6.2
+double incomplete_gamma_q(double a, double x)
+{
+  if(x <= 0) return 1;
+
+  double log_prefactor = -x + a * std::log(x) - std::lgamma(a);
+
+  if(x < a + 1)
+  {
+    // the series of P(a, x)
+    double term = 1 / a;
+    double sum = term;
+    for(int n = 1; n < 10000 && std::fabs(term) > std::fabs(sum) * 1e-15; ++n)
+    {
+      term *= x / (a + n);
+      sum += term;
+    }
+
+    return 1 - sum * std::exp(log_prefactor);
+  }
+
+  // the continued fraction of Q(a, x) by Lentz's method
+  const double tiny = 1e-300;
+  double b = x + 1 - a;
+  double c = 1 / tiny;
+  double d = 1 / b;
+  double h = d;
+  for(int n = 1; n < 10000; ++n)
+  {
+    double an = -n * (n - a);
+    b += 2;
+    d = an * d + b;
+    if(std::fabs(d) < tiny) d = tiny;
+    c = b + an / c;
+    if(std::fabs(c) < tiny) c = tiny;
+    d = 1 / d;
+    double delta = d * c;
+    h *= delta;
+    if(std::fabs(delta - 1) < 1e-15) break;
+  }
+
+  return std::exp(log_prefactor) * h;
+}
+
+
+// the p-value of Pearson's chi-square test of the observed counts of the coarse bins against their expected counts
+// bins expected to contain fewer than 5 samples are pooled, as are bins expected to contain none
+double chi_square_test(const std::vector<std::uint64_t>& observed, const std::vector<double>& probabilities, std::uint64_t n)
+{
+  const std::size_t ratio = fine_bins / coarse_bins;
+
+  std::vector<double> coarse_observed(coarse_bins * coarse_bins, 0), coarse_expected(coarse_bins * coarse_bins, 0);
+  for(std::size_t i = 0; i < fine_bins; ++i)
+  {
+    for(std::size_t j = 0; j < fine_bins; ++j)
+    {
+      std::size_t c = (i / ratio) * coarse_bins + j / ratio;
+      coarse_observed[c] += double(observed[i * fine_bins + j]);
+      coarse_expected[c] += probabilities[i * fine_bins + j] * double(n);
+    }
+  }
+
+  double statistic = 0;
+  double pooled_observed = 0, pooled_expected = 0;
+  int degrees_of_freedom = -1;
+
+  for(std::size_t c = 0; c < coarse_observed.size(); ++c)
+  {
+    if(coarse_expected[c] < 5)
+    {
+      pooled_observed += coarse_observed[c];
+      pooled_expected += coarse_expected[c];
+    }
+    else
+    {
+      double difference = coarse_observed[c] - coarse_expected[c];
+      statistic += difference * difference / coarse_expected[c];
+      ++degrees_of_freedom;
+    }
+  }
+
+  if(pooled_expected > 0)
+  {
+    double difference = pooled_observed - pooled_expected;
+    statistic += difference * difference / pooled_expected;
+    ++degrees_of_freedom;
+  }
+  else if(pooled_observed > 0)
+  {
+    // samples where the density is 0
+    return 0;
+  }
+
+  return degrees_of_freedom > 0 ? incomplete_gamma_q(0.5 * degrees_of_freedom, 0.5 * statistic) : 1;
+}
+
+
+// the asymptotic p-value of the Kolmogorov-Smirnov statistic d of n samples
+// see Press et al., Numerical Recipes, 14.3
+double kolmogorov_smirnov_p_value(double d, std::uint64_t n)
+{
+  double sqrt_n = std::sqrt(double(n));
+  double lambda = (sqrt_n + 0.12 + 0.11 / sqrt_n) * d;
+
+  if(lambda < 0.2) return 1;
+
+  double sum = 0;
+  double sign = 1;
+  for(int j = 1; j <= 100; ++j)
+  {
+    double term = sign * std::exp(-2 * j * j * lambda * lambda);
+    sum += term;
+    if(std::fabs(term) < 1e-16) break;
+    sign = -sign;
+  }
+
+  return std::min(1., std::max(0., 2 * sum));
+}
+
+
+// the p-value of the Kolmogorov-Smirnov test of the marginal of parameter s (axis 0) or t (axis 1)
+// the statistic is the largest difference of the distribution functions at the edges of the fine bins
+double kolmogorov_smirnov_test(const std::vector<std::uint64_t>& observed, const std::vector<double>& probabilities, std::uint64_t n, int axis)
+{
+  std::vector<double> marginal_observed(fine_bins, 0), marginal_probability(fine_bins, 0);
+  for(std::size_t i = 0; i < fine_bins; ++i)
+  {
+    for(std::size_t j = 0; j < fine_bins; ++j)
+    {
+      std::size_t m = axis == 0 ? i : j;
+      marginal_observed[m] += double(observed[i * fine_bins + j]);
+      marginal_probability[m] += probabilities[i * fine_bins + j];
+    }
+  }
+
+  double total_probability = 0;
+  for(double p : marginal_probability) total_probability += p;
+
+  double d = 0;
+  double cdf_observed = 0, cdf_expected = 0;
+  for(std::size_t m = 0; m + 1 < fine_bins; ++m)
+  {
+    cdf_observed += marginal_observed[m] / double(n);
+    cdf_expected += marginal_probability[m] / total_probability;
+    d = std::max(d, std::fabs(cdf_observed - cdf_expected));
+  }
+
+  return kolmogorov_smirnov_p_value(d, n);
+}
+
+
+// the star discrepancy of points in [0,1)^2, the largest difference between the fraction of the points
+// within a box [0,a) x [0,b) and its area ab
+// this evaluates every box whose corner lies at the points' coordinates exactly
+double star_discrepancy(const std::vector<std::pair<double,double>>& points)
+{
+  std::vector<double> xs, ys;
+  for(const auto& p : points)
+  {
+    xs.push_back(p.first);
+    ys.push_back(p.second);
+  }
+  xs.push_back(1);
+  ys.push_back(1);
+
+  std::sort(xs.begin(), xs.end());
+  xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+  std::sort(ys.begin(), ys.end());
+  ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+  // count[i][j] is the number of points with x <= xs[i] and y <= ys[j]
+  std::vector<std::uint32_t> count(xs.size() * ys.size(), 0);
+  for(const auto& p : points)
+  {
+    std::size_t i = std::lower_bound(xs.begin(), xs.end(), p.first) - xs.begin();
+    std::size_t j = std::lower_bound(ys.begin(), ys.end(), p.second) - ys.begin();
+    ++count[i * ys.size() + j];
+  }
+
+  for(std::size_t i = 0; i < xs.size(); ++i)
+  {
+    for(std::size_t j = 0; j < ys.size(); ++j)
+    {
+      std::uint32_t sum = count[i * ys.size() + j];
+      if(i > 0) sum += count[(i - 1) * ys.size() + j];
+      if(j > 0) sum += count[i * ys.size() + j - 1];
+      if(i > 0 && j > 0) sum -= count[(i - 1) * ys.size() + j - 1];
+      count[i * ys.size() + j] = sum;
+    }
+  }
+
+  double n = double(points.size());
+  double result = 0;
+  for(std::size_t i = 0; i < xs.size(); ++i)
+  {
+    for(std::size_t j = 0; j < ys.size(); ++j)
+    {
+      double area = xs[i] * ys[j];
+
+      // the closed box [0,a] x [0,b] may contain too many points, and the open box [0,a) x [0,b) too few
+      double closed = count[i * ys.size() + j] / n;
+      double open = (i > 0 && j > 0) ? count[(i - 1) * ys.size() + j - 1] / n : 0;
+
+      result = std::max(result, std::max(closed - area, area - open));
+    }
+  }
+
+  return result;
+}
+
+
+// returns the star discrepancies of the Sobol points, and of the Sobol points mapped through dist and back through inverse()
+template<class Distribution>
+std::pair<double,double> discrepancies(const Distribution& dist, std::true_type)
+{
+  using real = typename Distribution::real_type;
+
+  dist2d::sobol_sequence sobol;
+  std::vector<std::pair<double,double>> inputs, outputs;
+
+  for(std::uint32_t i = 0; i < discrepancy_points; ++i)
+  {
+    auto urns = sobol(i);
+    inputs.emplace_back(dist2d::unit_interval_distribution<real>()(urns.first), dist2d::unit_interval_distribution<real>()(urns.second));
+
+    auto u = dist.inverse(dist(urns.first, urns.second));
+    outputs.emplace_back(double(u.first), double(u.second));
+  }
+
+  return std::make_pair(star_discrepancy(inputs), star_discrepancy(outputs));
+}
+
+
+// distributions without inverse() aren't measured
+template<class Distribution>
+std::pair<double,double> discrepancies(const Distribution&, std::false_type)
+{
+  return std::make_pair(-1., -1.);
+}
+
+
+struct report
+{
+  std::string name;
+
+  double chi_square_p;
+  double kolmogorov_smirnov_p[2];
+  double probability_integral;
+  double area, expected_area;
+
+  // negative when not measured
+  double input_discrepancy, discrepancy;
+
+  double batch_error;
+
+  // the number of spread bins which generate()'s batch is expected to put at least 16 points in but leaves empty,
+  // and the number of its points which repeat another
+  // the empty bins are 0, and the repeats 0 or few, unless the batch agrees with operator() but collapses onto part of
+  // the distribution
+  long long batch_empty_bins, batch_duplicates;
+
+  // the largest relative difference of sample_with_pdf()'s density from probability_density()
+  double pdf_error;
+
+  // the largest difference of generate() around normals from generate() rotated in double, negative when not measured
+  double frame_error;
+
+  // the number of points some packing kernel packs differently from the packed types' constructors, negative when not measured
+  long long packing_mismatches;
+
+  // samples per second
+  double operator_rate, generate_rate, test_rate;
+
+  std::vector<std::string> failures;
+};
+
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// the packing kernels of detail/simd.hpp for one instruction set
+struct packing_kernels
+{
+  const char* name;
+  void (*half2)(const float*, const float*, std::size_t, std::uint16_t*);
+  void (*half3)(const float*, const float*, const float*, std::size_t, std::uint16_t*);
+  void (*unorm16)(const float*, const float*, std::size_t, float, float, std::uint16_t*);
+  void (*octahedral)(const float*, const float*, const float*, std::size_t, std::uint16_t*);
+};
+
+
+// the portable kernels and those of each instruction set this processor supports, whatever selected_isa() chooses
+std::vector<packing_kernels> supported_packing_kernels()
+{
+  namespace simd = dist2d::detail::simd;
+
+  std::vector<packing_kernels> result;
+  result.push_back(packing_kernels{"scalar", simd::scalar::pack_half, simd::scalar::pack_half, simd::scalar::pack_unorm16, simd::scalar::pack_octahedral});
+
+#if defined(DIST2D_HAS_X86_SIMD)
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("sse2"))
+  {
+    result.push_back(packing_kernels{"sse2", simd::sse2::pack_half, simd::sse2::pack_half, simd::sse2::pack_unorm16, simd::sse2::pack_octahedral});
+  }
+
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c"))
+  {
+    result.push_back(packing_kernels{"avx2", simd::avx2::pack_half, simd::avx2::pack_half, simd::avx2::pack_unorm16, simd::avx2::pack_octahedral});
+  }
+
+  if(__builtin_cpu_supports("avx512f"))
+  {
+    result.push_back(packing_kernels{"avx512", simd::avx512::pack_half, simd::avx512::pack_half, simd::avx512::pack_unorm16, simd::avx512::pack_octahedral});
+  }
+#endif
+
+  return result;
+}
+
+
+template<class Packed>
+bool same_codes(const Packed& expected, const std::uint16_t* codes)
+{
+  return std::memcmp(&expected, codes, sizeof(Packed)) == 0;
+}
+
+
+// counts the points (xs[k], ys[k]) which some packing kernel packs differently from the constructors of half2 & unorm16_disk_point
+// the points are followed by a few the distributions don't produce: signed zeros, half's subnormals & overflow, and values
+// beyond unorm16's range
+long long compare_packing(std::vector<float> xs, std::vector<float> ys, std::vector<float>, std::integral_constant<int,2>)
+{
+  const float specials[] = {0.f, -0.f, 1.f, -1.f, 3e-8f, -6e-6f, 65504.f, 65520.f, -70000.f, 1.5f, -2.f, 0.99999f};
+  for(float x : specials)
+  {
+    for(float y : specials)
+    {
+      xs.push_back(x);
+      ys.push_back(y);
+    }
+  }
+
+  const std::size_t n = xs.size();
+  std::vector<std::uint16_t> codes(2 * n);
+
+  long long mismatches = 0;
+  for(const auto& kernels : supported_packing_kernels())
+  {
+    kernels.half2(xs.data(), ys.data(), n, codes.data());
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      if(!same_codes(dist2d::half2(xs[k], ys[k]), &codes[2 * k])) ++mismatches;
+    }
+
+    kernels.unorm16(xs.data(), ys.data(), n, -1.f, 1.f, codes.data());
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      if(!same_codes(dist2d::unorm16_disk_point(xs[k], ys[k]), &codes[2 * k])) ++mismatches;
+    }
+  }
+
+  return mismatches;
+}
+
+
+// counts the points (xs[k], ys[k], zs[k]) which some packing kernel packs differently from the constructors of half3 & octahedral_unit_vector
+// the points are followed by the axes, with signed zeros, and a few values which half can't represent
+long long compare_packing(std::vector<float> xs, std::vector<float> ys, std::vector<float> zs, std::integral_constant<int,3>)
+{
+  const float specials[][3] = {
+    {1.f, 0.f, 0.f}, {-1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, -1.f, 0.f}, {0.f, 0.f, 1.f}, {0.f, 0.f, -1.f},
+    {-0.f, -0.f, -1.f}, {-0.f, 0.f, 1.f}, {0.6f, -0.f, -0.8f}, {3e-8f, 65520.f, -70000.f}
+  };
+  for(const auto& p : specials)
+  {
+    xs.push_back(p[0]);
+    ys.push_back(p[1]);
+    zs.push_back(p[2]);
+  }
+
+  const std::size_t n = xs.size();
+  std::vector<std::uint16_t> codes(3 * n);
+
+  long long mismatches = 0;
+  for(const auto& kernels : supported_packing_kernels())
+  {
+    kernels.half3(xs.data(), ys.data(), zs.data(), n, codes.data());
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      if(!same_codes(dist2d::half3(xs[k], ys[k], zs[k]), &codes[3 * k])) ++mismatches;
+    }
+
+    kernels.octahedral(xs.data(), ys.data(), zs.data(), n, codes.data());
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      if(!same_codes(dist2d::octahedral_unit_vector(xs[k], ys[k], zs[k]), &codes[2 * k])) ++mismatches;
+    }
+  }
+
+  return mismatches;
+}
+
+
+// the packed types encode floats, so points of other types aren't measured
+template<class Real, class Dimension>
+long long compare_packing(std::vector<Real>, std::vector<Real>, std::vector<Real>, Dimension)
+{
+  return -1;
+}
+
+
+// compares generate() and sample_with_pdf() with operator() over batch_points consecutive indices, checks the spread of
+// generate()'s points over the bins, and measures the throughput of generate() and operator()
+//
+// the consecutive indices form a lattice, whose image aliases with the bins, so their counts aren't tested for uniformity,
+// only that none of the spread bins is empty
+template<class Parameterization, class Distribution>
+void compare_batch(const Distribution& dist, const std::vector<double>& probabilities, report& r)
+{
+  using point = typename Distribution::result_type;
+  using real = typename Distribution::real_type;
+  using dim = dimension<point>;
+
+  // an arbitrary position in the Morton order
+  const std::uint64_t first = 0x9e3779b97f4a7c15ull;
+
+  std::vector<real> xs(batch_points), ys(batch_points), zs(batch_points);
+
+  auto start = std::chrono::steady_clock::now();
+  generate(dist, first, batch_points, xs.data(), ys.data(), zs.data(), dim());
+  r.generate_rate = batch_points / seconds_since(start);
+
+  std::vector<point> points;
+  points.reserve(batch_points);
+
+  start = std::chrono::steady_clock::now();
+  for(std::size_t k = 0; k < batch_points; ++k)
+  {
+    points.push_back(dist(first + k));
+  }
+  r.operator_rate = batch_points / seconds_since(start);
+
+  const std::size_t ratio = fine_bins / spread_bins;
+
+  std::vector<std::uint64_t> counts(spread_bins * spread_bins, 0);
+  std::vector<std::array<real,3>> sorted(batch_points);
+  for(std::size_t k = 0; k < batch_points; ++k)
+  {
+    double p[3] = {double(xs[k]), double(ys[k]), double(zs[k])};
+
+    double s, t;
+    Parameterization::parameters(p, s, t);
+
+    ++counts[(fine_bin(s) / ratio) * spread_bins + fine_bin(t) / ratio];
+
+    sorted[k] = {{xs[k], ys[k], zs[k]}};
+  }
+
+  std::vector<double> expected(spread_bins * spread_bins, 0);
+  for(std::size_t i = 0; i < fine_bins; ++i)
+  {
+    for(std::size_t j = 0; j < fine_bins; ++j)
+    {
+      expected[(i / ratio) * spread_bins + j / ratio] += probabilities[i * fine_bins + j] * double(batch_points);
+    }
+  }
+
+  r.batch_empty_bins = 0;
+  for(std::size_t c = 0; c < counts.size(); ++c)
+  {
+    if(expected[c] >= 16 && counts[c] == 0) ++r.batch_empty_bins;
+  }
+
+  std::sort(sorted.begin(), sorted.end());
+  r.batch_duplicates = sorted.end() - std::unique(sorted.begin(), sorted.end());
+
+  r.batch_error = 0;
+  for(std::size_t k = 0; k < batch_points; ++k)
+  {
+    double p[3];
+    coordinates(points[k], p, dim());
+
+    r.batch_error = std::max(r.batch_error, std::fabs(p[0] - double(xs[k])));
+    r.batch_error = std::max(r.batch_error, std::fabs(p[1] - double(ys[k])));
+    if(dim::value == 3) r.batch_error = std::max(r.batch_error, std::fabs(p[2] - double(zs[k])));
+  }
+
+  r.pdf_error = 0;
+  for(std::size_t k = 0; k < batch_points; ++k)
+  {
+    auto urns = dist2d::morton_urns(first + k);
+    auto sample = dist.sample_with_pdf(urns.first, urns.second);
+
+    double p[3], q[3];
+    coordinates(points[k], p, dim());
+    coordinates(sample.first, q, dim());
+
+    double density = dist.probability_density(points[k]);
+    double error = std::fabs(double(sample.second) - density) / density;
+
+    // a different point is as wrong as any density
+    for(int i = 0; i < dim::value; ++i)
+    {
+      if(p[i] != q[i]) error = std::numeric_limits<double>::infinity();
+    }
+
+    r.pdf_error = std::max(r.pdf_error, error);
+  }
+
+  r.packing_mismatches = compare_packing(xs, ys, zs, dim());
+}
+
+
+// compares generate() around normals with generate() followed by the rotation of detail::to_frame in double,
+// and checks that generating in place over the normals gives the same points
+template<class Distribution>
+double compare_frames(const Distribution& dist, std::true_type)
+{
+  using real = typename Distribution::real_type;
+
+  const std::uint64_t first = 0x9e3779b97f4a7c15ull;
+
+  // the normals are random directions, which cover every orientation of the basis
+  std::vector<real> nxs(batch_points), nys(batch_points), nzs(batch_points);
+  dist2d::unit_sphere_distribution<std::tuple<real,real,real>> sphere;
+  dist2d::counter_based_engine<> g(first);
+  for(std::size_t k = 0; k < batch_points; ++k)
+  {
+    std::tie(nxs[k], nys[k], nzs[k]) = sphere(g);
+  }
+
+  // the poles are the extremes of the basis
+  nxs[0] = 0; nys[0] = 0; nzs[0] = 1;
+  nxs[1] = 0; nys[1] = 0; nzs[1] = -1;
+
+  std::vector<real> xs(batch_points), ys(batch_points), zs(batch_points);
+  dist.generate(first, batch_points, xs.data(), ys.data(), zs.data());
+
+  std::vector<real> wxs(batch_points), wys(batch_points), wzs(batch_points);
+  dist.generate(first, batch_points, nxs.data(), nys.data(), nzs.data(), wxs.data(), wys.data(), wzs.data());
+
+  double error = 0;
+  for(std::size_t k = 0; k < batch_points; ++k)
+  {
+    double x = xs[k], y = ys[k], z = zs[k];
+    dist2d::detail::to_frame(double(nxs[k]), double(nys[k]), double(nzs[k]), x, y, z);
+
+    error = std::max(error, std::fabs(x - double(wxs[k])));
+    error = std::max(error, std::fabs(y - double(wys[k])));
+    error = std::max(error, std::fabs(z - double(wzs[k])));
+  }
+
+  dist.generate(first, batch_points, nxs.data(), nys.data(), nzs.data(), nxs.data(), nys.data(), nzs.data());
+
+  if(nxs != wxs || nys != wys || nzs != wzs) error = std::numeric_limits<double>::infinity();
+
+  return error;
+}
+
+
+// distributions without generate() around normals aren't measured
+template<class Distribution>
+double compare_frames(const Distribution&, std::false_type)
+{
+  return -1;
+}
+
+
+template<class Parameterization, class Distribution>
+report validate(const std::string& name, const Distribution& dist, const options& opts)
+{
+  using real = typename Distribution::real_type;
+
+  report r;
+  r.name = name;
+
+  std::vector<double> probabilities = bin_probabilities<Parameterization>(dist, r.expected_area);
+
+  r.probability_integral = 0;
+  for(double p : probabilities) r.probability_integral += p;
+  r.area = double(dist.area());
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::uint64_t> counts = bin_samples<Parameterization>(dist, opts);
+  r.test_rate = double(opts.samples) / seconds_since(start);
+
+  r.chi_square_p = chi_square_test(counts, probabilities, opts.samples);
+  r.kolmogorov_smirnov_p[0] = kolmogorov_smirnov_test(counts, probabilities, opts.samples, 0);
+  r.kolmogorov_smirnov_p[1] = kolmogorov_smirnov_test(counts, probabilities, opts.samples, 1);
+
+  std::tie(r.input_discrepancy, r.discrepancy) = discrepancies(dist, has_inverse<Distribution>());
+
+  compare_batch<Parameterization>(dist, probabilities, r);
+  r.frame_error = compare_frames(dist, has_frame_generate<Distribution>());
+
+  // the tolerance of generate() allows for the rounding of real
+  // the round trip through inverse() may move the points slightly, but breaking their stratification moves them far
+  const double epsilon = std::numeric_limits<real>::epsilon();
+
+  if(r.chi_square_p < opts.significance) r.failures.push_back("chi-square");
+  if(r.kolmogorov_smirnov_p[0] < opts.significance) r.failures.push_back("KS(s)");
+  if(r.kolmogorov_smirnov_p[1] < opts.significance) r.failures.push_back("KS(t)");
+  if(std::fabs(r.probability_integral - 1) > 1e-4) r.failures.push_back("integral of pdf");
+  if(std::fabs(r.area - r.expected_area) > 1e-4 * r.expected_area) r.failures.push_back("area");
+  if(r.discrepancy > r.input_discrepancy + 1e-6) r.failures.push_back("discrepancy");
+  if(r.batch_error > 16 * epsilon) r.failures.push_back("generate");
+  // the alias method isn't one-to-one, e.g. it maps a pixel's own bucket and a bucket of zero weight aliased to it over
+  // the same pixel, so it may map a few of the lattice's points to the same point
+  if(r.batch_empty_bins > 0 || r.batch_duplicates > static_cast<long long>(batch_points / 16)) r.failures.push_back("generate spread");
+  if(r.pdf_error > 16 * epsilon) r.failures.push_back("sample_with_pdf");
+  if(r.frame_error > 16 * epsilon) r.failures.push_back("frame");
+  if(r.packing_mismatches > 0) r.failures.push_back("packing");
+
+  return r;
+}
+
+
+struct validation
+{
+  // the distribution's name without its template parameters, which --distribution selects
+  std::string distribution;
+  std::string name;
+
+  std::function<report(const options&)> run;
+};
+
+
+template<class Parameterization, class Distribution>
+void add_validation(std::vector<validation>& validations, const std::string& distribution, const std::string& variant, Distribution dist = Distribution())
+{
+  std::string real = sizeof(typename Distribution::real_type) == sizeof(float) ? "float" : "double";
+  std::string name = distribution + "<" + real + variant + ">";
+
+  validations.push_back({distribution, name, [=](const options& opts)
+  {
+    return validate<Parameterization>(name, dist, opts);
+  }});
+}
+
+
+// a weight image with a gradient, a bright pixel, and a row and a column of zeros
+template<class Point>
+dist2d::piecewise_constant_2d_distribution<Point> make_piecewise_constant_2d_distribution()
+{
+  const std::size_t width = 16, height = 8;
+
+  std::vector<float> weights(width * height);
+  for(std::size_t y = 0; y < height; ++y)
+  {
+    for(std::size_t x = 0; x < width; ++x)
+    {
+      weights[y * width + x] = (x == 3 || y == 5) ? 0.f : float(1 + x + 2 * y);
+    }
+  }
+  weights[2 * width + 9] = 100;
+
+  return dist2d::piecewise_constant_2d_distribution<Point>(dist2d::execution::seq, weights.data(), width, height);
+}
+
+
+template<class Point>
+Point to_point(const double* p)
+{
+  using real = typename std::tuple_element<0,Point>::type;
+  return Point{real(p[0]), real(p[1]), real(p[2])};
+}
+
+
+template<class Point>
+dist2d::spherical_triangle_distribution<Point> make_spherical_triangle_distribution()
+{
+  return dist2d::spherical_triangle_distribution<Point>(
+    to_point<Point>(spherical_triangle[0]), to_point<Point>(spherical_triangle[1]), to_point<Point>(spherical_triangle[2]));
+}
+
+
+template<class Point>
+dist2d::spherical_rectangle_distribution<Point> make_spherical_rectangle_distribution()
+{
+  const double origin[3] = {0, 0, 0};
+
+  return dist2d::spherical_rectangle_distribution<Point>(
+    to_point<Point>(origin), to_point<Point>(spherical_rectangle[0]), to_point<Point>(spherical_rectangle[1]), to_point<Point>(spherical_rectangle[2]));
+}
+
+
+// a mesh tiling the unit square with triangles of different sizes and windings, and a degenerate triangle
+template<class Point>
+dist2d::mesh_surface_distribution<Point> make_mesh_surface_distribution()
+{
+  const float positions[] = {
+    0, 0, 0,
+    1, 0, 0,
+    1, 1, 0,
+    0, 1, 0,
+    0.3f, 0.6f, 0,
+    0.8f, 0.2f, 0
+  };
+
+  const std::uint32_t indices[] = {
+    0, 1, 5,
+    5, 1, 2,
+    0, 4, 5,
+    4, 5, 2,
+    0, 4, 3,
+    3, 4, 2,
+    0, 0, 1
+  };
+
+  return dist2d::mesh_surface_distribution<Point>(dist2d::execution::seq, positions, 6, indices, 7);
+}
+
+
+// samples with a warp pipeline of the given Precision, and is measured against the density and area of the distribution Reference,
+// which maps [0,1)^2 by the same stages
+template<class Warp, class Reference, class Precision = dist2d::fast_precision>
+class warp_pipeline_under_test : public dist2d::warp_distribution<Warp, typename Reference::result_type, Precision>
+{
+  using super_t = dist2d::warp_distribution<Warp, typename Reference::result_type, Precision>;
+
+  public:
+    using typename super_t::result_type;
+    using typename super_t::real_type;
+
+    explicit warp_pipeline_under_test(const Warp& warp)
+      : super_t(warp)
+    {}
+
+    real_type probability_density(const result_type& p) const
+    {
+      return Reference().probability_density(p);
+    }
+
+    template<class... Pointers>
+    void probability_density(std::size_t count, Pointers... arrays) const
+    {
+      Reference().probability_density(count, arrays...);
+    }
+
+    real_type area() const
+    {
+      return Reference().area();
+    }
+};
+
+
+template<class Reference, class Precision = dist2d::fast_precision, class Warp>
+warp_pipeline_under_test<Warp,Reference,Precision> make_warp_pipeline_under_test(const Warp& warp)
+{
+  return warp_pipeline_under_test<Warp,Reference,Precision>(warp);
+}
+
+
+void add_all_validations(std::vector<validation>& validations)
+{
+  using namespace dist2d;
+
+  using float2 = std::pair<float,float>;
+  using double2 = std::pair<double,double>;
+  using float3 = std::tuple<float,float,float>;
+  using double3 = std::tuple<double,double,double>;
+
+  add_validation<square_parameterization, unit_square_distribution<float2>>(validations, "unit_square", "");
+  add_validation<square_parameterization, unit_square_distribution<double2>>(validations, "unit_square", "");
+
+  add_validation<polar_parameterization, unit_disk_distribution<float2>>(validations, "unit_disk", "");
+  add_validation<polar_parameterization, unit_disk_distribution<double2>>(validations, "unit_disk", "");
+  add_validation<polar_parameterization, unit_disk_distribution<float2, fast_precision>>(validations, "unit_disk", ",fast");
+  add_validation<polar_parameterization, unit_disk_distribution<float2, double_precision>>(validations, "unit_disk", ",double");
+
+  add_validation<polar_parameterization, concentric_unit_disk_distribution<float2>>(validations, "concentric_unit_disk", "");
+  add_validation<polar_parameterization, concentric_unit_disk_distribution<double2>>(validations, "concentric_unit_disk", "");
+  add_validation<polar_parameterization, concentric_unit_disk_distribution<float2, branchless_concentric_mapping>>(validations, "concentric_unit_disk", ",branchless");
+  add_validation<polar_parameterization, concentric_unit_disk_distribution<double2, branchless_concentric_mapping>>(validations, "concentric_unit_disk", ",branchless");
+  add_validation<polar_parameterization, concentric_unit_disk_distribution<float2, polar_concentric_mapping, fast_precision>>(validations, "concentric_unit_disk", ",fast");
+  add_validation<polar_parameterization, concentric_unit_disk_distribution<float2, polar_concentric_mapping, double_precision>>(validations, "concentric_unit_disk", ",double");
+  add_validation<polar_parameterization, concentric_unit_disk_distribution<float2, branchless_concentric_mapping, double_precision>>(validations, "concentric_unit_disk", ",branchless,double");
+
+  add_validation<triangle_parameterization, unit_isoceles_right_triangle_distribution<float2>>(validations, "unit_isoceles_right_triangle", "");
+  add_validation<triangle_parameterization, unit_isoceles_right_triangle_distribution<double2>>(validations, "unit_isoceles_right_triangle", "");
+
+  add_validation<sphere_parameterization, unit_sphere_distribution<float3>>(validations, "unit_sphere", "");
+  add_validation<sphere_parameterization, unit_sphere_distribution<double3>>(validations, "unit_sphere", "");
+  add_validation<sphere_parameterization, unit_sphere_distribution<float3, fast_precision>>(validations, "unit_sphere", ",fast");
+  add_validation<sphere_parameterization, unit_sphere_distribution<float3, double_precision>>(validations, "unit_sphere", ",double");
+
+  add_validation<hemisphere_parameterization, unit_hemisphere_distribution<float3>>(validations, "unit_hemisphere", "");
+  add_validation<hemisphere_parameterization, unit_hemisphere_distribution<double3>>(validations, "unit_hemisphere", "");
+  add_validation<hemisphere_parameterization, unit_hemisphere_distribution<float3, fast_precision>>(validations, "unit_hemisphere", ",fast");
+  add_validation<hemisphere_parameterization, unit_hemisphere_distribution<float3, double_precision>>(validations, "unit_hemisphere", ",double");
+
+  add_validation<hemisphere_parameterization, cosine_weighted_unit_hemisphere_distribution<float3>>(validations, "cosine_weighted_unit_hemisphere", "");
+  add_validation<hemisphere_parameterization, cosine_weighted_unit_hemisphere_distribution<double3>>(validations, "cosine_weighted_unit_hemisphere", "");
+  add_validation<hemisphere_parameterization, cosine_weighted_unit_hemisphere_distribution<float3, branchless_concentric_mapping>>(validations, "cosine_weighted_unit_hemisphere", ",branchless");
+  add_validation<hemisphere_parameterization, cosine_weighted_unit_hemisphere_distribution<double3, branchless_concentric_mapping>>(validations, "cosine_weighted_unit_hemisphere", ",branchless");
+  add_validation<hemisphere_parameterization, cosine_weighted_unit_hemisphere_distribution<float3, polar_concentric_mapping, fast_precision>>(validations, "cosine_weighted_unit_hemisphere", ",fast");
+  add_validation<hemisphere_parameterization, cosine_weighted_unit_hemisphere_distribution<float3, polar_concentric_mapping, double_precision>>(validations, "cosine_weighted_unit_hemisphere", ",double");
+
+  add_validation<square_parameterization>(validations, "piecewise_constant_2d", "", make_piecewise_constant_2d_distribution<float2>());
+  add_validation<square_parameterization>(validations, "piecewise_constant_2d", "", make_piecewise_constant_2d_distribution<double2>());
+
+  add_validation<spherical_triangle_parameterization>(validations, "spherical_triangle", "", make_spherical_triangle_distribution<float3>());
+  add_validation<spherical_triangle_parameterization>(validations, "spherical_triangle", "", make_spherical_triangle_distribution<double3>());
+
+  add_validation<spherical_rectangle_parameterization>(validations, "spherical_rectangle", "", make_spherical_rectangle_distribution<float3>());
+  add_validation<spherical_rectangle_parameterization>(validations, "spherical_rectangle", "", make_spherical_rectangle_distribution<double3>());
+
+  add_validation<square_parameterization>(validations, "mesh_surface", "", make_mesh_surface_distribution<float3>());
+  add_validation<square_parameterization>(validations, "mesh_surface", "", make_mesh_surface_distribution<double3>());
+
+  add_validation<polar_parameterization>(validations, "warp_pipeline", ",concentric_disk",
+    make_warp_pipeline_under_test<concentric_unit_disk_distribution<float2, branchless_concentric_mapping>>(warps::square | warps::concentric_disk));
+  add_validation<polar_parameterization>(validations, "warp_pipeline", ",polar_disk",
+    make_warp_pipeline_under_test<unit_disk_distribution<float2>>(warps::square | warps::polar_disk));
+  add_validation<sphere_parameterization>(validations, "warp_pipeline", ",uniform_sphere",
+    make_warp_pipeline_under_test<unit_sphere_distribution<float3>>(warps::square | warps::uniform_sphere));
+  add_validation<hemisphere_parameterization>(validations, "warp_pipeline", ",uniform_hemisphere",
+    make_warp_pipeline_under_test<unit_hemisphere_distribution<float3>>(warps::square | warps::uniform_hemisphere));
+  add_validation<hemisphere_parameterization>(validations, "warp_pipeline", ",lift_to_hemisphere",
+    make_warp_pipeline_under_test<cosine_weighted_unit_hemisphere_distribution<float3, branchless_concentric_mapping>>(
+      warps::square | warps::concentric_disk | warps::lift_to_hemisphere));
+  add_validation<hemisphere_parameterization>(validations, "warp_pipeline", ",lift_to_hemisphere,rotate_to(+z)",
+    make_warp_pipeline_under_test<cosine_weighted_unit_hemisphere_distribution<float3, branchless_concentric_mapping>>(
+      warps::square | warps::concentric_disk | warps::lift_to_hemisphere | warps::rotate_to(0.f, 0.f, 1.f)));
+
+  add_validation<polar_parameterization>(validations, "warp_pipeline", ",concentric_disk",
+    make_warp_pipeline_under_test<concentric_unit_disk_distribution<double2, branchless_concentric_mapping>>(warps::square | warps::concentric_disk));
+  add_validation<polar_parameterization>(validations, "warp_pipeline", ",polar_disk",
+    make_warp_pipeline_under_test<unit_disk_distribution<double2>>(warps::square | warps::polar_disk));
+  add_validation<sphere_parameterization>(validations, "warp_pipeline", ",uniform_sphere",
+    make_warp_pipeline_under_test<unit_sphere_distribution<double3>>(warps::square | warps::uniform_sphere));
+  add_validation<hemisphere_parameterization>(validations, "warp_pipeline", ",uniform_hemisphere",
+    make_warp_pipeline_under_test<unit_hemisphere_distribution<double3>>(warps::square | warps::uniform_hemisphere));
+  add_validation<hemisphere_parameterization>(validations, "warp_pipeline", ",lift_to_hemisphere",
+    make_warp_pipeline_under_test<cosine_weighted_unit_hemisphere_distribution<double3, branchless_concentric_mapping>>(
+      warps::square | warps::concentric_disk | warps::lift_to_hemisphere));
+  add_validation<hemisphere_parameterization>(validations, "warp_pipeline", ",lift_to_hemisphere,rotate_to(+z)",
+    make_warp_pipeline_under_test<cosine_weighted_unit_hemisphere_distribution<double3, branchless_concentric_mapping>>(
+      warps::square | warps::concentric_disk | warps::lift_to_hemisphere | warps::rotate_to(0., 0., 1.)));
+
+  add_validation<polar_parameterization>(validations, "warp_pipeline", ",polar_disk,accurate",
+    make_warp_pipeline_under_test<unit_disk_distribution<float2>, accurate_precision>(warps::square | warps::polar_disk));
+  add_validation<sphere_parameterization>(validations, "warp_pipeline", ",uniform_sphere,double",
+    make_warp_pipeline_under_test<unit_sphere_distribution<float3>, double_precision>(warps::square | warps::uniform_sphere));
+  add_validation<hemisphere_parameterization>(validations, "warp_pipeline", ",lift_to_hemisphere,rotate_to(+z),double",
+    make_warp_pipeline_under_test<cosine_weighted_unit_hemisphere_distribution<float3, branchless_concentric_mapping>, double_precision>(
+      warps::square | warps::concentric_disk | warps::lift_to_hemisphere | warps::rotate_to(0.f, 0.f, 1.f)));
+}
+
+
+void print_report(const report& r, std::size_t width)
+{
+  char discrepancy[32] = "-";
+  if(r.discrepancy >= 0)
+  {
+    std::snprintf(discrepancy, sizeof(discrepancy), "%.5f/%.5f", r.input_discrepancy, r.discrepancy);
+  }
+
+  char batch_spread[32];
+  std::snprintf(batch_spread, sizeof(batch_spread), "%lld/%lld", r.batch_empty_bins, r.batch_duplicates);
+
+  char frame_error[32] = "-";
+  if(r.frame_error >= 0)
+  {
+    std::snprintf(frame_error, sizeof(frame_error), "%.2g", r.frame_error);
+  }
+
+  char packing[32] = "-";
+  if(r.packing_mismatches >= 0)
+  {
+    std::snprintf(packing, sizeof(packing), "%lld", r.packing_mismatches);
+  }
+
+  std::string result = "ok";
+  if(!r.failures.empty())
+  {
+    result = "FAILED:";
+    for(const auto& f : r.failures) result += " " + f;
+  }
+
+  std::printf("%-*s %8.4f %8.4f %8.4f %10.7f %10.7f %17s %9.2g %12s %9.2g %9s %7s %10.4g %10.4g %10.4g  %s\n",
+              int(width), r.name.c_str(),
+              r.chi_square_p, r.kolmogorov_smirnov_p[0], r.kolmogorov_smirnov_p[1],
+              r.probability_integral, r.area / r.expected_area,
+              discrepancy,
+              r.batch_error, batch_spread, r.pdf_error, frame_error, packing,
+              r.operator_rate, r.generate_rate, r.test_rate,
+              result.c_str());
+}
+
+
+int main(int argc, char** argv)
+{
+  options opts;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+
+    if(arg.compare(0, 15, "--distribution=") == 0)
+    {
+      opts.distribution = arg.substr(15);
+    }
+    else if(arg.compare(0, 10, "--samples=") == 0)
+    {
+      opts.samples = std::stoull(arg.substr(10));
+    }
+    else if(arg.compare(0, 10, "--threads=") == 0)
+    {
+      opts.threads = std::stoull(arg.substr(10));
+    }
+    else if(arg.compare(0, 7, "--seed=") == 0)
+    {
+      opts.seed = std::stoull(arg.substr(7));
+    }
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--distribution=<name>] [--samples=<n>] [--threads=<n>] [--seed=<n>]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<validation> validations;
+  add_all_validations(validations);
+
+  validations.erase(std::remove_if(validations.begin(), validations.end(), [&](const validation& v)
+  {
+    return !opts.distribution.empty() && v.distribution != opts.distribution;
+  }), validations.end());
+
+  if(validations.empty())
+  {
+    std::fprintf(stderr, "%s: no distribution named %s\n", argv[0], opts.distribution.c_str());
+    return 1;
+  }
+
+  // each validation has three p-values, and together they fail with probability 1%
+  std::size_t num_tests = 3 * validations.size();
+  opts.significance = 1 - std::pow(1 - 0.01, 1. / double(num_tests));
+
+  std::printf("%llu samples per distribution, significance level %.3g per test\n", (unsigned long long)opts.samples, opts.significance);
+  std::printf("p-values of the chi-square test and the Kolmogorov-Smirnov tests of each marginal, the integral of the pdf,\n");
+  std::printf("area() over the area of the support, the star discrepancy of %zu Sobol points before/after a round trip,\n", discrepancy_points);
+  std::printf("the largest difference of generate() from operator(), the empty bins/repeated points of generate()'s batch,\n");
+  std::printf("the largest relative error of sample_with_pdf()'s density,\n");
+  std::printf("the largest difference of generate() around normals from generate() rotated in double,\n");
+  std::printf("the number of points the packing kernels pack differently from the packed types' constructors,\n");
+  std::printf("and the samples/s of operator(), generate(), and the test\n\n");
+
+  std::size_t width = 12;
+  for(const auto& v : validations) width = std::max(width, v.name.size());
+
+  std::printf("%-*s %8s %8s %8s %10s %10s %17s %9s %12s %9s %9s %7s %10s %10s %10s  %s\n",
+              int(width), "Distribution", "chi2", "KS(s)", "KS(t)", "integral", "area", "discrepancy", "batch err", "batch spread", "pdf err", "frame err", "packing", "op()/s", "generate/s", "test/s", "result");
+  std::printf("%s\n", std::string(width + 151, '-').c_str());
+
+  bool failed = false;
+  for(const auto& v : validations)
+  {
+    report r = v.run(opts);
+    print_report(r, width);
+    std::fflush(stdout);
+
+    failed = failed || !r.failures.empty();
+  }
+
+  return failed ? 1 : 0;
+}